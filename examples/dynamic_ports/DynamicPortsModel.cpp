@@ -233,6 +233,9 @@ QVariant DynamicPortsModel::nodeData(NodeId nodeId, NodeRole role) const
         result = QVariant::fromValue(widget(nodeId));
         break;
     }
+
+    case NodeRole::ComputeCost:
+        break;
     }
 
     return result;
@@ -285,6 +288,9 @@ bool DynamicPortsModel::setNodeData(NodeId nodeId, NodeRole role, QVariant value
 
     case NodeRole::Widget:
         break;
+
+    case NodeRole::ComputeCost:
+        break;
     }
 
     return result;
@@ -0,0 +1,98 @@
+#include "GraphShapes.hpp"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+double const columnWidth = 250.0;
+double const rowHeight = 150.0;
+
+/// Places every node one column right of its rightmost input, stacked in the columns.
+void layOut(SyntheticGraph &graph)
+{
+    std::size_t const count = graph.positions.size();
+
+    std::vector<int> columns(count, 0);
+    for (ConnectionId const &cid : graph.connections) {
+        columns[cid.inNodeId] = std::max(columns[cid.inNodeId], columns[cid.outNodeId] + 1);
+    }
+
+    // The connections lead to higher indices, the inputs are placed first.
+    std::vector<int> rows;
+    for (std::size_t i = 0; i < count; ++i) {
+        int const column = columns[i];
+        if (column >= static_cast<int>(rows.size()))
+            rows.resize(column + 1, 0);
+
+        graph.positions[i] = QPointF(column * columnWidth, rows[column]++ * rowHeight);
+    }
+}
+
+} // namespace
+
+QStringList GraphShapes::names()
+{
+    return {"chain", "tree", "diamond", "dag"};
+}
+
+SyntheticGraph GraphShapes::generate(QString const &shape, int nodes, int fanOut, unsigned int seed)
+{
+    SyntheticGraph graph;
+    graph.positions.resize(std::max(0, nodes));
+
+    auto connect = [&graph](int from, int to, PortIndex inPort) {
+        graph.connections.push_back(ConnectionId{static_cast<NodeId>(from),
+                                                 0,
+                                                 static_cast<NodeId>(to),
+                                                 inPort});
+    };
+
+    if (shape == "chain") {
+        for (int i = 1; i < nodes; ++i) {
+            connect(i - 1, i, 0);
+        }
+    } else if (shape == "tree") {
+        fanOut = std::max(1, fanOut);
+        for (int i = 1; i < nodes; ++i) {
+            connect((i - 1) / fanOut, i, 0);
+        }
+    } else if (shape == "diamond") {
+        // Two branches after every split, the join is the next split.
+        int split = 0;
+        for (int i = 1; i < nodes; ++i) {
+            switch ((i - 1) % 3) {
+            case 0:
+            case 1:
+                connect(split, i, 0);
+                break;
+            case 2:
+                connect(i - 2, i, 0);
+                connect(i - 1, i, 1);
+                split = i;
+                break;
+            }
+        }
+    } else if (shape == "dag") {
+        std::mt19937 engine(seed);
+        for (int i = 1; i < nodes; ++i) {
+            std::uniform_int_distribution<int> earlier(0, i - 1);
+
+            int const first = earlier(engine);
+            connect(first, i, 0);
+
+            if (i < 2)
+                continue;
+
+            int second = earlier(engine);
+            while (second == first) {
+                second = earlier(engine);
+            }
+            connect(second, i, 1);
+        }
+    }
+
+    layOut(graph);
+
+    return graph;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QtNodes/Definitions>
+
+#include <QtCore/QPointF>
+#include <QtCore/QStringList>
+
+#include <vector>
+
+using QtNodes::ConnectionId;
+using QtNodes::NodeId;
+using QtNodes::PortIndex;
+
+/// Nodes and connections of a generated graph.
+/**
+ * The node ids of the connections are indices into `positions`, a
+ * connection always leads from a lower to a higher index. The nodes have
+ * the ports of RelayModel.
+ */
+struct SyntheticGraph
+{
+    std::vector<QPointF> positions;
+
+    std::vector<ConnectionId> connections;
+};
+
+/// Generates the graphs of the benchmark.
+class GraphShapes
+{
+public:
+    /**
+   * - "chain": every node feeds the next one.
+   * - "tree": every node feeds `fanOut` children.
+   * - "diamond": a node feeds two nodes joined by the next one, repeatedly.
+   * - "dag": every node reads two random earlier nodes.
+   */
+    static QStringList names();
+
+    /// @returns a graph of `shape` with `nodes` nodes laid out in layers.
+    static SyntheticGraph generate(QString const &shape, int nodes, int fanOut, unsigned int seed);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QtNodes/NodeData>
+#include <QtNodes/NodeDelegateModel>
+
+#include <memory>
+
+using QtNodes::NodeData;
+using QtNodes::NodeDataType;
+using QtNodes::NodeDelegateModel;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+/// A node without logic, two inputs and one output.
+/**
+ * The node has no output data, delivering it costs nothing and the
+ * measured time is spent in the graph model and the scene only.
+ */
+class RelayModel : public NodeDelegateModel
+{
+    Q_OBJECT
+public:
+    ~RelayModel() = default;
+
+public:
+    QString caption() const override { return QString("Relay"); }
+
+    QString name() const override { return QString("Relay"); }
+
+public:
+    unsigned int nPorts(PortType const portType) const override
+    {
+        return portType == PortType::In ? 2 : 1;
+    }
+
+    NodeDataType dataType(PortType const, PortIndex const) const override
+    {
+        return NodeDataType{"relay", "R"};
+    }
+
+    std::shared_ptr<NodeData> outData(PortIndex) override { return nullptr; }
+
+    void setInData(std::shared_ptr<NodeData>, PortIndex const) override {}
+
+    QWidget *embeddedWidget() override { return nullptr; }
+};
@@ -0,0 +1,276 @@
+#include "GraphShapes.hpp"
+#include "RelayModel.hpp"
+
+#include <QtNodes/BasicGraphicsScene>
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/GraphicsView>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDateTime>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtWidgets/QApplication>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+using QtNodes::BasicGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::GraphicsView;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeRole;
+
+namespace {
+
+/// @returns the seconds `run` takes.
+double measure(std::function<void()> const &run)
+{
+    QElapsedTimer timer;
+    timer.start();
+    run();
+    return timer.nsecsElapsed() / 1e9;
+}
+
+/// `count` nodes of `nodeIds` picked at random, all of them if there are fewer.
+std::vector<NodeId> sample(std::vector<NodeId> nodeIds, int count, unsigned int seed)
+{
+    std::mt19937 engine(seed);
+    std::shuffle(nodeIds.begin(), nodeIds.end(), engine);
+
+    if (count < static_cast<int>(nodeIds.size()))
+        nodeIds.resize(count);
+
+    return nodeIds;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Renders without a display unless a platform is asked for.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Times the graph model, its serialization, the scene and the view on generated graphs "
+        "of growing size.");
+    parser.addHelpOption();
+
+    QCommandLineOption shapesOption("shapes",
+                                    "Graph shapes: chain, tree, diamond, dag.",
+                                    "list",
+                                    GraphShapes::names().join(','));
+    parser.addOption(shapesOption);
+
+    QCommandLineOption nodesOption("nodes", "Node counts.", "list", "1000,3000,10000,30000,100000");
+    parser.addOption(nodesOption);
+
+    QCommandLineOption fanOutOption("fan-out", "Children of every node of the trees.", "count", "4");
+    parser.addOption(fanOutOption);
+
+    QCommandLineOption samplesOption("samples",
+                                     "Nodes queried and deleted, the operations are timed per node.",
+                                     "count",
+                                     "1000");
+    parser.addOption(samplesOption);
+
+    QCommandLineOption seedOption("seed", "Seed of the random graphs and samples.", "number", "1");
+    parser.addOption(seedOption);
+
+    QCommandLineOption budgetOption("budget",
+                                    "Skips the larger graphs of a shape once a step took longer.",
+                                    "seconds",
+                                    "60");
+    parser.addOption(budgetOption);
+
+    QCommandLineOption noSceneOption("no-scene", "Times the graph model only.");
+    parser.addOption(noSceneOption);
+
+    QCommandLineOption jsonOption("json", "Writes the results to the file.", "file");
+    parser.addOption(jsonOption);
+
+    QCommandLineOption labelOption("label", "Name of the build in the results.", "label");
+    parser.addOption(labelOption);
+
+    parser.process(app);
+
+    QStringList const shapes = parser.value(shapesOption).split(',');
+    int const fanOut = std::max(1, parser.value(fanOutOption).toInt());
+    int const samples = std::max(1, parser.value(samplesOption).toInt());
+    unsigned int const seed = parser.value(seedOption).toUInt();
+    double const budget = parser.value(budgetOption).toDouble();
+    bool const scenes = !parser.isSet(noSceneOption);
+
+    std::vector<int> nodeCounts;
+    for (QString const &count : parser.value(nodesOption).split(',')) {
+        nodeCounts.push_back(count.toInt());
+    }
+    std::sort(nodeCounts.begin(), nodeCounts.end());
+
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<RelayModel>();
+
+    QJsonArray results;
+
+    for (QString const &shape : shapes) {
+        if (!GraphShapes::names().contains(shape)) {
+            qWarning().noquote() << "Unknown shape" << shape;
+            continue;
+        }
+
+        for (int const nodeCount : nodeCounts) {
+            SyntheticGraph const graph = GraphShapes::generate(shape, nodeCount, fanOut, seed);
+
+            int const connectionCount = static_cast<int>(graph.connections.size());
+
+            qInfo().noquote() << QString("%1, %2 nodes, %3 connections")
+                                     .arg(shape)
+                                     .arg(nodeCount)
+                                     .arg(connectionCount);
+
+            double slowest = 0.0;
+
+            auto report = [&](QString const &operation, int count, double seconds) {
+                slowest = std::max(slowest, seconds);
+
+                qInfo().noquote() << QString("%1 %2 x %3 ms %4 us each")
+                                         .arg(operation, -24)
+                                         .arg(count, 7)
+                                         .arg(seconds * 1000.0, 10, 'f', 1)
+                                         .arg(count > 0 ? seconds * 1e6 / count : 0.0, 10, 'f', 2);
+
+                QJsonObject result;
+                result["shape"] = shape;
+                result["nodes"] = nodeCount;
+                result["connections"] = connectionCount;
+                result["operation"] = operation;
+                result["count"] = count;
+                result["seconds"] = seconds;
+                result["microsecondsPerOperation"] = count > 0 ? seconds * 1e6 / count : 0.0;
+                results.append(result);
+            };
+
+            DataFlowGraphModel model(registry);
+
+            std::vector<NodeId> nodeIds;
+            nodeIds.reserve(graph.positions.size());
+
+            report("addNode", nodeCount, measure([&]() {
+                       for (int i = 0; i < nodeCount; ++i) {
+                           nodeIds.push_back(model.addNode("Relay"));
+                       }
+                   }));
+
+            for (int i = 0; i < nodeCount; ++i) {
+                model.setNodeData(nodeIds[i], NodeRole::Position, graph.positions[i]);
+            }
+
+            report("addConnection", connectionCount, measure([&]() {
+                       for (ConnectionId const &cid : graph.connections) {
+                           model.addConnection(ConnectionId{nodeIds[cid.outNodeId],
+                                                            cid.outPortIndex,
+                                                            nodeIds[cid.inNodeId],
+                                                            cid.inPortIndex});
+                       }
+                   }));
+
+            std::vector<NodeId> const queried = sample(nodeIds, samples, seed);
+
+            report("connections", 2 * static_cast<int>(queried.size()), measure([&]() {
+                       for (NodeId const nodeId : queried) {
+                           model.connections(nodeId, PortType::In, 0);
+                           model.connections(nodeId, PortType::Out, 0);
+                       }
+                   }));
+
+            report("allConnectionIds", static_cast<int>(queried.size()), measure([&]() {
+                       for (NodeId const nodeId : queried) {
+                           model.allConnectionIds(nodeId);
+                       }
+                   }));
+
+            QJsonObject json;
+            report("save", 1, measure([&]() { json = model.save(); }));
+
+            {
+                DataFlowGraphModel loaded(registry);
+                report("load", 1, measure([&]() { loaded.load(json); }));
+            }
+
+            if (scenes) {
+                std::unique_ptr<BasicGraphicsScene> scene;
+                report("scene", 1, measure([&]() {
+                           scene = std::make_unique<BasicGraphicsScene>(model);
+                       }));
+
+                GraphicsView view(scene.get());
+                view.resize(1920, 1080);
+                view.show();
+                QApplication::processEvents();
+
+                QImage image(view.size(), QImage::Format_ARGB32_Premultiplied);
+                auto render = [&]() {
+                    QPainter painter(&image);
+                    view.render(&painter);
+                };
+
+                // The whole graph, then the part seen while editing.
+                view.fitInView(scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+                report("render all", 1, measure(render));
+
+                view.resetTransform();
+                view.centerOn(graph.positions.front());
+                report("render 100%", 1, measure(render));
+            }
+
+            // The scene is gone, the nodes are deleted from the model alone.
+            std::vector<NodeId> const deleted = sample(nodeIds, samples, seed + 1);
+
+            report("deleteNode", static_cast<int>(deleted.size()), measure([&]() {
+                       for (NodeId const nodeId : deleted) {
+                           model.deleteNode(nodeId);
+                       }
+                   }));
+
+            if (budget > 0.0 && slowest > budget) {
+                qInfo().noquote() << QString("%1 took over %2 s, skipping the larger %1 graphs")
+                                         .arg(shape)
+                                         .arg(budget);
+                break;
+            }
+        }
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QJsonObject document;
+        document["label"] = parser.value(labelOption);
+        document["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        document["qt"] = QString(qVersion());
+        document["fanOut"] = fanOut;
+        document["samples"] = samples;
+        document["seed"] = static_cast<qint64>(seed);
+        document["results"] = results;
+
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(document).toJson()) < 0) {
+            qWarning().noquote() << "Cannot write" << parser.value(jsonOption);
+            return 1;
+        }
+    }
+
+    return 0;
+}
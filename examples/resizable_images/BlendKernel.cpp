@@ -0,0 +1,26 @@
+#include "BlendKernel.hpp"
+
+BlendKernel::BlendKernel(Parameters const &parameters)
+    : _parameters(parameters)
+    , _mode(BlendModes::mode(parameters.mode))
+{}
+
+BlendKernel::Parameters BlendKernel::load(QJsonObject const &json, Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.mode = json["mode"].toString(defaults.mode);
+    parameters.alpha = json["alpha"].toBool(defaults.alpha);
+    return parameters;
+}
+
+void BlendKernel::save(QJsonObject &json) const
+{
+    json["mode"] = _parameters.mode;
+    json["alpha"] = _parameters.alpha;
+}
+
+void BlendKernel::apply(cv::Mat const &input, std::vector<cv::Mat> const &extras, cv::Mat &output) const
+{
+    // Written straight into `output`, which is a view into the frame.
+    BlendModes::blend(_mode, input, extras.front(), output, _parameters.alpha);
+}
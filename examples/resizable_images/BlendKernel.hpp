@@ -0,0 +1,49 @@
+#pragma once
+
+#include "BlendModes.hpp"
+#include "PointwiseKernel.hpp"
+
+#include <QtCore/QString>
+
+/// Blends the second input over the first one.
+/**
+ * The second image is resized to the first one, the output has the
+ * geometry of the first input. @see BlendModes
+ */
+class BlendKernel : public PointwiseKernel
+{
+public:
+    struct Parameters
+    {
+        /// "Normal", "Multiply", "Screen", "Overlay" or "Difference".
+        QString mode = "Normal";
+
+        /// Weights the blend by the alpha of the second image and composites the alphas.
+        bool alpha = false;
+    };
+
+    explicit BlendKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+public:
+    ImageBuffer::Format inputFormat(ImageBuffer::Format) const override { return extraFormat(); }
+
+    ImageBuffer::Format extraFormat() const override
+    {
+        return _parameters.alpha ? ImageBuffer::Format::BGRA8888 : ImageBuffer::Format::BGR888;
+    }
+
+    /// Blends the second image `extras[0]` over `input`.
+    void apply(cv::Mat const &input, std::vector<cv::Mat> const &extras, cv::Mat &output) const override;
+
+    void save(QJsonObject &json) const override;
+
+private:
+    Parameters _parameters;
+
+    BlendModes::Mode _mode;
+};
@@ -1,20 +1,22 @@
 #include "BlendModel.hpp"
+#include <QtCore/QSignalBlocker>
 #include <QVBoxLayout>
-#include <opencv2/opencv.hpp>
 
 BlendModel::BlendModel()
+    : _kernel(std::make_shared<BlendKernel const>())
 {
-    _widget = new QWidget;
-    _previewLabel = new QLabel("Blended Output");
-    _blendModeBox = new QComboBox;
-
-    _blendModeBox->addItems({ "Normal", "Multiply", "Screen", "Overlay", "Difference" });
+}
 
-    auto *layout = new QVBoxLayout(_widget);
-    layout->addWidget(_previewLabel);
-    layout->addWidget(_blendModeBox);
+QJsonObject BlendModel::save() const
+{
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
 
-    connect(_blendModeBox, &QComboBox::currentTextChanged, this, &BlendModel::blend);
+void BlendModel::load(QJsonObject const &modelJson)
+{
+    setParameters(BlendKernel::load(modelJson, _kernel->parameters()));
 }
 
 unsigned int BlendModel::nPorts(QtNodes::PortType portType) const
@@ -24,77 +26,151 @@ unsigned int BlendModel::nPorts(QtNodes::PortType portType) const
 
 QtNodes::NodeDataType BlendModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const
 {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<QtNodes::NodeData> BlendModel::outData(QtNodes::PortIndex)
 {
-    return std::make_shared<PixmapData>(_outputPixmap);
+    return _output;
+}
+
+QJsonObject BlendModel::computationParameters() const
+{
+    QJsonObject parameters;
+    _kernel->save(parameters);
+    parameters["deferred"] = _deferredOutput && !_widget;
+    ImageRequest::save(_outRequest, parameters);
+    return parameters;
+}
+
+bool BlendModel::restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs)
+{
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d)
+        return false;
+
+    _output = d;
+    if (_previewLabel)
+        _previewLabel->setPixmap(_output->toPixmap(QSize(200, 200)));
+    return true;
 }
 
 void BlendModel::setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex portIndex)
 {
-    if (auto d = std::dynamic_pointer_cast<PixmapData>(nodeData)) {
+    auto d = std::dynamic_pointer_cast<ImageData>(nodeData);
+    if (d && !d->isNull()) {
         if (portIndex == 0)
-            _pixmap1 = d->pixmap();
+            _input1 = d;
         else
-            _pixmap2 = d->pixmap();
+            _input2 = d;
     }
+}
 
+void BlendModel::inputsUpdated()
+{
+    // Both inputs may change within one evaluation pass, blend them once.
     blend();
-    Q_EMIT dataUpdated(0);
-}
-
-cv::Mat BlendModel::blendImages(const cv::Mat &img1, const cv::Mat &img2, const QString &mode)
-{
-    cv::Mat result;
-    cv::Mat a, b;
-    cv::resize(img2, b, img1.size());
-    a = img1;
-
-    if (mode == "Normal") {
-        result = b.clone();
-    } else if (mode == "Multiply") {
-        cv::multiply(a, b, result, 1.0 / 255.0);
-    } else if (mode == "Screen") {
-        result = 255 - ((255 - a).mul(255 - b) / 255);
-    } else if (mode == "Overlay") {
-        result = a.clone();
-        for (int y = 0; y < a.rows; ++y) {
-            for (int x = 0; x < a.cols; ++x) {
-                for (int c = 0; c < 3; ++c) {
-                    float A = a.at<cv::Vec3b>(y, x)[c] / 255.0f;
-                    float B = b.at<cv::Vec3b>(y, x)[c] / 255.0f;
-                    float O = (A < 0.5f) ? (2 * A * B) : (1 - 2 * (1 - A) * (1 - B));
-                    result.at<cv::Vec3b>(y, x)[c] = static_cast<uchar>(O * 255);
-                }
-            }
-        }
-    } else if (mode == "Difference") {
-        cv::absdiff(a, b, result);
-    } else {
-        result = b.clone(); // Fallback to normal
+}
+
+std::shared_ptr<QtNodes::NodeDataRequest const> BlendModel::inRequest(QtNodes::PortIndex) const
+{
+    // A pointwise operation, the second image is resized to the same region.
+    return _outRequest;
+}
+
+bool BlendModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request, QtNodes::PortIndex)
+{
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
+}
+
+QWidget *BlendModel::embeddedWidget()
+{
+    if (_widget)
+        return _widget;
+
+    _widget = new QWidget;
+    _previewLabel = new QLabel("Blended Output");
+    _blendModeBox = new QComboBox;
+
+    _blendModeBox->addItems(BlendModes::names());
+    _blendModeBox->setCurrentText(_kernel->parameters().mode);
+
+    _alphaBox = new QCheckBox("Use alpha");
+    _alphaBox->setChecked(_kernel->parameters().alpha);
+
+    auto *layout = new QVBoxLayout(_widget);
+    layout->addWidget(_previewLabel);
+    layout->addWidget(_blendModeBox);
+    layout->addWidget(_alphaBox);
+
+    if (_output)
+        _previewLabel->setPixmap(_output->toPixmap(QSize(200, 200)));
+
+    connect(_blendModeBox, &QComboBox::currentTextChanged, this, [this](QString const &mode) {
+        BlendKernel::Parameters parameters = _kernel->parameters();
+        parameters.mode = mode;
+        setParameters(parameters);
+    });
+
+    connect(_alphaBox, &QCheckBox::toggled, this, [this](bool alpha) {
+        BlendKernel::Parameters parameters = _kernel->parameters();
+        parameters.alpha = alpha;
+        setParameters(parameters);
+    });
+
+    return _widget;
+}
+
+void BlendModel::setParameters(BlendKernel::Parameters const &parameters)
+{
+    _kernel = std::make_shared<BlendKernel const>(parameters);
+
+    if (_blendModeBox) {
+        QSignalBlocker const blocker(_blendModeBox);
+        _blendModeBox->setCurrentText(parameters.mode);
     }
 
-    return result;
+    if (_alphaBox) {
+        QSignalBlocker const blocker(_alphaBox);
+        _alphaBox->setChecked(parameters.alpha);
+    }
+
+    blend();
+}
+
+void BlendModel::setDeferredOutput(bool deferred)
+{
+    if (deferred == _deferredOutput)
+        return;
+
+    _deferredOutput = deferred;
+    blend();
 }
 
 void BlendModel::blend()
 {
-    if (_pixmap1.isNull() || _pixmap2.isNull())
+    if (!_input1 || !_input2)
         return;
 
-    QImage img1 = _pixmap1.toImage().convertToFormat(QImage::Format_RGB888);
-    QImage img2 = _pixmap2.toImage().convertToFormat(QImage::Format_RGB888);
+    std::shared_ptr<BlendKernel const> const kernel = _kernel;
+    ImageKernel::Inputs const inputs{_input1, _input2};
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
+    // The preview needs the pixels.
+    bool const defer = _deferredOutput && !_widget;
 
-    cv::Mat cvImg1(img1.height(), img1.width(), CV_8UC3, const_cast<uchar *>(img1.bits()), img1.bytesPerLine());
-    cv::Mat cvImg2(img2.height(), img2.width(), CV_8UC3, const_cast<uchar *>(img2.bits()), img2.bytesPerLine());
+    runComputation([this, kernel, inputs, request, defer]() {
+        std::shared_ptr<ImageData> const result
+            = defer ? kernel->defer(inputs, request)
+                    : kernel->compute(inputs, request, []() { return computationCancelled(); });
 
-    QString blendMode = _blendModeBox->currentText();
-    cv::Mat blended = blendImages(cvImg1, cvImg2, blendMode);
+        return [this, result]() {
+            _output = result;
 
-    QImage resultImg(blended.data, blended.cols, blended.rows, blended.step, QImage::Format_RGB888);
-    _outputPixmap = QPixmap::fromImage(resultImg.rgbSwapped());
+            if (_previewLabel && _output)
+                _previewLabel->setPixmap(_output->toPixmap(QSize(200, 200)));
 
-    _previewLabel->setPixmap(_outputPixmap.scaled(200, 200, Qt::KeepAspectRatio));
+            Q_EMIT dataUpdated(0);
+        };
+    });
 }
@@ -2,15 +2,20 @@
 
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QCheckBox>
 #include <QtWidgets/QComboBox>
 #include <QtNodes/NodeDelegateModel>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/core.hpp>
 
-#include "PixmapData.hpp"
+#include "BlendKernel.hpp"
+#include "ImageData.hpp"
+#include "PointwiseFusion.hpp"
 
-class BlendModel : public QtNodes::NodeDelegateModel
+class BlendModel
+    : public QtNodes::NodeDelegateModel
+    , public PointwiseModel
 {
     Q_OBJECT
 
@@ -22,26 +27,53 @@ public:
     QString name() const override { return "BlendModel"; }
     QString modelName() const { return "Blend"; }
 
+    QJsonObject save() const override;
+    void load(QJsonObject const &modelJson) override;
+
     unsigned int nPorts(QtNodes::PortType portType) const override;
     QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override;
 
     std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex portIndex) override;
+
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) override;
+
     void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex portIndex) override;
-    QWidget* embeddedWidget() override { return _widget; }
+    void inputsUpdated() override;
+
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(QtNodes::PortIndex portIndex) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       QtNodes::PortIndex portIndex) override;
+    QWidget* embeddedWidget() override;
+
+    std::shared_ptr<BlendKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and recomputes the output.
+    void setParameters(BlendKernel::Parameters const &parameters);
+
+    void setDeferredOutput(bool deferred) override;
 
 private Q_SLOTS:
     void blend();
 
 private:
-    QLabel *_previewLabel;
-    QComboBox *_blendModeBox;
-    QWidget *_widget;
+    // Created by `embeddedWidget`, headless graphs have none.
+    QLabel *_previewLabel = nullptr;
+    QComboBox *_blendModeBox = nullptr;
+    QCheckBox *_alphaBox = nullptr;
+    QWidget *_widget = nullptr;
+
+    std::shared_ptr<ImageData> _input1;
+    std::shared_ptr<ImageData> _input2;
+    std::shared_ptr<ImageData> _output;
 
-    QPixmap _pixmap1;
-    QPixmap _pixmap2;
-    QPixmap _outputPixmap;
+    std::shared_ptr<ImageRequest const> _outRequest;
 
-    std::shared_ptr<QtNodes::NodeData> _outputData;
+    std::shared_ptr<BlendKernel const> _kernel;
 
-    cv::Mat blendImages(const cv::Mat &img1, const cv::Mat &img2, const QString &mode);
+    bool _deferredOutput = false;
 };
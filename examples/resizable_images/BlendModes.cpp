@@ -0,0 +1,298 @@
+#include "BlendModes.hpp"
+
+#include "Simd.hpp"
+
+#include <QtCore/QtGlobal>
+
+#include <cstdlib>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+using Mode = BlendModes::Mode;
+
+namespace {
+
+/// `x * y / 255`, rounded.
+inline int multiply255(int x, int y)
+{
+    int const t = x * y + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+template<Mode M>
+inline int blendScalar(int a, int b)
+{
+    switch (M) {
+    case Mode::Normal:
+        return b;
+    case Mode::Multiply:
+        return multiply255(a, b);
+    case Mode::Screen:
+        return a + b - multiply255(a, b);
+    case Mode::Overlay:
+        return a < 128 ? multiply255(2 * a, b) : 255 - multiply255(2 * (255 - a), 255 - b);
+    case Mode::Difference:
+        return std::abs(a - b);
+    }
+
+    return b;
+}
+
+template<Mode M>
+void rowScalar(uchar const *bottom, uchar const *top, uchar *output, int count, bool alpha)
+{
+    if (!alpha) {
+        for (int i = 0; i < count; ++i) {
+            output[i] = static_cast<uchar>(blendScalar<M>(bottom[i], top[i]));
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; i += 4) {
+        int const topAlpha = top[i + 3];
+
+        for (int c = 0; c < 3; ++c) {
+            int const a = bottom[i + c];
+            int const blended = blendScalar<M>(a, top[i + c]);
+            output[i + c] = static_cast<uchar>(
+                qMin(255, multiply255(a, 255 - topAlpha) + multiply255(blended, topAlpha)));
+        }
+
+        int const bottomAlpha = bottom[i + 3];
+        output[i + 3] = static_cast<uchar>(bottomAlpha + topAlpha - multiply255(bottomAlpha, topAlpha));
+    }
+}
+
+#ifdef SIMD_X86
+
+/*
+ * The vector paths widen the bytes to 16-bit lanes, where the products of
+ * two bytes fit unsigned, and saturate back to bytes. Lanes of the
+ * overlay branch not taken may overflow, they are discarded.
+ */
+
+SIMD_TARGET("sse4.1")
+inline __m128i multiply255Sse41(__m128i const x, __m128i const y)
+{
+    __m128i const t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+template<Mode M>
+SIMD_TARGET("sse4.1")
+inline __m128i blendSse41(__m128i const a, __m128i const b)
+{
+    switch (M) {
+    case Mode::Normal:
+        return b;
+    case Mode::Multiply:
+        return multiply255Sse41(a, b);
+    case Mode::Screen:
+        return _mm_sub_epi16(_mm_add_epi16(a, b), multiply255Sse41(a, b));
+    case Mode::Overlay: {
+        __m128i const full = _mm_set1_epi16(255);
+        __m128i const dark = multiply255Sse41(_mm_slli_epi16(a, 1), b);
+        __m128i const light = _mm_sub_epi16(
+            full, multiply255Sse41(_mm_slli_epi16(_mm_sub_epi16(full, a), 1), _mm_sub_epi16(full, b)));
+        return _mm_blendv_epi8(light, dark, _mm_cmplt_epi16(a, _mm_set1_epi16(128)));
+    }
+    case Mode::Difference:
+        return _mm_abs_epi16(_mm_sub_epi16(a, b));
+    }
+
+    return b;
+}
+
+/// Weights `blended` by the alpha of `top` and composites the alphas, two BGRA pixels.
+SIMD_TARGET("sse4.1")
+inline __m128i compositeSse41(__m128i const a, __m128i const b, __m128i const blended)
+{
+    __m128i const full = _mm_set1_epi16(255);
+    // The alpha of every pixel in all of its lanes.
+    __m128i const topAlpha = _mm_shuffle_epi8(
+        b, _mm_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+
+    __m128i const color = _mm_add_epi16(multiply255Sse41(a, _mm_sub_epi16(full, topAlpha)),
+                                        multiply255Sse41(blended, topAlpha));
+    __m128i const alpha = _mm_sub_epi16(_mm_add_epi16(a, topAlpha), multiply255Sse41(a, topAlpha));
+
+    return _mm_blendv_epi8(color, alpha, _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1));
+}
+
+template<Mode M>
+SIMD_TARGET("sse4.1")
+int rowSse41(uchar const *bottom, uchar const *top, uchar *output, int count, bool alpha)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(bottom + i));
+        __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(top + i));
+
+        __m128i const aLow = _mm_cvtepu8_epi16(a);
+        __m128i const aHigh = _mm_cvtepu8_epi16(_mm_srli_si128(a, 8));
+        __m128i const bLow = _mm_cvtepu8_epi16(b);
+        __m128i const bHigh = _mm_cvtepu8_epi16(_mm_srli_si128(b, 8));
+
+        __m128i low = blendSse41<M>(aLow, bLow);
+        __m128i high = blendSse41<M>(aHigh, bHigh);
+
+        if (alpha) {
+            low = compositeSse41(aLow, bLow, low);
+            high = compositeSse41(aHigh, bHigh, high);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packus_epi16(low, high));
+    }
+
+    return i;
+}
+
+SIMD_TARGET("avx2")
+inline __m256i multiply255Avx2(__m256i const x, __m256i const y)
+{
+    __m256i const t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+template<Mode M>
+SIMD_TARGET("avx2")
+inline __m256i blendAvx2(__m256i const a, __m256i const b)
+{
+    switch (M) {
+    case Mode::Normal:
+        return b;
+    case Mode::Multiply:
+        return multiply255Avx2(a, b);
+    case Mode::Screen:
+        return _mm256_sub_epi16(_mm256_add_epi16(a, b), multiply255Avx2(a, b));
+    case Mode::Overlay: {
+        __m256i const full = _mm256_set1_epi16(255);
+        __m256i const dark = multiply255Avx2(_mm256_slli_epi16(a, 1), b);
+        __m256i const light = _mm256_sub_epi16(
+            full,
+            multiply255Avx2(_mm256_slli_epi16(_mm256_sub_epi16(full, a), 1), _mm256_sub_epi16(full, b)));
+        return _mm256_blendv_epi8(light, dark, _mm256_cmpgt_epi16(_mm256_set1_epi16(128), a));
+    }
+    case Mode::Difference:
+        return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+    }
+
+    return b;
+}
+
+/// Four BGRA pixels, @see compositeSse41.
+SIMD_TARGET("avx2")
+inline __m256i compositeAvx2(__m256i const a, __m256i const b, __m256i const blended)
+{
+    __m256i const full = _mm256_set1_epi16(255);
+    // The shuffle stays within the 128-bit lanes, two pixels each.
+    __m256i const topAlpha = _mm256_shuffle_epi8(
+        b, _mm256_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+                            6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+
+    __m256i const color = _mm256_add_epi16(multiply255Avx2(a, _mm256_sub_epi16(full, topAlpha)),
+                                           multiply255Avx2(blended, topAlpha));
+    __m256i const alpha = _mm256_sub_epi16(_mm256_add_epi16(a, topAlpha),
+                                           multiply255Avx2(a, topAlpha));
+
+    return _mm256_blendv_epi8(color, alpha,
+                              _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1));
+}
+
+template<Mode M>
+SIMD_TARGET("avx2")
+int rowAvx2(uchar const *bottom, uchar const *top, uchar *output, int count, bool alpha)
+{
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(bottom + i));
+        __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(top + i));
+
+        __m256i const aLow = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a));
+        __m256i const aHigh = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1));
+        __m256i const bLow = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b));
+        __m256i const bHigh = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1));
+
+        __m256i low = blendAvx2<M>(aLow, bLow);
+        __m256i high = blendAvx2<M>(aHigh, bHigh);
+
+        if (alpha) {
+            low = compositeAvx2(aLow, bLow, low);
+            high = compositeAvx2(aHigh, bHigh, high);
+        }
+
+        // The pack interleaves the 128-bit lanes of its operands, the permutation restores the order.
+        __m256i const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), packed);
+    }
+
+    return i;
+}
+
+#endif
+
+template<Mode M>
+void blendRows(cv::Mat const &bottom, cv::Mat const &top, cv::Mat &output, bool alpha)
+{
+    int const count = bottom.cols * bottom.channels();
+    Simd::InstructionSet const path = Simd::instructionSet();
+
+    for (int y = 0; y < bottom.rows; ++y) {
+        uchar const *a = bottom.ptr(y);
+        uchar const *b = top.ptr(y);
+        uchar *o = output.ptr(y);
+
+        int done = 0;
+
+#ifdef SIMD_X86
+        if (path == Simd::InstructionSet::Avx2)
+            done = rowAvx2<M>(a, b, o, count, alpha);
+        else if (path == Simd::InstructionSet::Sse41)
+            done = rowSse41<M>(a, b, o, count, alpha);
+#else
+        Q_UNUSED(path);
+#endif
+
+        // The rest of the row, vectors hold a whole number of pixels.
+        rowScalar<M>(a + done, b + done, o + done, count - done, alpha);
+    }
+}
+
+} // namespace
+
+QStringList BlendModes::names()
+{
+    return {"Normal", "Multiply", "Screen", "Overlay", "Difference"};
+}
+
+Mode BlendModes::mode(QString const &name)
+{
+    int const index = names().indexOf(name);
+    return index < 0 ? Mode::Normal : static_cast<Mode>(index);
+}
+
+void BlendModes::blend(Mode mode, cv::Mat const &bottom, cv::Mat const &top, cv::Mat &output, bool alpha)
+{
+    Q_ASSERT(bottom.size() == top.size() && bottom.type() == top.type());
+    Q_ASSERT(!alpha || bottom.channels() == 4);
+
+    switch (mode) {
+    case Mode::Normal:
+        blendRows<Mode::Normal>(bottom, top, output, alpha);
+        break;
+    case Mode::Multiply:
+        blendRows<Mode::Multiply>(bottom, top, output, alpha);
+        break;
+    case Mode::Screen:
+        blendRows<Mode::Screen>(bottom, top, output, alpha);
+        break;
+    case Mode::Overlay:
+        blendRows<Mode::Overlay>(bottom, top, output, alpha);
+        break;
+    case Mode::Difference:
+        blendRows<Mode::Difference>(bottom, top, output, alpha);
+        break;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <opencv2/core.hpp>
+
+/// Fused, vectorized blend modes of two 8-bit images.
+/**
+ * Every mode reads both images once and writes the result, without
+ * temporary images, on the path of Simd::instructionSet(). The results
+ * are computed in integers: `x * y / 255` is rounded, so the paths agree
+ * bit for bit.
+ */
+class BlendModes
+{
+public:
+    enum class Mode
+    {
+        Normal,
+        Multiply,
+        Screen,
+        Overlay,
+        Difference,
+    };
+
+    /// The names of the modes, in the order of `Mode`.
+    static QStringList names();
+
+    /// @returns the mode called `name`, `Normal` for unknown names.
+    static Mode mode(QString const &name);
+
+    /**
+   * Blends `top` over `bottom` into `output`, all of the same size and
+   * type. Without `alpha` every channel is blended. With `alpha` the
+   * images have four channels, the fourth is alpha: the blended color is
+   * weighted by the alpha of `top` and the alphas are composited.
+   */
+    static void blend(Mode mode, cv::Mat const &bottom, cv::Mat const &top, cv::Mat &output, bool alpha);
+};
@@ -0,0 +1,46 @@
+#include "BrightnessContrastKernel.hpp"
+
+#include "BrightnessContrastSimd.hpp"
+
+BrightnessContrastKernel::BrightnessContrastKernel(Parameters const &parameters)
+    : _parameters(parameters)
+{}
+
+BrightnessContrastKernel::Parameters BrightnessContrastKernel::load(QJsonObject const &json,
+                                                                    Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.brightness = json["brightness"].toInt(defaults.brightness);
+    parameters.contrast = json["contrast"].toInt(defaults.contrast);
+    return parameters;
+}
+
+std::shared_ptr<LookupTable const> BrightnessContrastKernel::lookupTable(ImageBuffer::Format format) const
+{
+    return table(ImageBuffer::channels(format));
+}
+
+void BrightnessContrastKernel::apply(cv::Mat const &input,
+                                     std::vector<cv::Mat> const &,
+                                     cv::Mat &output) const
+{
+    BrightnessContrastSimd::apply(input, output, _parameters.brightness, _parameters.contrast);
+}
+
+std::shared_ptr<LookupTable const> BrightnessContrastKernel::table(int channels) const
+{
+    int const brightness = _parameters.brightness;
+    int const contrast = _parameters.contrast;
+
+    // The alpha channel of four-channel formats is kept.
+    return std::make_shared<LookupTable const>(
+        LookupTable::fromFunction(channels, [brightness, contrast](int v) {
+            return ((v - 127) * contrast / 100) + 127 + brightness;
+        }));
+}
+
+void BrightnessContrastKernel::save(QJsonObject &json) const
+{
+    json["brightness"] = _parameters.brightness;
+    json["contrast"] = _parameters.contrast;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "PointwiseKernel.hpp"
+
+/// Shifts the brightness and scales the contrast of the color channels.
+class BrightnessContrastKernel : public PointwiseKernel
+{
+public:
+    struct Parameters
+    {
+        /// Offset added to the channels, -100 to 100.
+        int brightness = 0;
+
+        /// Percentage the channels are scaled by around the mid gray, -100 to 100.
+        int contrast = 0;
+    };
+
+    explicit BrightnessContrastKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+public:
+    std::shared_ptr<LookupTable const> lookupTable(ImageBuffer::Format format) const override;
+
+    /// Computes the pixels with the vector instructions of the CPU.
+    void apply(cv::Mat const &input, std::vector<cv::Mat> const &extras, cv::Mat &output) const override;
+
+    void save(QJsonObject &json) const override;
+
+private:
+    std::shared_ptr<LookupTable const> table(int channels) const;
+
+private:
+    Parameters _parameters;
+};
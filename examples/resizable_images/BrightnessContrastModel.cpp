@@ -1,33 +1,17 @@
 #include "BrightnessContrastModel.hpp"
-#include <QImage>
-#include <QPainter>
 
-BrightnessContrastModel::BrightnessContrastModel()
-{
-    _widget = new QWidget;
-    auto *layout = new QVBoxLayout(_widget);
-
-    _previewLabel = new QLabel("No image");
-    _previewLabel->setAlignment(Qt::AlignCenter);
-    _previewLabel->setMinimumSize(200, 200);
+#include "ProxyPreview.hpp"
 
-    _brightnessSlider = new QSlider(Qt::Horizontal);
-    _brightnessSlider->setRange(-100, 100);
-    _brightnessSlider->setValue(0);
+#include <QtCore/QSignalBlocker>
 
-    _contrastSlider = new QSlider(Qt::Horizontal);
-    _contrastSlider->setRange(-100, 100);
-    _contrastSlider->setValue(0);
-
-    layout->addWidget(_previewLabel);
-    layout->addWidget(new QLabel("Brightness"));
-    layout->addWidget(_brightnessSlider);
-    layout->addWidget(new QLabel("Contrast"));
-    layout->addWidget(_contrastSlider);
-
-    connect(_brightnessSlider, &QSlider::valueChanged, this, &BrightnessContrastModel::onValueChanged);
-    connect(_contrastSlider, &QSlider::valueChanged, this, &BrightnessContrastModel::onValueChanged);
-}
+BrightnessContrastModel::BrightnessContrastModel()
+    : _kernel(std::make_shared<BrightnessContrastKernel const>())
+    , _deferredOutput(false)
+    , _widget(nullptr)
+    , _previewLabel(nullptr)
+    , _brightnessSlider(nullptr)
+    , _contrastSlider(nullptr)
+{}
 
 QString BrightnessContrastModel::caption() const {
     return QString("Brightness/Contrast");
@@ -41,54 +25,156 @@ QString BrightnessContrastModel::modelName() const {
     return QString("Brightness/Contrast");
 }
 
+QJsonObject BrightnessContrastModel::save() const {
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
+
+void BrightnessContrastModel::load(QJsonObject const &modelJson) {
+    setParameters(BrightnessContrastKernel::load(modelJson, _kernel->parameters()));
+}
+
 unsigned int BrightnessContrastModel::nPorts(QtNodes::PortType portType) const {
     return (portType == QtNodes::PortType::In || portType == QtNodes::PortType::Out) ? 1 : 0;
 }
 
 QtNodes::NodeDataType BrightnessContrastModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<QtNodes::NodeData> BrightnessContrastModel::outData(QtNodes::PortIndex) {
-    return std::make_shared<PixmapData>(_processedPixmap);
+    return _output;
+}
+
+QJsonObject BrightnessContrastModel::computationParameters() const {
+    QJsonObject parameters;
+    _kernel->save(parameters);
+    parameters["deferred"] = _deferredOutput && !_widget;
+    ImageRequest::save(_outRequest, parameters);
+    return parameters;
+}
+
+bool BrightnessContrastModel::restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) {
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d) return false;
+
+    _output = d;
+    updatePreview();
+    return true;
 }
 
 void BrightnessContrastModel::setInData(std::shared_ptr<QtNodes::NodeData> data, QtNodes::PortIndex) {
-    _nodeData = data;
-    if (auto d = std::dynamic_pointer_cast<PixmapData>(data)) {
-        _originalPixmap = d->pixmap();
-        _previewLabel->setPixmap(_originalPixmap.scaled(_previewLabel->size(), Qt::KeepAspectRatio));
-         _previewLabel->setToolTip(QString("Size: %1 x %2")
-            .arg(_originalPixmap.width())
-            .arg(_originalPixmap.height()));
-        onValueChanged();
+    auto d = std::dynamic_pointer_cast<ImageData>(data);
+    if (d && !d->isNull()) {
+        _input = d;
+        if (_previewLabel) {
+            _previewLabel->setPixmap(_input->toPixmap(_previewLabel->size()));
+            _previewLabel->setToolTip(QString("Size: %1 x %2")
+                .arg(_input->width())
+                .arg(_input->height()));
+        }
+        compute();
     }
 }
 
+std::shared_ptr<QtNodes::NodeDataRequest const> BrightnessContrastModel::inRequest(QtNodes::PortIndex) const {
+    // A pointwise operation needs just the requested pixels.
+    return _outRequest;
+}
+
+bool BrightnessContrastModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                                            QtNodes::PortIndex) {
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
+}
+
 QWidget *BrightnessContrastModel::embeddedWidget() {
+    if (_widget)
+        return _widget;
+
+    _widget = new QWidget;
+    auto *layout = new QVBoxLayout(_widget);
+
+    _previewLabel = new QLabel("No image");
+    _previewLabel->setAlignment(Qt::AlignCenter);
+    _previewLabel->setMinimumSize(200, 200);
+
+    _brightnessSlider = new QSlider(Qt::Horizontal);
+    _brightnessSlider->setRange(-100, 100);
+    _brightnessSlider->setValue(_kernel->parameters().brightness);
+
+    _contrastSlider = new QSlider(Qt::Horizontal);
+    _contrastSlider->setRange(-100, 100);
+    _contrastSlider->setValue(_kernel->parameters().contrast);
+
+    layout->addWidget(_previewLabel);
+    layout->addWidget(new QLabel("Brightness"));
+    layout->addWidget(_brightnessSlider);
+    layout->addWidget(new QLabel("Contrast"));
+    layout->addWidget(_contrastSlider);
+
+    connect(_brightnessSlider, &QSlider::valueChanged, this, &BrightnessContrastModel::onValueChanged);
+    connect(_contrastSlider, &QSlider::valueChanged, this, &BrightnessContrastModel::onValueChanged);
+
+    ProxyPreview::instance().trackSlider(_brightnessSlider);
+    ProxyPreview::instance().trackSlider(_contrastSlider);
+
+    updatePreview();
+
     return _widget;
 }
 
-void BrightnessContrastModel::onValueChanged() {
-    if (_originalPixmap.isNull()) return;
+void BrightnessContrastModel::setParameters(BrightnessContrastKernel::Parameters const &parameters) {
+    _kernel = std::make_shared<BrightnessContrastKernel const>(parameters);
+
+    if (_widget) {
+        QSignalBlocker const brightnessBlocker(_brightnessSlider);
+        QSignalBlocker const contrastBlocker(_contrastSlider);
+        _brightnessSlider->setValue(parameters.brightness);
+        _contrastSlider->setValue(parameters.contrast);
+    }
 
-    QImage img = _originalPixmap.toImage().convertToFormat(QImage::Format_ARGB32);
+    compute();
+}
 
-    int brightness = _brightnessSlider->value();
-    int contrast = _contrastSlider->value();
+void BrightnessContrastModel::setDeferredOutput(bool deferred) {
+    if (deferred == _deferredOutput) return;
 
-    for (int y = 0; y < img.height(); ++y) {
-        QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(y));
-        for (int x = 0; x < img.width(); ++x) {
-            QColor clr = QColor::fromRgba(line[x]);
-            int r = qBound(0, ((clr.red() - 127) * contrast / 100) + 127 + brightness, 255);
-            int g = qBound(0, ((clr.green() - 127) * contrast / 100) + 127 + brightness, 255);
-            int b = qBound(0, ((clr.blue() - 127) * contrast / 100) + 127 + brightness, 255);
-            line[x] = qRgba(r, g, b, clr.alpha());
-        }
-    }
+    _deferredOutput = deferred;
+    compute();
+}
+
+void BrightnessContrastModel::onValueChanged() {
+    BrightnessContrastKernel::Parameters parameters = _kernel->parameters();
+    parameters.brightness = _brightnessSlider->value();
+    parameters.contrast = _contrastSlider->value();
+    setParameters(parameters);
+}
+
+void BrightnessContrastModel::compute() {
+    if (!_input) return;
+
+    std::shared_ptr<BrightnessContrastKernel const> const kernel = _kernel;
+    ImageKernel::Inputs const inputs{_input};
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
+    // The preview needs the pixels.
+    bool const defer = _deferredOutput && !_widget;
+
+    runComputation([this, kernel, inputs, request, defer]() {
+        std::shared_ptr<ImageData> const result
+            = defer ? kernel->defer(inputs, request)
+                    : kernel->compute(inputs, request, []() { return computationCancelled(); });
+
+        return [this, result]() {
+            _output = result;
+            updatePreview();
+            Q_EMIT dataUpdated(0);
+        };
+    });
+}
 
-    _processedPixmap = QPixmap::fromImage(img);
-    _previewLabel->setPixmap(_processedPixmap.scaled(_previewLabel->size(), Qt::KeepAspectRatio));
-    Q_EMIT dataUpdated(0);
+void BrightnessContrastModel::updatePreview() {
+    if (_previewLabel && _output)
+        _previewLabel->setPixmap(_output->toPixmap(_previewLabel->size()));
 }
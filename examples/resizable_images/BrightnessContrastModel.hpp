@@ -7,9 +7,13 @@
 
 #include <QtNodes/NodeDelegateModel>
 
-#include "PixmapData.hpp"
+#include "BrightnessContrastKernel.hpp"
+#include "ImageData.hpp"
+#include "PointwiseFusion.hpp"
 
-class BrightnessContrastModel : public QtNodes::NodeDelegateModel
+class BrightnessContrastModel
+    : public QtNodes::NodeDelegateModel
+    , public PointwiseModel
 {
     Q_OBJECT
 
@@ -21,26 +25,58 @@ public:
     QString name() const override;
     QString modelName() const;
 
+    QJsonObject save() const override;
+    void load(QJsonObject const &modelJson) override;
+
     unsigned int nPorts(QtNodes::PortType portType) const override;
     QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override;
 
     std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex port) override;
+
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) override;
+
     void setInData(std::shared_ptr<QtNodes::NodeData> data, QtNodes::PortIndex port) override;
 
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(QtNodes::PortIndex port) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       QtNodes::PortIndex port) override;
+
     QWidget *embeddedWidget() override;
     bool resizable() const override { return true; }
 
+    std::shared_ptr<BrightnessContrastKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and recomputes the output.
+    void setParameters(BrightnessContrastKernel::Parameters const &parameters);
+
+    void setDeferredOutput(bool deferred) override;
+
 private Q_SLOTS:
     void onValueChanged();
 
 private:
-    QPixmap _originalPixmap;
-    QPixmap _processedPixmap;
+    void compute();
+
+    void updatePreview();
+
+private:
+    std::shared_ptr<ImageData> _input;
+    std::shared_ptr<ImageData> _output;
 
+    std::shared_ptr<ImageRequest const> _outRequest;
+
+    std::shared_ptr<BrightnessContrastKernel const> _kernel;
+
+    bool _deferredOutput;
+
+    // Created by `embeddedWidget`, headless graphs have none.
     QWidget *_widget;
     QLabel *_previewLabel;
     QSlider *_brightnessSlider;
     QSlider *_contrastSlider;
-
-    std::shared_ptr<QtNodes::NodeData> _nodeData;
 };
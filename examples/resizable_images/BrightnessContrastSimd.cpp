@@ -0,0 +1,153 @@
+#include "BrightnessContrastSimd.hpp"
+
+#include "Simd.hpp"
+
+#include <QtCore/QtGlobal>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+using InstructionSet = Simd::InstructionSet;
+
+namespace {
+
+void applyScalar(uchar const *source, uchar *destination, int count, int channels,
+                 int brightness, int contrast)
+{
+    for (int i = 0; i < count; ++i) {
+        // The alpha channel of four-channel formats is kept.
+        if (channels == 4 && i % 4 == 3) {
+            destination[i] = source[i];
+            continue;
+        }
+
+        int const v = source[i];
+        destination[i] = static_cast<uchar>(
+            qBound(0, ((v - 127) * contrast / 100) + 127 + brightness, 255));
+    }
+}
+
+#ifdef SIMD_X86
+
+/*
+ * The vector paths work on 16-bit lanes: (v - 127) * contrast fits in
+ * -12800..12800 for contrasts within -100..100. The division by 100 is a
+ * multiplication by 2^19 / 100, rounded up, which is exact in that range;
+ * subtracting the sign turns its floor into the truncation of C.
+ */
+short const divisionMultiplier = 5243;
+int const divisionShift = 3;
+
+SIMD_TARGET("sse4.1")
+__m128i adjustSse41(__m128i const values, __m128i const contrast, __m128i const offset)
+{
+    __m128i const centered = _mm_sub_epi16(values, _mm_set1_epi16(127));
+    __m128i const product = _mm_mullo_epi16(centered, contrast);
+    __m128i const quotient = _mm_sub_epi16(
+        _mm_srai_epi16(_mm_mulhi_epi16(product, _mm_set1_epi16(divisionMultiplier)), divisionShift),
+        _mm_srai_epi16(product, 15));
+    return _mm_add_epi16(quotient, offset);
+}
+
+SIMD_TARGET("sse4.1")
+int applySse41(uchar const *source, uchar *destination, int count, int channels,
+               int brightness, int contrast)
+{
+    __m128i const contrastVector = _mm_set1_epi16(static_cast<short>(contrast));
+    __m128i const offset = _mm_set1_epi16(static_cast<short>(127 + brightness));
+    // Selects the alpha bytes, vectors start on pixel boundaries.
+    __m128i const alpha = channels == 4 ? _mm_set1_epi32(static_cast<int>(0xFF000000u))
+                                        : _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(source + i));
+
+        __m128i const low = adjustSse41(_mm_cvtepu8_epi16(pixels), contrastVector, offset);
+        __m128i const high = adjustSse41(_mm_cvtepu8_epi16(_mm_srli_si128(pixels, 8)),
+                                         contrastVector,
+                                         offset);
+
+        // Saturating to bytes clamps to 0..255.
+        __m128i const result = _mm_blendv_epi8(_mm_packus_epi16(low, high), pixels, alpha);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), result);
+    }
+
+    return i;
+}
+
+SIMD_TARGET("avx2")
+__m256i adjustAvx2(__m256i const values, __m256i const contrast, __m256i const offset)
+{
+    __m256i const centered = _mm256_sub_epi16(values, _mm256_set1_epi16(127));
+    __m256i const product = _mm256_mullo_epi16(centered, contrast);
+    __m256i const quotient = _mm256_sub_epi16(
+        _mm256_srai_epi16(_mm256_mulhi_epi16(product, _mm256_set1_epi16(divisionMultiplier)),
+                          divisionShift),
+        _mm256_srai_epi16(product, 15));
+    return _mm256_add_epi16(quotient, offset);
+}
+
+SIMD_TARGET("avx2")
+int applyAvx2(uchar const *source, uchar *destination, int count, int channels,
+              int brightness, int contrast)
+{
+    __m256i const contrastVector = _mm256_set1_epi16(static_cast<short>(contrast));
+    __m256i const offset = _mm256_set1_epi16(static_cast<short>(127 + brightness));
+    __m256i const alpha = channels == 4 ? _mm256_set1_epi32(static_cast<int>(0xFF000000u))
+                                        : _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(source + i));
+
+        __m256i const low = adjustAvx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(pixels)),
+                                       contrastVector,
+                                       offset);
+        __m256i const high = adjustAvx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(pixels, 1)),
+                                        contrastVector,
+                                        offset);
+
+        // The pack interleaves the 128-bit lanes of its operands, the permutation restores the order.
+        __m256i const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        __m256i const result = _mm256_blendv_epi8(packed, pixels, alpha);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), result);
+    }
+
+    return i;
+}
+
+#endif
+
+} // namespace
+
+void BrightnessContrastSimd::apply(cv::Mat const &input, cv::Mat &output, int brightness, int contrast)
+{
+    int const channels = input.channels();
+    int const count = input.cols * channels;
+
+    bool const vectorizable = qAbs(brightness) <= 100 && qAbs(contrast) <= 100;
+    InstructionSet const path = vectorizable ? Simd::instructionSet() : InstructionSet::Scalar;
+
+    for (int y = 0; y < input.rows; ++y) {
+        uchar const *source = input.ptr(y);
+        uchar *destination = output.ptr(y);
+
+        int done = 0;
+
+#ifdef SIMD_X86
+        if (path == InstructionSet::Avx2)
+            done = applyAvx2(source, destination, count, channels, brightness, contrast);
+        else if (path == InstructionSet::Sse41)
+            done = applySse41(source, destination, count, channels, brightness, contrast);
+#else
+        Q_UNUSED(path);
+#endif
+
+        // The rest of the row, vectors hold a whole number of pixels.
+        applyScalar(source + done, destination + done, count - done, channels, brightness, contrast);
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+/// Vectorized brightness and contrast on interleaved 8-bit pixels.
+/**
+ * Computes `((v - 127) * contrast / 100) + 127 + brightness`, clamped to
+ * 0..255, for the color channels of every pixel, the same result as the
+ * scalar formula, on the path of Simd::instructionSet().
+ */
+class BrightnessContrastSimd
+{
+public:
+    /**
+   * Maps `input` into `output` of the same size and type. The fourth
+   * channel of four-channel pixels is alpha and is copied. Parameters
+   * outside of -100..100 take the scalar path.
+   */
+    static void apply(cv::Mat const &input, cv::Mat &output, int brightness, int contrast);
+};
@@ -0,0 +1,230 @@
+#include "Convolution.hpp"
+
+#include "TileEngine.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * The spectra of the kernels by transform size. The tiles of an image come
+ * in a few sizes only, those at the right and bottom edge, and a kernel is
+ * usually applied again and again while the graph is edited.
+ */
+class SpectrumCache
+{
+public:
+    /// @returns the transform of the `CV_32F` `kernel` zero-padded to `size`.
+    std::shared_ptr<cv::Mat const> spectrum(cv::Mat const &kernel, cv::Size const &size)
+    {
+        {
+            std::lock_guard<std::mutex> const lock(_mutex);
+
+            for (auto entry = _entries.begin(); entry != _entries.end(); ++entry) {
+                if (entry->size == size && sameKernel(entry->kernel, kernel)) {
+                    // Keeps the most recent entries in front.
+                    _entries.splice(_entries.begin(), _entries, entry);
+                    return _entries.front().spectrum;
+                }
+            }
+        }
+
+        // Transformed outside the lock, the tiles of another size go on meanwhile.
+        cv::Mat plane = cv::Mat::zeros(size, CV_32F);
+        cv::Mat corner = plane(cv::Rect(0, 0, kernel.cols, kernel.rows));
+        kernel.copyTo(corner);
+        cv::dft(plane, plane, 0, kernel.rows);
+
+        auto const spectrum = std::make_shared<cv::Mat const>(plane);
+
+        std::lock_guard<std::mutex> const lock(_mutex);
+        _entries.push_front(Entry{kernel.clone(), size, spectrum});
+        if (_entries.size() > capacity)
+            _entries.pop_back();
+
+        return spectrum;
+    }
+
+private:
+    static std::size_t const capacity = 32;
+
+    struct Entry
+    {
+        cv::Mat kernel;
+        cv::Size size;
+        std::shared_ptr<cv::Mat const> spectrum;
+    };
+
+    static bool sameKernel(cv::Mat const &a, cv::Mat const &b)
+    {
+        return a.size() == b.size() && a.type() == b.type()
+               && std::memcmp(a.data, b.data, a.total() * a.elemSize()) == 0;
+    }
+
+    std::mutex _mutex;
+    std::list<Entry> _entries;
+};
+
+SpectrumCache &spectra()
+{
+    static SpectrumCache cache;
+    return cache;
+}
+
+/// Correlates the tile with the continuous `CV_32F` `kernel` in the frequency domain.
+void convolveFourier(cv::Mat const &source, cv::Rect const &tile, cv::Mat const &kernel, cv::Mat &destination)
+{
+    // The filter2D anchor, the border is reflected at the edges of the input only.
+    cv::Point const anchor(kernel.cols / 2, kernel.rows / 2);
+    cv::Mat padded;
+    cv::copyMakeBorder(source(tile), padded,
+                       anchor.y, kernel.rows - 1 - anchor.y,
+                       anchor.x, kernel.cols - 1 - anchor.x,
+                       cv::BORDER_REFLECT_101);
+
+    cv::Size const size(cv::getOptimalDFTSize(padded.cols), cv::getOptimalDFTSize(padded.rows));
+    std::shared_ptr<cv::Mat const> const spectrum = spectra().spectrum(kernel, size);
+
+    std::vector<cv::Mat> channels;
+    cv::split(padded, channels);
+
+    for (cv::Mat &channel : channels) {
+        cv::Mat plane = cv::Mat::zeros(size, CV_32F);
+        cv::Mat corner = plane(cv::Rect(0, 0, padded.cols, padded.rows));
+        channel.convertTo(corner, CV_32F);
+
+        // The padding of the transform size exceeds the kernel, the
+        // circular correlation does not wrap into the tile.
+        cv::dft(plane, plane, 0, padded.rows);
+        cv::mulSpectrums(plane, *spectrum, plane, 0, true);
+        cv::idft(plane, plane, cv::DFT_SCALE, tile.height);
+
+        channel = plane(cv::Rect(0, 0, tile.width, tile.height));
+    }
+
+    cv::Mat filtered;
+    cv::merge(channels, filtered);
+    filtered.convertTo(destination, destination.type());
+}
+
+} // namespace
+
+Convolution::Strategy Convolution::strategy(cv::Mat const &kernel)
+{
+    cv::Mat column;
+    cv::Mat row;
+    if (separate(kernel, column, row))
+        return Strategy::Separable;
+
+    if (std::max(kernel.rows, kernel.cols) >= fourierSize())
+        return Strategy::Fourier;
+
+    return Strategy::Direct;
+}
+
+QString Convolution::name(Strategy strategy)
+{
+    switch (strategy) {
+    case Strategy::Direct:
+        return "direct";
+    case Strategy::Separable:
+        return "separable";
+    case Strategy::Fourier:
+        return "fourier";
+    }
+
+    return QString();
+}
+
+int Convolution::fourierSize()
+{
+    return 15;
+}
+
+bool Convolution::separate(cv::Mat const &kernel, cv::Mat &column, cv::Mat &row)
+{
+    if (kernel.empty())
+        return false;
+
+    cv::Mat coefficients;
+    kernel.convertTo(coefficients, CV_64F);
+
+    cv::Mat w;
+    cv::Mat u;
+    cv::Mat vt;
+    cv::SVD::compute(coefficients, w, u, vt);
+
+    // The singular values come in descending order, rank one leaves the first only.
+    double const first = w.at<double>(0);
+    double const second = w.rows > 1 ? w.at<double>(1) : 0.0;
+    if (first <= 0.0 || second > 1e-6 * first)
+        return false;
+
+    double const scale = std::sqrt(first);
+    cv::Mat(u.col(0) * scale).convertTo(column, CV_32F);
+    cv::Mat(vt.row(0) * scale).convertTo(row, CV_32F);
+    return true;
+}
+
+cv::Mat Convolution::convolve(cv::Mat const &input,
+                              cv::Rect const &area,
+                              cv::Mat const &kernel,
+                              CancelCheck const &cancelled)
+{
+    return convolve(input, area, kernel, strategy(kernel), cancelled);
+}
+
+cv::Mat Convolution::convolve(cv::Mat const &input,
+                              cv::Rect const &area,
+                              cv::Mat const &kernel,
+                              Strategy strategy,
+                              CancelCheck const &cancelled)
+{
+    if (cancelled && cancelled())
+        return cv::Mat();
+
+    // A continuous copy, the spectrum cache compares the coefficients bytewise.
+    cv::Mat coefficients;
+    kernel.convertTo(coefficients, CV_32F);
+
+    cv::Mat column;
+    cv::Mat row;
+    if (strategy == Strategy::Separable && !separate(coefficients, column, row))
+        strategy = Strategy::Direct;
+
+    int const halo = std::max(coefficients.rows, coefficients.cols) / 2;
+
+    cv::Mat const result = TileEngine::process(input, area, input.type(), halo,
+        [&](cv::Mat const &source, cv::Rect const &tile, cv::Mat &destination) {
+            if (cancelled && cancelled())
+                return;
+
+            // The filters read the halo from around the view.
+            switch (strategy) {
+            case Strategy::Direct:
+                cv::filter2D(source(tile), destination, -1, coefficients, cv::Point(-1, -1), 0,
+                             cv::BORDER_REFLECT_101);
+                break;
+            case Strategy::Separable:
+                cv::sepFilter2D(source(tile), destination, -1, row, column, cv::Point(-1, -1), 0,
+                                cv::BORDER_REFLECT_101);
+                break;
+            case Strategy::Fourier:
+                convolveFourier(source, tile, coefficients, destination);
+                break;
+            }
+        });
+
+    if (cancelled && cancelled())
+        return cv::Mat();
+
+    return result;
+}
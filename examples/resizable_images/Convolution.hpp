@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QtCore/QString>
+
+#include <opencv2/core.hpp>
+
+#include <functional>
+
+/// Convolution of 8-bit images of any channel count with kernels of any size.
+/**
+ * Like `cv::filter2D` the kernel is not flipped and anchored at its
+ * center, the border of the input is reflected. One of three strategies is
+ * picked from the kernel:
+ *
+ * - kernels of rank one are split into a column and a row and run as two
+ *   1-D passes, which costs `rows + cols` instead of `rows * cols`
+ *   multiplications per pixel;
+ * - other kernels from `fourierSize()` on are multiplied with the tiles in
+ *   the frequency domain. The transform size and the spectrum of the
+ *   kernel of each tile size are computed once and cached, later calls
+ *   with the same kernel only transform the tiles;
+ * - the small rest goes through OpenCV's vectorized direct filter.
+ *
+ * Every strategy runs on the tiles of the TileEngine.
+ */
+class Convolution
+{
+public:
+    using CancelCheck = std::function<bool()>;
+
+    enum class Strategy
+    {
+        Direct,
+        Separable,
+        Fourier,
+    };
+
+    /// The strategy `convolve` picks for `kernel`.
+    static Strategy strategy(cv::Mat const &kernel);
+
+    static QString name(Strategy strategy);
+
+    /// Edge length from which kernels that are not separable go through the Fourier transform.
+    static int fourierSize();
+
+    /**
+   * Splits `kernel` into `column * row` if its rank is one, up to rounding.
+   * @returns false for other kernels, leaving `column` and `row` untouched.
+   */
+    static bool separate(cv::Mat const &kernel, cv::Mat &column, cv::Mat &row);
+
+    /**
+   * @returns the pixels `area` of `input` convolved with `kernel`, empty if
+   * the computation was cancelled. The pixels around the area are read up
+   * to half the kernel size.
+   */
+    static cv::Mat convolve(cv::Mat const &input,
+                            cv::Rect const &area,
+                            cv::Mat const &kernel,
+                            CancelCheck const &cancelled = CancelCheck());
+
+    /// As above with a given strategy. Kernels that are not separable fall back to `Direct`.
+    static cv::Mat convolve(cv::Mat const &input,
+                            cv::Rect const &area,
+                            cv::Mat const &kernel,
+                            Strategy strategy,
+                            CancelCheck const &cancelled = CancelCheck());
+};
@@ -1,36 +1,48 @@
 #include "ConvolutionFilterModel.hpp"
+
+#include "ProxyPreview.hpp"
+
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/core.hpp>
 
+#include <QtCore/QSignalBlocker>
+#include <QtCore/QStringList>
 #include <QImage>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 
-ConvolutionFilterModel::ConvolutionFilterModel()
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+QString coefficientsText(std::vector<float> const &coefficients)
 {
-    _widget = new QWidget;
-    _previewLabel = new QLabel("Preview");
-    _presetBox = new QComboBox;
-    _kernelSizeBox = new QSpinBox;
-    _applyButton = new QPushButton("Apply");
+    QStringList numbers;
+    for (float const coefficient : coefficients) {
+        numbers.append(QString::number(coefficient));
+    }
+    return numbers.join(' ');
+}
 
-    _presetBox->addItems({ "Sharpen", "Emboss", "Edge Enhance" });
-    _kernelSizeBox->setRange(3, 5);
-    _kernelSizeBox->setSingleStep(2);
-    _kernelSizeBox->setValue(3);
+} // namespace
 
-    auto *layout = new QVBoxLayout(_widget);
-    layout->addWidget(_previewLabel);
+ConvolutionFilterModel::ConvolutionFilterModel()
+    : _kernel(std::make_shared<ConvolutionKernel const>())
+{
+}
 
-    auto *controlLayout = new QHBoxLayout;
-    controlLayout->addWidget(_presetBox);
-    controlLayout->addWidget(_kernelSizeBox);
-    controlLayout->addWidget(_applyButton);
-    layout->addLayout(controlLayout);
+QJsonObject ConvolutionFilterModel::save() const
+{
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
 
-    connect(_applyButton, &QPushButton::clicked, this, &ConvolutionFilterModel::applyFilter);
-    connect(_presetBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ConvolutionFilterModel::presetChanged);
+void ConvolutionFilterModel::load(QJsonObject const &modelJson)
+{
+    setParameters(ConvolutionKernel::load(modelJson, _kernel->parameters()));
 }
 
 unsigned int ConvolutionFilterModel::nPorts(QtNodes::PortType portType) const
@@ -40,143 +52,188 @@ unsigned int ConvolutionFilterModel::nPorts(QtNodes::PortType portType) const
 
 QtNodes::NodeDataType ConvolutionFilterModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const
 {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<QtNodes::NodeData> ConvolutionFilterModel::outData(QtNodes::PortIndex)
 {
-    return std::make_shared<PixmapData>(_filteredPixmap);
+    return _output;
+}
+
+QJsonObject ConvolutionFilterModel::computationParameters() const
+{
+    QJsonObject parameters;
+    effectiveKernel()->save(parameters);
+    ImageRequest::save(_outRequest, parameters);
+    return parameters;
+}
+
+bool ConvolutionFilterModel::restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs)
+{
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d)
+        return false;
+
+    _output = d;
+    if (_previewLabel)
+        _previewLabel->setPixmap(_output->toPixmap(QSize(200, 200)));
+    return true;
 }
 
 void ConvolutionFilterModel::setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex)
 {
-    _nodeData = nodeData;
+    auto d = std::dynamic_pointer_cast<ImageData>(nodeData);
 
-    if (auto d = std::dynamic_pointer_cast<PixmapData>(nodeData)) {
-        _inputPixmap = d->pixmap();
-        _previewLabel->setPixmap(_inputPixmap.scaled(200, 200, Qt::KeepAspectRatio));
+    if (d && !d->isNull()) {
+        _input = d;
+        if (_previewLabel)
+            _previewLabel->setPixmap(_input->toPixmap(QSize(200, 200)));
+
+        // Emits dataUpdated once the filtered image is ready.
         applyFilter();
     } else {
-        _inputPixmap = QPixmap();
-        _previewLabel->clear();
+        _input.reset();
+        _output.reset();
+        if (_previewLabel)
+            _previewLabel->clear();
+
+        Q_EMIT dataUpdated(0);
     }
+}
 
-    Q_EMIT dataUpdated(0);
+std::shared_ptr<QtNodes::NodeDataRequest const> ConvolutionFilterModel::inRequest(QtNodes::PortIndex) const
+{
+    return ImageRequest::grown(_outRequest, footprint());
 }
 
-cv::Mat ConvolutionFilterModel::applyConvolution(const QPixmap &pixmap, const cv::Mat &kernel)
+bool ConvolutionFilterModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                                           QtNodes::PortIndex)
 {
-    QImage image = pixmap.toImage().convertToFormat(QImage::Format_RGB888);
-    cv::Mat src(image.height(), image.width(), CV_8UC3, const_cast<uchar *>(image.bits()), image.bytesPerLine());
-    cv::Mat dst;
-    cv::filter2D(src, dst, -1, kernel);
-    return dst;
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
 }
-cv::Mat ConvolutionFilterModel::getPresetKernel(const QString &preset, int size)
+
+QSizeF ConvolutionFilterModel::footprint() const
 {
-    if (preset == "Sharpen")
-    {
-        if (size == 3)
-        {
-            return (cv::Mat_<float>(3, 3) << 
-                    0, -1,  0,
-                   -1,  5, -1,
-                    0, -1,  0);
-        }
-        else
-        {
-            return cv::Mat::eye(size, size, CV_32F);
-        }
-    }
-    else if (preset == "Emboss")
-    {
-        if (size == 3)
-        {
-            return (cv::Mat_<float>(3, 3) <<
-                   -2, -1, 0,
-                   -1,  1, 1,
-                    0,  1, 2);
-        }
-        else
-        {
-            return cv::Mat::eye(size, size, CV_32F);
-        }
-    }
-    else if (preset == "Edge Enhance")
-    {
-        if (size == 3)
-        {
-            return (cv::Mat_<float>(3, 3) <<
-                    0,  0,  0,
-                   -1,  1,  0,
-                    0,  0,  0);
-        }
-        else
-        {
-            return cv::Mat::eye(size, size, CV_32F);
-        }
-    }
+    if (!_input)
+        return QSizeF();
 
-    return cv::Mat::eye(size, size, CV_32F);
+    return _input->pixelSize() * effectiveKernel()->halo();
 }
 
+std::shared_ptr<ConvolutionKernel const> ConvolutionFilterModel::effectiveKernel() const
+{
+    // The kernel size is given in pixels of the full resolution.
+    double const factor = ProxyPreview::instance().currentFactor();
+    return factor < 1.0 ? _kernel->scaled(factor) : _kernel;
+}
 
-cv::Mat ConvolutionFilterModel::getKernelFromPreset(const QString &preset, int size)
+QWidget *ConvolutionFilterModel::embeddedWidget()
 {
-    if (preset == "Sharpen") {
-        if (size == 3) {
-            cv::Mat_<float> k(3, 3);
-            k <<  0, -1,  0,
-                -1,  5, -1,
-                 0, -1,  0;
-            return k;
-        }
-    }
-    else if (preset == "Emboss") {
-        if (size == 3) {
-            cv::Mat_<float> k(3, 3);
-            k << -2, -1,  0,
-                -1,  1,  1,
-                 0,  1,  2;
-            return k;
-        }
-    }
-    else if (preset == "Edge Enhance") {
-        if (size == 3) {
-            cv::Mat_<float> k(3, 3);
-            k <<  0,  0,  0,
-                 -1,  1,  0,
-                  0,  0,  0;
-            return k;
-        }
-    }
+    if (_widget)
+        return _widget;
+
+    _widget = new QWidget;
+    _previewLabel = new QLabel("Preview");
+    _presetBox = new QComboBox;
+    _kernelSizeBox = new QSpinBox;
+    _coefficientsEdit = new QLineEdit;
+    _applyButton = new QPushButton("Apply");
+
+    _presetBox->addItems({ "Sharpen", "Emboss", "Edge Enhance", "Box Blur", "Custom" });
+    _presetBox->setCurrentText(_kernel->parameters().preset);
+    _kernelSizeBox->setRange(1, 99);
+    _kernelSizeBox->setSingleStep(2);
+    _kernelSizeBox->setValue(_kernel->parameters().kernelSize);
+    _coefficientsEdit->setPlaceholderText("Custom coefficients, row by row");
+    _coefficientsEdit->setText(coefficientsText(_kernel->parameters().coefficients));
+    _coefficientsEdit->setEnabled(_kernel->parameters().preset == "Custom");
+
+    auto *layout = new QVBoxLayout(_widget);
+    layout->addWidget(_previewLabel);
+
+    auto *controlLayout = new QHBoxLayout;
+    controlLayout->addWidget(_presetBox);
+    controlLayout->addWidget(_kernelSizeBox);
+    controlLayout->addWidget(_applyButton);
+    layout->addLayout(controlLayout);
+    layout->addWidget(_coefficientsEdit);
+
+    if (_output)
+        _previewLabel->setPixmap(_output->toPixmap(QSize(200, 200)));
+
+    connect(_applyButton, &QPushButton::clicked, this, &ConvolutionFilterModel::onParametersEdited);
+    connect(_presetBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ConvolutionFilterModel::presetChanged);
 
-    // Default: identity kernel
-    cv::Mat_<float> identity(size, size, 0.0f);
-    identity(size / 2, size / 2) = 1.0f;
-    return identity;
+    return _widget;
 }
 
+void ConvolutionFilterModel::setParameters(ConvolutionKernel::Parameters const &parameters)
+{
+    _kernel = std::make_shared<ConvolutionKernel const>(parameters);
+
+    if (_widget) {
+        QSignalBlocker const presetBlocker(_presetBox);
+        _presetBox->setCurrentText(parameters.preset);
+        _kernelSizeBox->setValue(_kernel->parameters().kernelSize);
+        _coefficientsEdit->setText(coefficientsText(parameters.coefficients));
+        _coefficientsEdit->setEnabled(parameters.preset == "Custom");
+    }
+
+    applyFilter();
+}
 
 void ConvolutionFilterModel::applyFilter()
 {
-    if (_inputPixmap.isNull()) return;
+    if (!_input) return;
+
+    // The kernel size or the input resolution changed the area needed upstream.
+    QSizeF const footprint = this->footprint();
+    if (footprint != _footprint) {
+        _footprint = footprint;
+        Q_EMIT inRequestsChanged();
+    }
+
+    std::shared_ptr<ConvolutionKernel const> const kernel = effectiveKernel();
+    ImageKernel::Inputs const inputs{_input};
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
+
+    runComputation([this, kernel, inputs, request]() {
+        std::shared_ptr<ImageData> const output
+            = kernel->compute(inputs, request, []() { return computationCancelled(); });
 
-    QString preset = _presetBox->currentText();
-    int kernelSize = _kernelSizeBox->value();
+        return [this, output]() {
+            _output = output;
 
-    cv::Mat kernel = getPresetKernel(preset, kernelSize);
-    cv::Mat result = applyConvolution(_inputPixmap, kernel);
+            if (_previewLabel && _output)
+                _previewLabel->setPixmap(_output->toPixmap(QSize(200, 200)));
 
-    QImage outputImg(result.data, result.cols, result.rows, result.step, QImage::Format_RGB888);
-    _filteredPixmap = QPixmap::fromImage(outputImg.rgbSwapped());
+            Q_EMIT dataUpdated(0);
+        };
+    });
+}
 
-    _previewLabel->setPixmap(_filteredPixmap.scaled(200, 200, Qt::KeepAspectRatio));
+void ConvolutionFilterModel::onParametersEdited()
+{
+    ConvolutionKernel::Parameters parameters;
+    parameters.preset = _presetBox->currentText();
+    parameters.kernelSize = _kernelSizeBox->value();
+
+    QString const text = _coefficientsEdit->text().replace(',', ' ').replace(';', ' ').simplified();
+    QStringList const numbers = text.isEmpty() ? QStringList() : text.split(' ');
+    for (QString const &number : numbers) {
+        parameters.coefficients.push_back(number.toFloat());
+    }
 
-    Q_EMIT dataUpdated(0);
+    // A full square of custom coefficients sets the size.
+    int const size = static_cast<int>(std::lround(std::sqrt(static_cast<double>(numbers.size()))));
+    if (parameters.preset == "Custom" && size % 2 == 1 && size * size == numbers.size())
+        parameters.kernelSize = size;
+
+    setParameters(parameters);
 }
 
 void ConvolutionFilterModel::presetChanged(int)
 {
-    applyFilter();
+    onParametersEdited();
 }
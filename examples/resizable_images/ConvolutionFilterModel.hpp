@@ -3,6 +3,7 @@
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QComboBox>
+#include <QtWidgets/QLineEdit>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QSpinBox>
 #include <QtWidgets/QGridLayout>
@@ -12,7 +13,8 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/core.hpp>
 
-#include "PixmapData.hpp"
+#include "ConvolutionKernel.hpp"
+#include "ImageData.hpp"
 
 class ConvolutionFilterModel : public QtNodes::NodeDelegateModel
 {
@@ -27,29 +29,60 @@ public:
     QString name() const override { return "ConvolutionFilterModel"; }
     QString modelName() const{ return "Convolution Filter"; }
 
+    QJsonObject save() const override;
+    void load(QJsonObject const &modelJson) override;
+
     unsigned int nPorts(QtNodes::PortType portType) const override;
     QtNodes::NodeDataType dataType(QtNodes::PortType, QtNodes::PortIndex) const override;
     std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex) override;
+
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) override;
+
     void setInData(std::shared_ptr<QtNodes::NodeData>, QtNodes::PortIndex) override;
-    QWidget *embeddedWidget() override { return _widget; }
-    cv::Mat getKernelFromPreset(const QString &preset, int size);
+
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(QtNodes::PortIndex) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       QtNodes::PortIndex) override;
+    QWidget *embeddedWidget() override;
+
+    std::shared_ptr<ConvolutionKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and recomputes the output.
+    void setParameters(ConvolutionKernel::Parameters const &parameters);
 
 private Q_SLOTS:
     void applyFilter();
     void presetChanged(int index);
 
+    /// Takes the parameters from the widgets.
+    void onParametersEdited();
+
 private:
-    QLabel *_previewLabel;
-    QComboBox *_presetBox;
-    QPushButton *_applyButton;
-    QSpinBox *_kernelSizeBox;
-    QWidget *_widget;
+    // Created by `embeddedWidget`, headless graphs have none.
+    QLabel *_previewLabel = nullptr;
+    QComboBox *_presetBox = nullptr;
+    QPushButton *_applyButton = nullptr;
+    QSpinBox *_kernelSizeBox = nullptr;
+    QLineEdit *_coefficientsEdit = nullptr;
+    QWidget *_widget = nullptr;
+
+    std::shared_ptr<ImageData> _input;
+    std::shared_ptr<ImageData> _output;
+
+    std::shared_ptr<ImageRequest const> _outRequest;
+
+    std::shared_ptr<ConvolutionKernel const> _kernel;
 
-    QPixmap _inputPixmap;
-    QPixmap _filteredPixmap;
+    QSizeF _footprint;
 
-    std::shared_ptr<QtNodes::NodeData> _nodeData;
+    /// The kernel radius in normalized frame coordinates.
+    QSizeF footprint() const;
 
-    cv::Mat applyConvolution(const QPixmap &pixmap, const cv::Mat &kernel);
-    cv::Mat getPresetKernel(const QString &preset, int size);
+    /// The kernel run on the input, scaled down for the proxy images.
+    std::shared_ptr<ConvolutionKernel const> effectiveKernel() const;
 };
@@ -0,0 +1,101 @@
+#include "ConvolutionKernel.hpp"
+
+#include "Convolution.hpp"
+#include "PresetConvolution.hpp"
+
+#include <QtCore/QJsonArray>
+
+#include <algorithm>
+
+ConvolutionKernel::ConvolutionKernel(Parameters const &parameters)
+    : _parameters(parameters)
+{
+    _parameters.kernelSize = std::max(1, _parameters.kernelSize | 1);
+}
+
+std::shared_ptr<ConvolutionKernel const> ConvolutionKernel::scaled(double factor) const
+{
+    Parameters parameters = _parameters;
+
+    if (_parameters.preset != "Custom") {
+        parameters.kernelSize = std::min(_parameters.kernelSize,
+                                         std::max(3, qRound(_parameters.kernelSize * factor) | 1));
+    }
+
+    return std::make_shared<ConvolutionKernel const>(parameters);
+}
+
+ConvolutionKernel::Parameters ConvolutionKernel::load(QJsonObject const &json, Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.preset = json["preset"].toString(defaults.preset);
+    parameters.kernelSize = json["kernel-size"].toInt(defaults.kernelSize);
+
+    if (json.contains("coefficients")) {
+        for (QJsonValue const value : json["coefficients"].toArray()) {
+            parameters.coefficients.push_back(static_cast<float>(value.toDouble()));
+        }
+    } else {
+        parameters.coefficients = defaults.coefficients;
+    }
+
+    return parameters;
+}
+
+cv::Mat ConvolutionKernel::matrix() const
+{
+    int const size = _parameters.kernelSize;
+
+    if (_parameters.preset != "Custom")
+        return PresetConvolution::matrix(_parameters.preset, size);
+
+    if (_parameters.coefficients.size() != static_cast<std::size_t>(size) * size)
+        return PresetConvolution::matrix(QString(), size);
+
+    return cv::Mat(size, size, CV_32F, const_cast<float *>(_parameters.coefficients.data())).clone();
+}
+
+std::shared_ptr<ImageData> ConvolutionKernel::compute(Inputs const &inputs,
+                                                      std::shared_ptr<ImageRequest const> const &request,
+                                                      CancelCheck const &cancelled) const
+{
+    if (inputs.empty() || !inputs[0] || inputs[0]->isNull())
+        return nullptr;
+
+    std::shared_ptr<ImageBuffer const> const input = inputs[0]->buffer();
+    cv::Rect const area = inputs[0]->area(request);
+
+    // Kernels not summing up to one would wipe out an alpha channel.
+    auto const source = input->channels() == 4 ? input->converted(ImageBuffer::Format::BGR888)
+                                               : input;
+
+    cv::Mat const &pixels = source->mat();
+
+    // The presets of the integer routines skip the conversion to float.
+    bool const compiled = _parameters.preset != "Custom"
+                          && PresetConvolution::supports(_parameters.preset, _parameters.kernelSize,
+                                                         pixels.type());
+
+    cv::Mat const result = compiled ? PresetConvolution::convolve(pixels, area, _parameters.preset,
+                                                                  _parameters.kernelSize, cancelled)
+                                    : Convolution::convolve(pixels, area, matrix(), cancelled);
+    if (result.empty())
+        return nullptr;
+
+    return std::make_shared<ImageData>(ImageBuffer::fromMat(result, source->format()),
+                                       inputs[0]->regionOf(area));
+}
+
+void ConvolutionKernel::save(QJsonObject &json) const
+{
+    json["preset"] = _parameters.preset;
+    json["kernel-size"] = _parameters.kernelSize;
+
+    if (!_parameters.coefficients.empty()) {
+        QJsonArray coefficients;
+        for (float const coefficient : _parameters.coefficients) {
+            coefficients.append(static_cast<double>(coefficient));
+        }
+        json["coefficients"] = coefficients;
+    }
+}
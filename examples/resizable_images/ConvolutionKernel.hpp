@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ImageKernel.hpp"
+
+#include <QtCore/QString>
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+/// Convolves an image with a preset or custom kernel of any odd size.
+/**
+ * The 3x3 and 5x5 presets run the integer routines of PresetConvolution,
+ * for the other kernels a strategy is picked, @see Convolution.
+ */
+class ConvolutionKernel : public ImageKernel
+{
+public:
+    struct Parameters
+    {
+        /// "Sharpen", "Emboss", "Edge Enhance", "Box Blur" or "Custom".
+        QString preset = "Sharpen";
+
+        /// Edge length of the kernel, made odd.
+        int kernelSize = 3;
+
+        /// The row-major coefficients of the "Custom" preset, `kernelSize` squared of them.
+        std::vector<float> coefficients;
+    };
+
+    explicit ConvolutionKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /**
+   * The kernel for the images downscaled by `factor`. The presets shrink
+   * down to 3x3, custom coefficients are given per pixel and kept.
+   */
+    std::shared_ptr<ConvolutionKernel const> scaled(double factor) const;
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+    /// The coefficients applied, an identity for custom ones of the wrong count.
+    cv::Mat matrix() const;
+
+public:
+    std::shared_ptr<ImageData> compute(Inputs const &inputs,
+                                       std::shared_ptr<ImageRequest const> const &request,
+                                       CancelCheck const &cancelled) const override;
+
+    int halo() const override { return _parameters.kernelSize / 2; }
+
+
+    void save(QJsonObject &json) const override;
+
+private:
+    Parameters _parameters;
+};
@@ -0,0 +1,95 @@
+#include "EdgeDetectionKernel.hpp"
+
+#include "TileEngine.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+
+EdgeDetectionKernel::EdgeDetectionKernel(Parameters const &parameters)
+    : _parameters(parameters)
+{
+    _parameters.kernelSize |= 1;
+}
+
+std::shared_ptr<EdgeDetectionKernel const> EdgeDetectionKernel::scaled(double factor) const
+{
+    // Sobel and Canny take odd apertures, below 3 Sobel changes its operator.
+    Parameters parameters = _parameters;
+    parameters.kernelSize = std::min(_parameters.kernelSize,
+                                     std::max(3, qRound(_parameters.kernelSize * factor) | 1));
+    return std::make_shared<EdgeDetectionKernel const>(parameters);
+}
+
+EdgeDetectionKernel::Parameters EdgeDetectionKernel::load(QJsonObject const &json,
+                                                          Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.sobel = json["method"].toString(defaults.sobel ? "Sobel" : "Canny") == "Sobel";
+    parameters.threshold1 = json["threshold1"].toInt(defaults.threshold1);
+    parameters.threshold2 = json["threshold2"].toInt(defaults.threshold2);
+    parameters.kernelSize = json["kernel-size"].toInt(defaults.kernelSize);
+    parameters.overlay = json["overlay"].toBool(defaults.overlay);
+    return parameters;
+}
+
+std::shared_ptr<ImageData> EdgeDetectionKernel::compute(Inputs const &inputs,
+                                                        std::shared_ptr<ImageRequest const> const &request,
+                                                        CancelCheck const &cancelled) const
+{
+    if (inputs.empty() || !inputs[0] || inputs[0]->isNull())
+        return nullptr;
+
+    std::shared_ptr<ImageBuffer const> const image = inputs[0]->buffer();
+    cv::Rect const area = inputs[0]->area(request);
+
+    // Read-only view, the cached conversion is shared with the other nodes.
+    cv::Mat const gray = image->converted(ImageBuffer::Format::Gray8)->mat();
+    cv::Mat edges, output;
+
+    // The result of a superseded computation is dropped anyway.
+    if (cancelled && cancelled())
+        return nullptr;
+
+    int const ksize = _parameters.kernelSize;
+
+    if (_parameters.sobel) {
+        edges = TileEngine::process(gray, area, CV_8UC1, ksize / 2,
+            [ksize](cv::Mat const &source, cv::Rect const &tile, cv::Mat &destination) {
+                cv::Mat grad_x, grad_y;
+                cv::Sobel(source, grad_x, CV_16S, 1, 0, ksize);
+                cv::Sobel(source, grad_y, CV_16S, 0, 1, ksize);
+                cv::Mat abs_grad_x, abs_grad_y;
+                cv::convertScaleAbs(grad_x(tile), abs_grad_x);
+                cv::convertScaleAbs(grad_y(tile), abs_grad_y);
+                cv::addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, destination);
+            });
+    } else {
+        // The hysteresis of Canny follows edges across the input, it cannot be tiled.
+        cv::Mat allEdges;
+        cv::Canny(gray, allEdges, _parameters.threshold1, _parameters.threshold2, ksize);
+        edges = allEdges(area);
+    }
+
+    if (_parameters.overlay) {
+        cv::Mat const input = image->converted(ImageBuffer::Format::BGR888)->mat()(area);
+        cv::Mat colorEdges;
+        cv::cvtColor(edges, colorEdges, cv::COLOR_GRAY2BGR);
+        cv::addWeighted(input, 0.7, colorEdges, 0.3, 0, output);
+    } else {
+        cv::cvtColor(edges, output, cv::COLOR_GRAY2BGR);
+    }
+
+    return std::make_shared<ImageData>(ImageBuffer::fromMat(output, ImageBuffer::Format::BGR888),
+                                       inputs[0]->regionOf(area));
+}
+
+void EdgeDetectionKernel::save(QJsonObject &json) const
+{
+    json["method"] = _parameters.sobel ? "Sobel" : "Canny";
+    json["threshold1"] = _parameters.threshold1;
+    json["threshold2"] = _parameters.threshold2;
+    json["kernel-size"] = _parameters.kernelSize;
+    json["overlay"] = _parameters.overlay;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ImageKernel.hpp"
+
+/// Detects edges with the Sobel operator or the Canny detector.
+class EdgeDetectionKernel : public ImageKernel
+{
+public:
+    struct Parameters
+    {
+        /// Sobel gradients if set, Canny edges otherwise.
+        bool sobel = true;
+
+        /// Hysteresis thresholds of Canny.
+        int threshold1 = 50;
+        int threshold2 = 150;
+
+        /// Aperture of the operators, odd.
+        int kernelSize = 3;
+
+        /// Blends the edges over the input.
+        bool overlay = false;
+    };
+
+    explicit EdgeDetectionKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /// The kernel for the images downscaled by `factor`, the aperture shrinks down to 3.
+    std::shared_ptr<EdgeDetectionKernel const> scaled(double factor) const;
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+public:
+    std::shared_ptr<ImageData> compute(Inputs const &inputs,
+                                       std::shared_ptr<ImageRequest const> const &request,
+                                       CancelCheck const &cancelled) const override;
+
+    /// The kernel radius, Canny also compares every gradient with its neighbours.
+    int halo() const override { return _parameters.kernelSize / 2 + (_parameters.sobel ? 0 : 1); }
+
+
+    void save(QJsonObject &json) const override;
+
+private:
+    Parameters _parameters;
+};
@@ -1,15 +1,76 @@
 #include "EdgeDetectionModel.hpp"
-#include <opencv2/imgproc.hpp>
-#include <opencv2/imgcodecs.hpp>
-#include <opencv2/highgui.hpp>
-#include <opencv2/core.hpp>
 
-#include <QImage>
-#include <QPixmap>
+#include "ProxyPreview.hpp"
+
+#include <QtCore/QSignalBlocker>
 
 EdgeDetectionModel::EdgeDetectionModel()
-    : _previewLabel(new QLabel("Edge Detected Image")), _output(nullptr)
-{
+    : _kernel(std::make_shared<EdgeDetectionKernel const>())
+{}
+
+QJsonObject EdgeDetectionModel::save() const {
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
+
+void EdgeDetectionModel::load(QJsonObject const &modelJson) {
+    setParameters(EdgeDetectionKernel::load(modelJson, _kernel->parameters()));
+}
+
+unsigned int EdgeDetectionModel::nPorts(QtNodes::PortType portType) const {
+    return (portType == QtNodes::PortType::In || portType == QtNodes::PortType::Out) ? 1 : 0;
+}
+
+QtNodes::NodeDataType EdgeDetectionModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const {
+    return ImageData().type();
+}
+
+std::shared_ptr<QtNodes::NodeData> EdgeDetectionModel::outData(QtNodes::PortIndex) {
+    return _output;
+}
+
+QJsonObject EdgeDetectionModel::computationParameters() const {
+    QJsonObject parameters;
+    effectiveKernel()->save(parameters);
+    ImageRequest::save(_outRequest, parameters);
+    return parameters;
+}
+
+bool EdgeDetectionModel::restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) {
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d) return false;
+
+    _output = d;
+    updateDisplay();
+    return true;
+}
+
+void EdgeDetectionModel::setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex) {
+    auto d = std::dynamic_pointer_cast<ImageData>(nodeData);
+    if (d && !d->isNull()) {
+        _input = d;
+        if (_previewLabel)
+            _previewLabel->setToolTip(QString("Size: %1 x %2").arg(_input->width()).arg(_input->height()));
+        processImage();
+    }
+}
+
+std::shared_ptr<QtNodes::NodeDataRequest const> EdgeDetectionModel::inRequest(QtNodes::PortIndex) const {
+    return ImageRequest::grown(_outRequest, footprint());
+}
+
+bool EdgeDetectionModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                                       QtNodes::PortIndex) {
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
+}
+
+QWidget* EdgeDetectionModel::embeddedWidget() {
+    if (_widget)
+        return _widget;
+
+    _previewLabel = new QLabel("Edge Detected Image");
     _previewLabel->setAlignment(Qt::AlignCenter);
     _previewLabel->setMinimumSize(200, 200);
 
@@ -18,15 +79,12 @@ EdgeDetectionModel::EdgeDetectionModel()
 
     _threshold1Slider = new QSlider(Qt::Horizontal);
     _threshold1Slider->setRange(0, 255);
-    _threshold1Slider->setValue(50);
 
     _threshold2Slider = new QSlider(Qt::Horizontal);
     _threshold2Slider->setRange(0, 255);
-    _threshold2Slider->setValue(150);
 
     _kernelSizeSlider = new QSlider(Qt::Horizontal);
     _kernelSizeSlider->setRange(1, 7);
-    _kernelSizeSlider->setValue(3);
     _kernelSizeSlider->setSingleStep(2);
     _kernelSizeSlider->setPageStep(2);
 
@@ -47,74 +105,97 @@ EdgeDetectionModel::EdgeDetectionModel()
     _widget = new QWidget();
     _widget->setLayout(layout);
 
-    connect(_methodCombo, &QComboBox::currentTextChanged, this, &EdgeDetectionModel::processImage);
-    connect(_threshold1Slider, &QSlider::valueChanged, this, &EdgeDetectionModel::processImage);
-    connect(_threshold2Slider, &QSlider::valueChanged, this, &EdgeDetectionModel::processImage);
-    connect(_kernelSizeSlider, &QSlider::valueChanged, this, &EdgeDetectionModel::processImage);
-    connect(_overlayCheckBox, &QCheckBox::stateChanged, this, &EdgeDetectionModel::processImage);
+    // Shows the current snapshot before the edits are connected.
+    updateWidgets();
+    updateDisplay();
+
+    connect(_methodCombo, &QComboBox::currentTextChanged, this, &EdgeDetectionModel::onParametersEdited);
+    connect(_threshold1Slider, &QSlider::valueChanged, this, &EdgeDetectionModel::onParametersEdited);
+    connect(_threshold2Slider, &QSlider::valueChanged, this, &EdgeDetectionModel::onParametersEdited);
+    connect(_kernelSizeSlider, &QSlider::valueChanged, this, &EdgeDetectionModel::onParametersEdited);
+    connect(_overlayCheckBox, &QCheckBox::stateChanged, this, &EdgeDetectionModel::onParametersEdited);
+
+    ProxyPreview::instance().trackSlider(_threshold1Slider);
+    ProxyPreview::instance().trackSlider(_threshold2Slider);
+    ProxyPreview::instance().trackSlider(_kernelSizeSlider);
+
+    return _widget;
 }
 
-unsigned int EdgeDetectionModel::nPorts(QtNodes::PortType portType) const {
-    return (portType == QtNodes::PortType::In || portType == QtNodes::PortType::Out) ? 1 : 0;
+void EdgeDetectionModel::setParameters(EdgeDetectionKernel::Parameters const &parameters) {
+    _kernel = std::make_shared<EdgeDetectionKernel const>(parameters);
+
+    updateWidgets();
+    processImage();
 }
 
-QtNodes::NodeDataType EdgeDetectionModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const {
-    return PixmapData().type();
+void EdgeDetectionModel::updateWidgets() {
+    if (!_widget) return;
+
+    EdgeDetectionKernel::Parameters const &parameters = _kernel->parameters();
+
+    QSignalBlocker const methodBlocker(_methodCombo);
+    QSignalBlocker const threshold1Blocker(_threshold1Slider);
+    QSignalBlocker const threshold2Blocker(_threshold2Slider);
+    QSignalBlocker const kernelSizeBlocker(_kernelSizeSlider);
+    QSignalBlocker const overlayBlocker(_overlayCheckBox);
+
+    _methodCombo->setCurrentText(parameters.sobel ? "Sobel" : "Canny");
+    _threshold1Slider->setValue(parameters.threshold1);
+    _threshold2Slider->setValue(parameters.threshold2);
+    _kernelSizeSlider->setValue(parameters.kernelSize);
+    _overlayCheckBox->setChecked(parameters.overlay);
 }
 
-std::shared_ptr<QtNodes::NodeData> EdgeDetectionModel::outData(QtNodes::PortIndex) {
-    return _output;
+void EdgeDetectionModel::onParametersEdited() {
+    EdgeDetectionKernel::Parameters params;
+    params.sobel = _methodCombo->currentText() == "Sobel";
+    params.threshold1 = _threshold1Slider->value();
+    params.threshold2 = _threshold2Slider->value();
+    params.kernelSize = _kernelSizeSlider->value() | 1;
+    params.overlay = _overlayCheckBox->isChecked();
+    setParameters(params);
 }
 
-void EdgeDetectionModel::setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex) {
-    auto d = std::dynamic_pointer_cast<PixmapData>(nodeData);
-    if (d) {
-        _originalPixmap = d->pixmap();
-        _previewLabel->setToolTip(QString("Size: %1 x %2").arg(_originalPixmap.width()).arg(_originalPixmap.height()));
-        processImage();
-    }
+QSizeF EdgeDetectionModel::footprint() const {
+    if (!_input) return QSizeF();
+
+    return _input->pixelSize() * effectiveKernel()->halo();
+}
+
+std::shared_ptr<EdgeDetectionKernel const> EdgeDetectionModel::effectiveKernel() const {
+    // The aperture is given in pixels of the full resolution.
+    double const factor = ProxyPreview::instance().currentFactor();
+    return factor < 1.0 ? _kernel->scaled(factor) : _kernel;
 }
 
 void EdgeDetectionModel::processImage() {
-    if (_originalPixmap.isNull()) return;
-
-    QImage qImage = _originalPixmap.toImage().convertToFormat(QImage::Format_RGB888);
-    cv::Mat input(qImage.height(), qImage.width(), CV_8UC3, const_cast<uchar*>(qImage.bits()), qImage.bytesPerLine());
-    cv::Mat gray, edges;
-
-    cv::cvtColor(input, gray, cv::COLOR_RGB2GRAY);
-
-    int ksize = _kernelSizeSlider->value() | 1;
-    QString method = _methodCombo->currentText();
-
-    if (method == "Sobel") {
-        cv::Mat grad_x, grad_y;
-        cv::Sobel(gray, grad_x, CV_16S, 1, 0, ksize);
-        cv::Sobel(gray, grad_y, CV_16S, 0, 1, ksize);
-        cv::Mat abs_grad_x, abs_grad_y;
-        cv::convertScaleAbs(grad_x, abs_grad_x);
-        cv::convertScaleAbs(grad_y, abs_grad_y);
-        cv::addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, edges);
-    } else {
-        cv::Canny(gray, edges, _threshold1Slider->value(), _threshold2Slider->value(), ksize);
-    }
+    if (!_input) return;
 
-    if (_overlayCheckBox->isChecked()) {
-        cv::Mat colorEdges;
-        cv::cvtColor(edges, colorEdges, cv::COLOR_GRAY2BGR);
-        cv::addWeighted(input, 0.7, colorEdges, 0.3, 0, input);
-    } else {
-        cv::cvtColor(edges, input, cv::COLOR_GRAY2BGR);
+    // The kernel size or the input resolution changed the area needed upstream.
+    QSizeF const footprint = this->footprint();
+    if (footprint != _footprint) {
+        _footprint = footprint;
+        Q_EMIT inRequestsChanged();
     }
 
-    QImage result(input.data, input.cols, input.rows, static_cast<int>(input.step), QImage::Format_RGB888);
-    QPixmap resultPixmap = QPixmap::fromImage(result.rgbSwapped());
+    std::shared_ptr<EdgeDetectionKernel const> const kernel = effectiveKernel();
+    ImageKernel::Inputs const inputs{_input};
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
+
+    runComputation([this, kernel, inputs, request]() {
+        std::shared_ptr<ImageData> const result
+            = kernel->compute(inputs, request, []() { return computationCancelled(); });
 
-    _output = std::make_shared<PixmapData>(resultPixmap);
-    updateDisplay(resultPixmap);
-    Q_EMIT dataUpdated(0);
+        return [this, result]() {
+            _output = result;
+            updateDisplay();
+            Q_EMIT dataUpdated(0);
+        };
+    });
 }
 
-void EdgeDetectionModel::updateDisplay(const QPixmap& pixmap) {
-    _previewLabel->setPixmap(pixmap.scaled(_previewLabel->size(), Qt::KeepAspectRatio));
+void EdgeDetectionModel::updateDisplay() {
+    if (_previewLabel && _output)
+        _previewLabel->setPixmap(_output->toPixmap(_previewLabel->size()));
 }
@@ -8,7 +8,8 @@
 #include <QtWidgets/QWidget>
 
 #include <QtNodes/NodeDelegateModel>
-#include "PixmapData.hpp"
+#include "EdgeDetectionKernel.hpp"
+#include "ImageData.hpp"
 
 class EdgeDetectionModel : public QtNodes::NodeDelegateModel {
     Q_OBJECT
@@ -21,28 +22,68 @@ public:
     QString name() const override { return QString("EdgeDetectionModel"); }
     QString modelName() const { return QString("Edge Detection"); }
 
+    QJsonObject save() const override;
+    void load(QJsonObject const& modelJson) override;
+
     unsigned int nPorts(QtNodes::PortType portType) const override;
     QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override;
 
     std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex port) override;
+
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) override;
+
     void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex port) override;
 
-    QWidget* embeddedWidget() override { return _widget; }
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(QtNodes::PortIndex port) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       QtNodes::PortIndex port) override;
+
+    QWidget* embeddedWidget() override;
     bool resizable() const override { return true; }
 
+    std::shared_ptr<EdgeDetectionKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and recomputes the output.
+    void setParameters(EdgeDetectionKernel::Parameters const& parameters);
+
+private Q_SLOTS:
+    /// Takes the parameters from the widgets.
+    void onParametersEdited();
+
 private:
+    /// The input around a pixel its edges depend on, in normalized frame coordinates.
+    QSizeF footprint() const;
+
     void processImage();
-    void updateDisplay(const QPixmap& pixmap);
+
+    /// The kernel run on the input, scaled down for the proxy images.
+    std::shared_ptr<EdgeDetectionKernel const> effectiveKernel() const;
+    void updateDisplay();
+
+    /// Shows the parameters of the kernel in the widgets.
+    void updateWidgets();
 
 private:
-    QLabel* _previewLabel;
-    QWidget* _widget;
-    QComboBox* _methodCombo;
-    QSlider* _threshold1Slider;
-    QSlider* _threshold2Slider;
-    QSlider* _kernelSizeSlider;
-    QCheckBox* _overlayCheckBox;
-
-    QPixmap _originalPixmap;
-    std::shared_ptr<QtNodes::NodeData> _output;
+    // Created by `embeddedWidget`, headless graphs have none.
+    QLabel* _previewLabel = nullptr;
+    QWidget* _widget = nullptr;
+    QComboBox* _methodCombo = nullptr;
+    QSlider* _threshold1Slider = nullptr;
+    QSlider* _threshold2Slider = nullptr;
+    QSlider* _kernelSizeSlider = nullptr;
+    QCheckBox* _overlayCheckBox = nullptr;
+
+    std::shared_ptr<ImageData> _input;
+    std::shared_ptr<ImageData> _output;
+
+    std::shared_ptr<ImageRequest const> _outRequest;
+
+    std::shared_ptr<EdgeDetectionKernel const> _kernel;
+
+    QSizeF _footprint;
 };
@@ -0,0 +1,236 @@
+#include "GaussianBlur.hpp"
+
+#include "TileEngine.hpp"
+
+#include <QtNodes/TaskScheduler>
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using QtNodes::TaskScheduler;
+
+namespace {
+
+/// Rows or columns per task of the recursive passes.
+int const bandSize = 32;
+
+/**
+ * The third-order filter of Young and van Vliet, "Recursive implementation
+ * of the Gaussian filter", 1995. Their fit of the coefficients to sigma
+ * widens the tails with growing sigma and the response stops growing
+ * beyond ~100, so the poles are taken from their filter for sigma 20 and
+ * scaled to the sigma instead (van Vliet, Young and Verbeek, 1998). The
+ * response then stays within 1.5% of the Gaussian peak for any sigma
+ * from 8 on.
+ */
+struct Recursion
+{
+    explicit Recursion(double sigma)
+    {
+        // The poles as z = d^(-1 / q), d at scale q = 1.
+        double const q = 0.938945 * sigma;
+        double const p1 = std::pow(3.107291039, -1.0 / q);
+        std::complex<double> const p2 = std::pow(std::complex<double>(0.741992765, 2.981007345), -1.0 / q);
+        std::complex<double> const p3 = std::conj(p2);
+
+        b1 = std::real(p1 + p2 + p3);
+        b2 = -std::real(p1 * p2 + p1 * p3 + p2 * p3);
+        b3 = std::real(p1 * p2 * p3);
+        B = 1.0 - (b1 + b2 + b3);
+    }
+
+    /// Filters `count` contiguous samples in place, forwards and then backwards.
+    void run(double *data, int count) const
+    {
+        // The edges continue with their value, for which the filter is at rest.
+        double w1 = data[0], w2 = w1, w3 = w1;
+        for (int i = 0; i < count; ++i) {
+            double const w = B * data[i] + b1 * w1 + b2 * w2 + b3 * w3;
+            data[i] = w;
+            w3 = w2;
+            w2 = w1;
+            w1 = w;
+        }
+
+        double y1 = data[count - 1], y2 = y1, y3 = y1;
+        for (int i = count - 1; i >= 0; --i) {
+            double const y = B * data[i] + b1 * y1 + b2 * y2 + b3 * y3;
+            data[i] = y;
+            y3 = y2;
+            y2 = y1;
+            y1 = y;
+        }
+    }
+
+    /**
+   * Filters `width` columns of `rows` contiguous rows in place. The inner
+   * loops run over the columns of a row and vectorize.
+   */
+    void runColumns(double *data, int rows, int width) const
+    {
+        std::vector<double> state(3 * static_cast<std::size_t>(width));
+        double *s1 = state.data();
+        double *s2 = s1 + width;
+        double *s3 = s2 + width;
+
+        auto pass = [&](int first, int last, int step) {
+            double const *edge = data + static_cast<std::size_t>(first) * width;
+            std::copy(edge, edge + width, s1);
+            std::copy(edge, edge + width, s2);
+            std::copy(edge, edge + width, s3);
+
+            for (int y = first; y != last; y += step) {
+                double *row = data + static_cast<std::size_t>(y) * width;
+                for (int x = 0; x < width; ++x) {
+                    double const v = B * row[x] + b1 * s1[x] + b2 * s2[x] + b3 * s3[x];
+                    row[x] = v;
+                    s3[x] = s2[x];
+                    s2[x] = s1[x];
+                    s1[x] = v;
+                }
+            }
+        };
+
+        pass(0, rows, 1);
+        pass(rows - 1, -1, -1);
+    }
+
+    // The poles of large sigmas lie close to 1 and amplify rounding errors,
+    // the lines are filtered in doubles.
+    double B;
+    double b1;
+    double b2;
+    double b3;
+};
+
+} // namespace
+
+int GaussianBlur::halo(double sigma)
+{
+    return sigma > 0.0 ? static_cast<int>(std::ceil(3.0 * sigma)) : 0;
+}
+
+double GaussianBlur::recursiveSigma()
+{
+    return 8.0;
+}
+
+cv::Mat GaussianBlur::blur(cv::Mat const &input,
+                           cv::Rect const &area,
+                           double sigma,
+                           CancelCheck const &cancelled)
+{
+    if (cancelled && cancelled())
+        return cv::Mat();
+
+    if (sigma <= 0.0)
+        return input(area).clone();
+
+    if (sigma < recursiveSigma())
+        return blurSeparable(input, area, sigma);
+
+    return blurRecursive(input, area, sigma, cancelled);
+}
+
+cv::Mat GaussianBlur::blurSeparable(cv::Mat const &input, cv::Rect const &area, double sigma)
+{
+    int const h = halo(sigma);
+
+    return TileEngine::process(input, area, input.type(), h,
+        [h, sigma](cv::Mat const &source, cv::Rect const &tile, cv::Mat &destination) {
+            // The filter reads the halo from around the view, the border is
+            // only reflected at the edges of the input.
+            cv::GaussianBlur(source(tile), destination, cv::Size(2 * h + 1, 2 * h + 1), sigma, sigma,
+                             cv::BORDER_REFLECT_101);
+        });
+}
+
+cv::Mat GaussianBlur::blurRecursive(cv::Mat const &input,
+                                    cv::Rect const &area,
+                                    double sigma,
+                                    CancelCheck const &cancelled)
+{
+    int const h = halo(sigma);
+    cv::Rect const frame(0, 0, input.cols, input.rows);
+    cv::Rect const region = cv::Rect(area.x - h, area.y - h, area.width + 2 * h, area.height + 2 * h)
+                            & frame;
+
+    // The halo missing at the edges of the input is reflected like in the separable filter.
+    cv::Mat padded;
+    cv::copyMakeBorder(input(region), padded,
+                       region.y - (area.y - h), (area.y + area.height + h) - region.br().y,
+                       region.x - (area.x - h), (area.x + area.width + h) - region.br().x,
+                       cv::BORDER_REFLECT_101);
+
+    cv::Mat image;
+    padded.convertTo(image, CV_32F);
+
+    Recursion const recursion(sigma);
+    int const channels = image.channels();
+    TaskScheduler &scheduler = TaskScheduler::globalInstance();
+
+    auto bands = [](int count) { return static_cast<std::size_t>((count + bandSize - 1) / bandSize); };
+
+    scheduler.parallelFor(bands(image.rows), [&](std::size_t band) {
+        if (cancelled && cancelled())
+            return;
+
+        std::vector<double> line(static_cast<std::size_t>(image.cols));
+
+        int const end = std::min(image.rows, static_cast<int>(band + 1) * bandSize);
+        for (int y = static_cast<int>(band) * bandSize; y < end; ++y) {
+            float *row = image.ptr<float>(y);
+
+            for (int c = 0; c < channels; ++c) {
+                for (int x = 0; x < image.cols; ++x) {
+                    line[x] = row[x * channels + c];
+                }
+
+                recursion.run(line.data(), image.cols);
+
+                for (int x = 0; x < image.cols; ++x) {
+                    row[x * channels + c] = static_cast<float>(line[x]);
+                }
+            }
+        }
+    });
+
+    if (cancelled && cancelled())
+        return cv::Mat();
+
+    // Bands of interleaved samples, which are independent columns as well.
+    int const samples = image.cols * channels;
+    scheduler.parallelFor(bands(samples), [&](std::size_t band) {
+        if (cancelled && cancelled())
+            return;
+
+        int const begin = static_cast<int>(band) * bandSize;
+        int const width = std::min(samples, begin + bandSize) - begin;
+        std::vector<double> columns(static_cast<std::size_t>(image.rows) * width);
+
+        for (int y = 0; y < image.rows; ++y) {
+            float const *row = image.ptr<float>(y) + begin;
+            std::copy(row, row + width, columns.begin() + static_cast<std::ptrdiff_t>(y) * width);
+        }
+
+        recursion.runColumns(columns.data(), image.rows, width);
+
+        for (int y = 0; y < image.rows; ++y) {
+            float *row = image.ptr<float>(y) + begin;
+            for (int x = 0; x < width; ++x) {
+                row[x] = static_cast<float>(columns[static_cast<std::size_t>(y) * width + x]);
+            }
+        }
+    });
+
+    if (cancelled && cancelled())
+        return cv::Mat();
+
+    cv::Mat output;
+    image(cv::Rect(h, h, area.width, area.height)).convertTo(output, input.type());
+    return output;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <functional>
+
+/// Gaussian blur of 8-bit images of any channel count and any sigma.
+/**
+ * Small sigmas use OpenCV's separable filter on the tiles of the
+ * TileEngine. From `recursiveSigma()` on, the filter would be too long and
+ * the recursive approximation of Young and van Vliet takes over: a
+ * third-order IIR filter run forwards and backwards along the rows and
+ * then the columns, whose cost per pixel does not depend on sigma. The
+ * rows, then the columns, are spread over the worker pool in bands.
+ */
+class GaussianBlur
+{
+public:
+    using CancelCheck = std::function<bool()>;
+
+    /// Pixels around an output pixel that take part in its value, 3 sigma.
+    static int halo(double sigma);
+
+    /// Sigmas from which the recursive filter is used.
+    static double recursiveSigma();
+
+    /**
+   * @returns the pixels `area` of `input` blurred with `sigma`, empty if
+   * the computation was cancelled. The pixels around the area are read
+   * up to the halo, the border of the input is reflected.
+   */
+    static cv::Mat blur(cv::Mat const &input,
+                        cv::Rect const &area,
+                        double sigma,
+                        CancelCheck const &cancelled = CancelCheck());
+
+    /// The separable filter, whatever the sigma.
+    static cv::Mat blurSeparable(cv::Mat const &input, cv::Rect const &area, double sigma);
+
+    /// The recursive filter, whatever the sigma, which must be at least 0.5.
+    static cv::Mat blurRecursive(cv::Mat const &input,
+                                 cv::Rect const &area,
+                                 double sigma,
+                                 CancelCheck const &cancelled = CancelCheck());
+};
@@ -0,0 +1,53 @@
+#include "GaussianBlurKernel.hpp"
+
+#include "GaussianBlur.hpp"
+
+#include <algorithm>
+
+GaussianBlurKernel::GaussianBlurKernel(Parameters const &parameters)
+    : _parameters(parameters)
+{}
+
+std::shared_ptr<GaussianBlurKernel const> GaussianBlurKernel::scaled(double factor) const
+{
+    Parameters parameters = _parameters;
+    parameters.radius = std::max(1, qRound(_parameters.radius * factor));
+    return std::make_shared<GaussianBlurKernel const>(parameters);
+}
+
+GaussianBlurKernel::Parameters GaussianBlurKernel::load(QJsonObject const &json,
+                                                        Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.radius = json["radius"].toInt(defaults.radius);
+    return parameters;
+}
+
+std::shared_ptr<ImageData> GaussianBlurKernel::compute(Inputs const &inputs,
+                                                       std::shared_ptr<ImageRequest const> const &request,
+                                                       CancelCheck const &cancelled) const
+{
+    if (inputs.empty() || !inputs[0] || inputs[0]->isNull())
+        return nullptr;
+
+    std::shared_ptr<ImageBuffer const> const input = inputs[0]->buffer();
+    cv::Rect const area = inputs[0]->area(request);
+
+    // Every channel is blurred alike, the pixels keep their format.
+    cv::Mat const blurred = GaussianBlur::blur(input->mat(), area, sigma(), cancelled);
+    if (blurred.empty())
+        return nullptr;
+
+    return std::make_shared<ImageData>(ImageBuffer::fromMat(blurred, input->format()),
+                                       inputs[0]->regionOf(area));
+}
+
+int GaussianBlurKernel::halo() const
+{
+    return GaussianBlur::halo(sigma());
+}
+
+void GaussianBlurKernel::save(QJsonObject &json) const
+{
+    json["radius"] = _parameters.radius;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ImageKernel.hpp"
+
+/// Blurs an image with a Gaussian, @see GaussianBlur.
+class GaussianBlurKernel : public ImageKernel
+{
+public:
+    struct Parameters
+    {
+        /// Radius of the blur in pixels, three times its sigma.
+        int radius = 5;
+    };
+
+    explicit GaussianBlurKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /// The kernel for the images downscaled by `factor`, the radius shrinks along.
+    std::shared_ptr<GaussianBlurKernel const> scaled(double factor) const;
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+public:
+    std::shared_ptr<ImageData> compute(Inputs const &inputs,
+                                       std::shared_ptr<ImageRequest const> const &request,
+                                       CancelCheck const &cancelled) const override;
+
+    int halo() const override;
+
+    double sigma() const { return _parameters.radius / 3.0; }
+
+
+    void save(QJsonObject &json) const override;
+
+private:
+    Parameters _parameters;
+};
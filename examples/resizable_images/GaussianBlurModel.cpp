@@ -1,39 +1,24 @@
 #include "GaussianBlurModel.hpp"
 
-#include <QtGui/QImage>
-#include <QtGui/QPainter>
+#include "ProxyPreview.hpp"
+
 #include <QtCore/QEvent>
-#include <QtCore/QTimer>
-#include <QtWidgets/QHBoxLayout>
-#include <QtWidgets/QFormLayout>
-#include <QtWidgets/QToolTip>
+#include <QtCore/QSignalBlocker>
 
 GaussianBlurModel::GaussianBlurModel()
-    : _label(new QLabel("Blurred Image will appear here")),
-      _slider(new QSlider(Qt::Horizontal)),
-      _widget(new QWidget),
-      _layout(new QVBoxLayout(_widget))
-{
-    _label->setAlignment(Qt::AlignCenter);
-    _label->setMinimumSize(200, 200);
-    _label->installEventFilter(this);
-
-    _slider->setMinimum(5);
-    _slider->setMaximum(20);
-    _slider->setValue(_blurRadius);
-    _slider->setTickPosition(QSlider::TicksBelow);
-    _slider->setToolTip("Adjust blur radius");
+    : _kernel(std::make_shared<GaussianBlurKernel const>())
+{}
 
-    connect(_slider, &QSlider::valueChanged, this, [this](int value) {
-        _blurRadius = value;
-        if (!_originalPixmap.isNull()) {
-            applyGaussianBlur(_originalPixmap);
-        }
-    });
+QJsonObject GaussianBlurModel::save() const
+{
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
 
-    _layout->addWidget(_label);
-    _layout->addWidget(_slider);
-    _widget->setLayout(_layout);
+void GaussianBlurModel::load(QJsonObject const &modelJson)
+{
+    setParameters(GaussianBlurKernel::load(modelJson, _kernel->parameters()));
 }
 
 unsigned int GaussianBlurModel::nPorts(PortType portType) const
@@ -44,8 +29,8 @@ unsigned int GaussianBlurModel::nPorts(PortType portType) const
 bool GaussianBlurModel::eventFilter(QObject *object, QEvent *event)
 {
     if (object == _label && event->type() == QEvent::Resize) {
-        if (!_blurredPixmap.isNull()) {
-            _label->setPixmap(_blurredPixmap.scaled(_label->size(), Qt::KeepAspectRatio));
+        if (_output) {
+            _label->setPixmap(_output->toPixmap(_label->size()));
         }
     }
     return false;
@@ -53,55 +38,147 @@ bool GaussianBlurModel::eventFilter(QObject *object, QEvent *event)
 
 NodeDataType GaussianBlurModel::dataType(PortType const, PortIndex const) const
 {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<NodeData> GaussianBlurModel::outData(PortIndex)
 {
-    return std::make_shared<PixmapData>(_blurredPixmap);
+    return _output;
+}
+
+QJsonObject GaussianBlurModel::computationParameters() const
+{
+    QJsonObject parameters;
+    effectiveKernel()->save(parameters);
+    ImageRequest::save(_outRequest, parameters);
+    return parameters;
+}
+
+bool GaussianBlurModel::restoreOutData(std::vector<std::shared_ptr<NodeData>> const &outputs)
+{
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d)
+        return false;
+
+    _output = d;
+    if (_label)
+        _label->setPixmap(_output->toPixmap(_label->size()));
+    return true;
 }
 
 void GaussianBlurModel::setInData(std::shared_ptr<NodeData> nodeData, PortIndex const)
 {
-    if (auto d = std::dynamic_pointer_cast<PixmapData>(nodeData)) {
-        _originalPixmap = d->pixmap();
-        applyGaussianBlur(_originalPixmap);
+    auto d = std::dynamic_pointer_cast<ImageData>(nodeData);
+    if (d && !d->isNull()) {
+        _input = d;
+        applyGaussianBlur();
     }
 }
 
-void GaussianBlurModel::applyGaussianBlur(const QPixmap &input)
+std::shared_ptr<QtNodes::NodeDataRequest const> GaussianBlurModel::inRequest(PortIndex) const
 {
-    if (input.isNull()) return;
+    return ImageRequest::grown(_outRequest, footprint());
+}
 
-    QImage inputImage = input.toImage().convertToFormat(QImage::Format_ARGB32);
-    QImage blurredImage(inputImage.size(), QImage::Format_ARGB32);
-    blurredImage.fill(Qt::transparent);
+bool GaussianBlurModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request, PortIndex)
+{
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
+}
+
+QWidget *GaussianBlurModel::embeddedWidget()
+{
+    if (_widget)
+        return _widget;
+
+    _label = new QLabel("Blurred Image will appear here");
+    _slider = new QSlider(Qt::Horizontal);
+    _widget = new QWidget;
+    _layout = new QVBoxLayout(_widget);
 
-    QPainter painter(&blurredImage);
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.drawImage(0, 0, inputImage);
+    _label->setAlignment(Qt::AlignCenter);
+    _label->setMinimumSize(200, 200);
+    _label->installEventFilter(this);
 
-    for (int i = 0; i < _blurRadius; ++i) {
-        blurredImage = blurredImage.scaled(
-            blurredImage.width() / 2,
-            blurredImage.height() / 2,
-            Qt::IgnoreAspectRatio,
-            Qt::SmoothTransformation);
-        blurredImage = blurredImage.scaled(
-            inputImage.width(),
-            inputImage.height(),
-            Qt::IgnoreAspectRatio,
-            Qt::SmoothTransformation);
+    _slider->setMinimum(1);
+    _slider->setMaximum(100);
+    _slider->setValue(_kernel->parameters().radius);
+    _slider->setTickPosition(QSlider::TicksBelow);
+    _slider->setToolTip("Adjust blur radius in pixels");
+
+    connect(_slider, &QSlider::valueChanged, this, [this](int value) {
+        GaussianBlurKernel::Parameters parameters = _kernel->parameters();
+        parameters.radius = value;
+        setParameters(parameters);
+    });
+
+    ProxyPreview::instance().trackSlider(_slider);
+
+    _layout->addWidget(_label);
+    _layout->addWidget(_slider);
+    _widget->setLayout(_layout);
+
+    return _widget;
+}
+
+void GaussianBlurModel::setParameters(GaussianBlurKernel::Parameters const &parameters)
+{
+    _kernel = std::make_shared<GaussianBlurKernel const>(parameters);
+
+    if (_slider) {
+        QSignalBlocker const blocker(_slider);
+        _slider->setValue(parameters.radius);
+    }
+
+    applyGaussianBlur();
+}
+
+QSizeF GaussianBlurModel::footprint() const
+{
+    if (!_input)
+        return QSizeF();
+
+    return _input->pixelSize() * effectiveKernel()->halo();
+}
+
+std::shared_ptr<GaussianBlurKernel const> GaussianBlurModel::effectiveKernel() const
+{
+    // The radius is given in pixels of the full resolution.
+    double const factor = ProxyPreview::instance().currentFactor();
+    return factor < 1.0 ? _kernel->scaled(factor) : _kernel;
+}
+
+void GaussianBlurModel::applyGaussianBlur()
+{
+    if (!_input) return;
+
+    // The radius or the input resolution changed the area needed upstream.
+    QSizeF const footprint = this->footprint();
+    if (footprint != _footprint) {
+        _footprint = footprint;
+        Q_EMIT inRequestsChanged();
     }
 
-    painter.end();
+    std::shared_ptr<GaussianBlurKernel const> const kernel = effectiveKernel();
+    ImageKernel::Inputs const inputs{_input};
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
 
-    _blurredPixmap = QPixmap::fromImage(blurredImage);
-    _label->setPixmap(_blurredPixmap.scaled(_label->size(), Qt::KeepAspectRatio));
-    _label->setToolTip(QString("Size: %1 x %2\nRadius: %3 px")
-                           .arg(_originalPixmap.width())
-                           .arg(_originalPixmap.height())
-                           .arg(_blurRadius));
+    runComputation([this, kernel, inputs, request]() {
+        std::shared_ptr<ImageData> const result
+            = kernel->compute(inputs, request, []() { return computationCancelled(); });
 
-    Q_EMIT dataUpdated(0);
+        return [this, kernel, result]() {
+            _output = result;
+
+            if (_label && _output) {
+                _label->setPixmap(_output->toPixmap(_label->size()));
+                _label->setToolTip(QString("Size: %1 x %2\nRadius: %3 px")
+                                       .arg(_output->buffer()->width())
+                                       .arg(_output->buffer()->height())
+                                       .arg(kernel->parameters().radius));
+            }
+
+            Q_EMIT dataUpdated(0);
+        };
+    });
 }
@@ -8,7 +8,8 @@
 
 #include <QtNodes/NodeDelegateModel>
 
-#include "PixmapData.hpp"
+#include "GaussianBlurKernel.hpp"
+#include "ImageData.hpp"
 
 using QtNodes::NodeData;
 using QtNodes::NodeDataType;
@@ -29,29 +30,59 @@ public:
     QString name() const override { return QString("GaussianBlurModel"); }
     QString modelName() const { return QString("Gaussian Blur"); }
 
+    QJsonObject save() const override;
+    void load(QJsonObject const &modelJson) override;
+
     unsigned int nPorts(PortType portType) const override;
     NodeDataType dataType(PortType portType, PortIndex portIndex) const override;
 
     std::shared_ptr<NodeData> outData(PortIndex port) override;
     void setInData(std::shared_ptr<NodeData> nodeData, PortIndex port) override;
 
-    QWidget *embeddedWidget() override { return _widget; }
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(PortIndex port) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       PortIndex port) override;
+
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<NodeData>> const &outputs) override;
+
+    QWidget *embeddedWidget() override;
     bool resizable() const override { return true; }
 
+    std::shared_ptr<GaussianBlurKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and recomputes the output.
+    void setParameters(GaussianBlurKernel::Parameters const &parameters);
+
 protected:
     bool eventFilter(QObject *object, QEvent *event) override;
 
 private:
-    void applyGaussianBlur(const QPixmap &input);
+    void applyGaussianBlur();
+
+    /// The kernel run on the input, scaled down for the proxy images.
+    std::shared_ptr<GaussianBlurKernel const> effectiveKernel() const;
+
+    /// The blur halo in normalized frame coordinates.
+    QSizeF footprint() const;
 
 private:
-    QLabel *_label;
-    QSlider *_slider;
-    QWidget *_widget;
-    QVBoxLayout *_layout;
+    // Created by `embeddedWidget`, headless graphs have none.
+    QLabel *_label = nullptr;
+    QSlider *_slider = nullptr;
+    QWidget *_widget = nullptr;
+    QVBoxLayout *_layout = nullptr;
+
+    std::shared_ptr<ImageData> _input;
+    std::shared_ptr<ImageData> _output;
+
+    std::shared_ptr<ImageRequest const> _outRequest;
 
-    QPixmap _originalPixmap;
-    QPixmap _blurredPixmap;
+    QSizeF _footprint;
 
-    int _blurRadius = 5;
+    std::shared_ptr<GaussianBlurKernel const> _kernel;
 };
@@ -0,0 +1,256 @@
+#include "ImageBuffer.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include <atomic>
+#include <utility>
+
+namespace {
+
+std::atomic<std::uint64_t> nextBufferId{1};
+
+int cvType(ImageBuffer::Format format)
+{
+    return CV_8UC(ImageBuffer::channels(format));
+}
+
+int conversionCode(ImageBuffer::Format from, ImageBuffer::Format to)
+{
+    using F = ImageBuffer::Format;
+
+    switch (from) {
+    case F::Gray8:
+        switch (to) {
+        case F::RGB888:
+            return cv::COLOR_GRAY2RGB;
+        case F::BGR888:
+            return cv::COLOR_GRAY2BGR;
+        case F::RGBA8888:
+            return cv::COLOR_GRAY2RGBA;
+        default:
+            return cv::COLOR_GRAY2BGRA;
+        }
+
+    case F::RGB888:
+        switch (to) {
+        case F::Gray8:
+            return cv::COLOR_RGB2GRAY;
+        case F::BGR888:
+            return cv::COLOR_RGB2BGR;
+        case F::RGBA8888:
+            return cv::COLOR_RGB2RGBA;
+        default:
+            return cv::COLOR_RGB2BGRA;
+        }
+
+    case F::BGR888:
+        switch (to) {
+        case F::Gray8:
+            return cv::COLOR_BGR2GRAY;
+        case F::RGB888:
+            return cv::COLOR_BGR2RGB;
+        case F::RGBA8888:
+            return cv::COLOR_BGR2RGBA;
+        default:
+            return cv::COLOR_BGR2BGRA;
+        }
+
+    case F::RGBA8888:
+        switch (to) {
+        case F::Gray8:
+            return cv::COLOR_RGBA2GRAY;
+        case F::RGB888:
+            return cv::COLOR_RGBA2RGB;
+        case F::BGR888:
+            return cv::COLOR_RGBA2BGR;
+        default:
+            return cv::COLOR_RGBA2BGRA;
+        }
+
+    case F::BGRA8888:
+        switch (to) {
+        case F::Gray8:
+            return cv::COLOR_BGRA2GRAY;
+        case F::RGB888:
+            return cv::COLOR_BGRA2RGB;
+        case F::BGR888:
+            return cv::COLOR_BGRA2BGR;
+        default:
+            return cv::COLOR_BGRA2RGBA;
+        }
+    }
+
+    return cv::COLOR_BGRA2RGBA;
+}
+
+void releaseBuffer(void *info)
+{
+    delete static_cast<std::shared_ptr<ImageBuffer const> *>(info);
+}
+
+} // namespace
+
+int ImageBuffer::channels(Format format)
+{
+    switch (format) {
+    case Format::Gray8:
+        return 1;
+    case Format::RGB888:
+    case Format::BGR888:
+        return 3;
+    case Format::RGBA8888:
+    case Format::BGRA8888:
+        return 4;
+    }
+
+    return 4;
+}
+
+void ImageBuffer::convert(cv::Mat const &source, Format from, cv::Mat &destination, Format to)
+{
+    if (from == to)
+        source.copyTo(destination);
+    else
+        cv::cvtColor(source, destination, conversionCode(from, to));
+}
+
+std::uint64_t ImageBuffer::newId()
+{
+    return nextBufferId++;
+}
+
+ImageBuffer::ImageBuffer(cv::Mat mat, QImage owner, Format format)
+    : _mat(std::move(mat))
+    , _owner(std::move(owner))
+    , _format(format)
+    , _id(nextBufferId++)
+{}
+
+std::shared_ptr<ImageBuffer const> ImageBuffer::fromMat(cv::Mat mat, Format format)
+{
+    Q_ASSERT(mat.type() == cvType(format));
+
+    return std::shared_ptr<ImageBuffer const>(new ImageBuffer(std::move(mat), QImage(), format));
+}
+
+std::shared_ptr<ImageBuffer const> ImageBuffer::fromImage(QImage const &image)
+{
+    QImage source = image;
+    Format format = Format::BGRA8888;
+
+    switch (image.format()) {
+    case QImage::Format_Grayscale8:
+        format = Format::Gray8;
+        break;
+
+    case QImage::Format_RGB888:
+        format = Format::RGB888;
+        break;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    case QImage::Format_BGR888:
+        format = Format::BGR888;
+        break;
+#endif
+
+    case QImage::Format_RGBA8888:
+        format = Format::RGBA8888;
+        break;
+
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+        break;
+
+    default:
+        source = image.convertToFormat(QImage::Format_ARGB32);
+        break;
+    }
+
+    // `constBits` does not detach, the pixels stay shared with `image`.
+    cv::Mat mat(source.height(),
+                source.width(),
+                cvType(format),
+                const_cast<uchar *>(source.constBits()),
+                static_cast<std::size_t>(source.bytesPerLine()));
+
+    return std::shared_ptr<ImageBuffer const>(new ImageBuffer(mat, source, format));
+}
+
+QImage ImageBuffer::image() const
+{
+    QImage::Format qFormat = QImage::Format_ARGB32;
+
+    switch (_format) {
+    case Format::Gray8:
+        qFormat = QImage::Format_Grayscale8;
+        break;
+
+    case Format::RGB888:
+        qFormat = QImage::Format_RGB888;
+        break;
+
+    case Format::BGR888:
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+        qFormat = QImage::Format_BGR888;
+        break;
+#else
+        return converted(Format::RGB888)->image();
+#endif
+
+    case Format::RGBA8888:
+        qFormat = QImage::Format_RGBA8888;
+        break;
+
+    case Format::BGRA8888:
+        qFormat = QImage::Format_ARGB32;
+        break;
+    }
+
+    if (!_owner.isNull() && _owner.format() == qFormat)
+        return _owner;
+
+    // The image keeps a reference to the buffer until it is destroyed.
+    auto *keepAlive = new std::shared_ptr<ImageBuffer const>(shared_from_this());
+
+    // The const data makes Qt copy the pixels before any modification.
+    return QImage(static_cast<uchar const *>(_mat.data),
+                  _mat.cols,
+                  _mat.rows,
+                  static_cast<int>(_mat.step),
+                  qFormat,
+                  releaseBuffer,
+                  keepAlive);
+}
+
+std::shared_ptr<ImageBuffer const> ImageBuffer::converted(Format format) const
+{
+    if (format == _format)
+        return shared_from_this();
+
+    std::size_t const index = static_cast<std::size_t>(format);
+
+    std::lock_guard<std::mutex> lock(_conversionMutexes[index]);
+
+    std::shared_ptr<ImageBuffer const> &conversion = _conversions[index];
+
+    if (!conversion) {
+        cv::Mat result;
+        convert(_mat, _format, result, format);
+
+        conversion = fromMat(result, format);
+    }
+
+    return conversion;
+}
+
+bool ImageBuffer::hasConversion(Format format) const
+{
+    if (format == _format)
+        return true;
+
+    std::size_t const index = static_cast<std::size_t>(format);
+
+    std::lock_guard<std::mutex> lock(_conversionMutexes[index]);
+
+    return static_cast<bool>(_conversions[index]);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <QtGui/QImage>
+
+#include <opencv2/core.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/// Reference-counted, immutable pixel buffer shared between the nodes.
+/**
+ * The pixels never change after construction, so a buffer can be read
+ * from any thread and passed downstream without copying. `mat()` and
+ * `image()` are views on the same memory, a `QImage` view detaches
+ * (copies) only if somebody tries to modify it.
+ *
+ * Buffers are only handled through `std::shared_ptr<ImageBuffer const>`,
+ * @see fromMat, fromImage.
+ */
+class ImageBuffer : public std::enable_shared_from_this<ImageBuffer>
+{
+public:
+    /// Channel order in memory.
+    enum class Format
+    {
+        Gray8,
+        RGB888,
+        BGR888,
+        RGBA8888,
+        /// The byte order of `QImage::Format_ARGB32` on little-endian machines.
+        BGRA8888,
+    };
+
+    static constexpr std::size_t FormatCount = 5;
+
+    static int channels(Format format);
+
+    /// Converts the pixels of `source` from `from` to `to`, copies them if the formats match.
+    static void convert(cv::Mat const &source, Format from, cv::Mat &destination, Format to);
+
+    /// Draws from the counter of the buffer ids, for data that has no buffer yet.
+    static std::uint64_t newId();
+
+public:
+    /**
+   * Adopts the pixels of `mat` without copying. The caller must not
+   * modify them through other `cv::Mat` headers afterwards.
+   */
+    static std::shared_ptr<ImageBuffer const> fromMat(cv::Mat mat, Format format);
+
+    /**
+   * Shares the pixels of `image` without copying if its format has a
+   * counterpart in `Format`, otherwise converts it to `BGRA8888`. Qt copies
+   * the pixels if the caller later modifies its `QImage`.
+   */
+    static std::shared_ptr<ImageBuffer const> fromImage(QImage const &image);
+
+public:
+    int width() const { return _mat.cols; }
+
+    int height() const { return _mat.rows; }
+
+    QSize size() const { return QSize(_mat.cols, _mat.rows); }
+
+    Format format() const { return _format; }
+
+    int channels() const { return channels(_format); }
+
+    /// Bytes between the starts of two rows.
+    std::size_t stride() const { return _mat.step; }
+
+    std::size_t byteSize() const { return _mat.step * static_cast<std::size_t>(_mat.rows); }
+
+    /// Unique for every buffer created in the process.
+    std::uint64_t id() const { return _id; }
+
+    uchar const *data() const { return _mat.data; }
+
+    uchar const *row(int y) const { return _mat.ptr(y); }
+
+public:
+    /**
+   * Zero-copy view. The header shares the pixels, which must only be read,
+   * and stays valid while the buffer is alive.
+   */
+    cv::Mat mat() const { return _mat; }
+
+    /// Zero-copy read-only view, keeping the buffer alive while referenced.
+    QImage image() const;
+
+    /**
+   * @returns the pixels in `format`, the buffer itself if it matches.
+   *
+   * Conversions are computed on the first request and cached for the
+   * lifetime of the buffer, so all the nodes reading the same buffer
+   * share them. Concurrent requests for the same format wait for a single
+   * conversion.
+   */
+    std::shared_ptr<ImageBuffer const> converted(Format format) const;
+
+    /// @returns `true` if the conversion to `format` is available without work.
+    bool hasConversion(Format format) const;
+
+private:
+    ImageBuffer(cv::Mat mat, QImage owner, Format format);
+
+private:
+    /// Either owns the pixels or points into `_owner`.
+    cv::Mat _mat;
+
+    QImage _owner;
+
+    Format _format;
+
+    std::uint64_t _id;
+
+    /// Conversions produced so far, indexed by the target format.
+    mutable std::array<std::shared_ptr<ImageBuffer const>, FormatCount> _conversions;
+
+    mutable std::array<std::mutex, FormatCount> _conversionMutexes;
+};
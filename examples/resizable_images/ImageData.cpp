@@ -0,0 +1,41 @@
+#include "ImageData.hpp"
+
+#include "PointwiseChain.hpp"
+
+#include <mutex>
+
+struct ImageData::Materialized
+{
+    std::mutex mutex;
+
+    std::shared_ptr<ImageBuffer const> buffer;
+};
+
+ImageData::ImageData(std::shared_ptr<PointwiseChain const> chain, QRectF const &region)
+    : _chain(std::move(chain))
+    , _materialized(std::make_shared<Materialized>())
+    , _region(region)
+    , _width(_chain->size().width)
+    , _height(_chain->size().height)
+    , _identity(ImageBuffer::newId())
+{}
+
+std::size_t ImageData::byteSize() const
+{
+    if (!_chain)
+        return _buffer ? _buffer->byteSize() : 0;
+
+    std::lock_guard<std::mutex> lock(_materialized->mutex);
+    return _materialized->buffer ? _materialized->buffer->byteSize() : 0;
+}
+
+std::shared_ptr<ImageBuffer const> ImageData::materialize() const
+{
+    // Concurrent readers wait for a single pass.
+    std::lock_guard<std::mutex> lock(_materialized->mutex);
+
+    if (!_materialized->buffer)
+        _materialized->buffer = _chain->run();
+
+    return _materialized->buffer;
+}
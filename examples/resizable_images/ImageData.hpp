@@ -0,0 +1,184 @@
+#pragma once
+
+#include <QtGui/QPixmap>
+
+#include <QtNodes/NodeData>
+
+#include "ImageBuffer.hpp"
+#include "ImageRequest.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+using QtNodes::NodeData;
+using QtNodes::NodeDataType;
+
+class PointwiseChain;
+
+/// Image passed between the nodes.
+/**
+ * Wraps an immutable ImageBuffer, copies of the data share the pixels.
+ * Unlike `QPixmap` the data may be read on worker threads.
+ *
+ * Models request the format they work in with
+ * `buffer()->converted(format)` instead of converting on their own, the
+ * conversions are cached in the buffer. Color outputs are produced in
+ * `BGR888`, the OpenCV channel order, so that chains of nodes do not
+ * flip the channel order back and forth.
+ *
+ * The buffer may cover only a region of the frame, computed for an
+ * ImageRequest of the nodes downstream. The region is normalized to the
+ * frame like the requests.
+ *
+ * The data of a fused run of pointwise nodes is deferred: it holds the
+ * PointwiseChain of kernels producing the pixels instead of the pixels,
+ * and the next pointwise node extends the chain. `buffer()` computes the
+ * pixels in one pass on the first call, @see PointwiseFusion.
+ */
+class ImageData : public NodeData
+{
+public:
+    ImageData() {}
+
+    ImageData(std::shared_ptr<ImageBuffer const> buffer, QRectF const &region = QRectF(0, 0, 1, 1))
+        : _buffer(std::move(buffer))
+        , _region(region)
+        , _width(_buffer ? _buffer->width() : 0)
+        , _height(_buffer ? _buffer->height() : 0)
+        , _identity(_buffer ? _buffer->id() : 0)
+    {}
+
+    /// Deferred data, the pixels of `chain` covering `region`.
+    ImageData(std::shared_ptr<PointwiseChain const> chain, QRectF const &region);
+
+    NodeDataType type() const override
+    {
+        //       id      name
+        return {"image", "I"};
+    }
+
+    bool isNull() const { return !_buffer && !_chain; }
+
+    /// Tells if the pixels are computed only when read.
+    bool isDeferred() const { return static_cast<bool>(_chain); }
+
+    /// The kernels producing deferred data, null otherwise.
+    std::shared_ptr<PointwiseChain const> chain() const { return _chain; }
+
+    /// The pixels, deferred data computes them on the calling thread.
+    std::shared_ptr<ImageBuffer const> buffer() const { return _chain ? materialize() : _buffer; }
+
+    /// Known without computing deferred data.
+    int width() const { return _width; }
+
+    int height() const { return _height; }
+
+    /// The part of the frame covered by the buffer.
+    QRectF region() const { return _region; }
+
+    /// Size of one pixel of the buffer in normalized frame coordinates.
+    QSizeF pixelSize() const
+    {
+        if (isNull())
+            return QSizeF();
+
+        return QSizeF(_region.width() / _width, _region.height() / _height);
+    }
+
+    /**
+   * The pixels of the buffer covering the region of `request`, rounded
+   * outwards. A null request, or one outside of the buffer, covers the
+   * whole buffer.
+   */
+    cv::Rect area(std::shared_ptr<ImageRequest const> const &request) const
+    {
+        if (isNull())
+            return cv::Rect();
+
+        cv::Rect const all(0, 0, _width, _height);
+
+        if (!request)
+            return all;
+
+        QSizeF const pixel = pixelSize();
+        QRectF const r = request->region();
+
+        int const left = static_cast<int>(std::floor((r.left() - _region.left()) / pixel.width()));
+        int const top = static_cast<int>(std::floor((r.top() - _region.top()) / pixel.height()));
+        int const right = static_cast<int>(std::ceil((r.right() - _region.left()) / pixel.width()));
+        int const bottom = static_cast<int>(std::ceil((r.bottom() - _region.top()) / pixel.height()));
+
+        cv::Rect const result = cv::Rect(left, top, right - left, bottom - top) & all;
+
+        return result.area() > 0 ? result : all;
+    }
+
+    /// The part of the frame covered by the pixels `area` of the buffer.
+    QRectF regionOf(cv::Rect const &area) const
+    {
+        QSizeF const pixel = pixelSize();
+
+        return QRectF(_region.left() + area.x * pixel.width(),
+                      _region.top() + area.y * pixel.height(),
+                      area.width * pixel.width(),
+                      area.height * pixel.height());
+    }
+
+    /// Tells if the data contains the region of `request` in its resolution.
+    bool covers(std::shared_ptr<ImageRequest const> const &request) const
+    {
+        if (isNull())
+            return false;
+
+        // Tolerates the rounding of the pixel areas.
+        QSizeF const pixel = pixelSize();
+        QRectF const tolerant = _region.adjusted(-pixel.width(),
+                                                 -pixel.height(),
+                                                 pixel.width(),
+                                                 pixel.height());
+
+        if (!request)
+            return tolerant.contains(QRectF(0, 0, 1, 1));
+
+        return tolerant.contains(request->region())
+               && 1.0 / pixel.width() >= 0.99 * request->density().width()
+               && 1.0 / pixel.height() >= 0.99 * request->density().height();
+    }
+
+    /// Deferred data gets an id of its own, equal parameters still compute again.
+    std::size_t identity() const override { return static_cast<std::size_t>(_identity); }
+
+    /// Deferred data takes no memory until computed.
+    std::size_t byteSize() const override;
+
+    /// Display pixmap fitting `size`, GUI thread only.
+    QPixmap toPixmap(QSize const &size) const
+    {
+        if (isNull())
+            return QPixmap();
+
+        return QPixmap::fromImage(
+            buffer()->image().scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    }
+
+private:
+    /// Computes the pixels of deferred data once, shared by the copies.
+    std::shared_ptr<ImageBuffer const> materialize() const;
+
+private:
+    struct Materialized;
+
+    std::shared_ptr<ImageBuffer const> _buffer;
+
+    std::shared_ptr<PointwiseChain const> _chain;
+
+    std::shared_ptr<Materialized> _materialized;
+
+    QRectF _region;
+
+    int _width = 0;
+
+    int _height = 0;
+
+    std::uint64_t _identity = 0;
+};
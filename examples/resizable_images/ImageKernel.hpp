@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ImageData.hpp"
+#include "ImageRequest.hpp"
+
+#include <QtCore/QJsonObject>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/// Widget-free computation of an image model.
+/**
+ * A kernel is an immutable snapshot of the parameters of a model together
+ * with the computation they drive. It touches neither widgets nor the
+ * model, so it runs on worker threads, in headless processes and behind
+ * the computation cache alike. The widgets of a model only edit the
+ * snapshot: every change of a parameter creates a new kernel.
+ *
+ * Kernels are handled through `std::shared_ptr<Kernel const>`, a running
+ * computation keeps the snapshot it was started with.
+ */
+class ImageKernel
+{
+public:
+    using Inputs = std::vector<std::shared_ptr<ImageData>>;
+
+    /// Polled by long computations, `true` drops the result.
+    using CancelCheck = std::function<bool()>;
+
+    virtual ~ImageKernel() = default;
+
+    /**
+   * @returns the output for the region of `request`, or null if an input
+   * is missing or the computation was cancelled. A null request stands
+   * for the whole frame.
+   */
+    virtual std::shared_ptr<ImageData> compute(Inputs const &inputs,
+                                               std::shared_ptr<ImageRequest const> const &request,
+                                               CancelCheck const &cancelled = CancelCheck()) const
+        = 0;
+
+    /// Pixels of the input around an output pixel the computation reads.
+    virtual int halo() const { return 0; }
+
+    /// Writes the parameters to `json`, the `internal-data` of the node.
+    virtual void save(QJsonObject &json) const = 0;
+};
@@ -1,25 +1,22 @@
 #include "ImageLoaderModel.hpp"
 
+#include "ProxyPreview.hpp"
+
 #include <QtCore/QDir>
 #include <QtCore/QEvent>
 
+#include <algorithm>
+
 #include <QtWidgets/QFileDialog>
 
 ImageLoaderModel::ImageLoaderModel()
-    : _label(new QLabel("Double click to load image"))
+    : _label(nullptr)
 {
-    _label->setAlignment(Qt::AlignVCenter | Qt::AlignHCenter);
-
-    QFont f = _label->font();
-    f.setBold(true);
-    f.setItalic(true);
-
-    _label->setFont(f);
-
-    _label->setMinimumSize(200, 200);
-    _label->setMaximumSize(500, 300);
-
-    _label->installEventFilter(this);
+    // Switches the whole graph between the proxy and the full resolution.
+    connect(&ProxyPreview::instance(), &ProxyPreview::interactiveChanged, this, [this]() {
+        if (_image)
+            updateOutput();
+    });
 }
 
 unsigned int ImageLoaderModel::nPorts(PortType portType) const
@@ -41,6 +38,31 @@ unsigned int ImageLoaderModel::nPorts(PortType portType) const
     return result;
 }
 
+QWidget *ImageLoaderModel::embeddedWidget()
+{
+    if (_label)
+        return _label;
+
+    _label = new QLabel("Double click to load image");
+    _label->setAlignment(Qt::AlignVCenter | Qt::AlignHCenter);
+
+    QFont f = _label->font();
+    f.setBold(true);
+    f.setItalic(true);
+
+    _label->setFont(f);
+
+    _label->setMinimumSize(200, 200);
+    _label->setMaximumSize(500, 300);
+
+    _label->installEventFilter(this);
+
+    if (_image)
+        _label->setPixmap(_image->toPixmap(_label->size()));
+
+    return _label;
+}
+
 bool ImageLoaderModel::eventFilter(QObject *object, QEvent *event)
 {
     if (object == _label) {
@@ -53,28 +75,105 @@ bool ImageLoaderModel::eventFilter(QObject *object, QEvent *event)
                                                             QDir::homePath(),
                                                             tr("Image Files (*.png *.jpg *.bmp)"));
 
-            _pixmap = QPixmap(fileName);
-
-            _label->setPixmap(_pixmap.scaled(w, h, Qt::KeepAspectRatio));
-
-            Q_EMIT dataUpdated(0);
+            setImage(QImage(fileName));
 
             return true;
         } else if (event->type() == QEvent::Resize) {
-            if (!_pixmap.isNull())
-                _label->setPixmap(_pixmap.scaled(w, h, Qt::KeepAspectRatio));
+            if (_image)
+                _label->setPixmap(_image->toPixmap(QSize(w, h)));
         }
     }
 
     return false;
 }
 
+void ImageLoaderModel::setImage(QImage const &image)
+{
+    _image.reset();
+    _output.reset();
+
+    if (!image.isNull())
+        _image = std::make_shared<ImageData>(ImageBuffer::fromImage(image));
+
+    if (_label)
+        _label->setPixmap(_image ? _image->toPixmap(_label->size()) : QPixmap());
+
+    if (_image)
+        updateOutput();
+    else
+        Q_EMIT dataUpdated(0);
+}
+
 NodeDataType ImageLoaderModel::dataType(PortType const, PortIndex const) const
 {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<NodeData> ImageLoaderModel::outData(PortIndex)
 {
-    return std::make_shared<PixmapData>(_pixmap);
+    return _output;
+}
+
+void ImageLoaderModel::inputsUpdated()
+{
+    // Without inputs the graph calls it once the request of the output changed.
+    if (_image)
+        updateOutput();
+}
+
+bool ImageLoaderModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                                     PortIndex const)
+{
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+
+    // A zoom into the served region keeps it, the nodes downstream need not recompute.
+    return _image && !(_output && _output->covers(_outRequest));
+}
+
+void ImageLoaderModel::updateOutput()
+{
+    std::shared_ptr<ImageData> const image = _image;
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
+    double const factor = ProxyPreview::instance().currentFactor();
+
+    runComputation([this, image, request, factor]() {
+        std::shared_ptr<ImageData> const result = requestedImage(image, request, factor);
+
+        return [this, result]() {
+            _output = result;
+            Q_EMIT dataUpdated(0);
+        };
+    });
+}
+
+std::shared_ptr<ImageData> ImageLoaderModel::requestedImage(
+    std::shared_ptr<ImageData> const &image,
+    std::shared_ptr<ImageRequest const> const &request,
+    double proxyFactor)
+{
+    std::shared_ptr<ImageBuffer const> const buffer = image->buffer();
+
+    double scale = proxyFactor;
+    if (request && !request->density().isEmpty()) {
+        QSizeF const density = request->density();
+        scale *= std::min(1.0,
+                          std::max(density.width() / buffer->width(),
+                                   density.height() / buffer->height()));
+    }
+
+    cv::Rect const area = image->area(request);
+
+    if (scale >= 1.0 && area.size() == buffer->mat().size())
+        return image;
+
+    QImage cropped = buffer->image().copy(area.x, area.y, area.width, area.height);
+
+    if (scale < 1.0) {
+        cropped = cropped.scaled(std::max(1, qRound(area.width * scale)),
+                                 std::max(1, qRound(area.height * scale)),
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation);
+    }
+
+    return std::make_shared<ImageData>(ImageBuffer::fromImage(cropped), image->regionOf(area));
 }
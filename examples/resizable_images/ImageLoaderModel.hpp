@@ -8,7 +8,7 @@
 #include <QtNodes/NodeDelegateModel>
 #include <QtNodes/NodeDelegateModelRegistry>
 
-#include "PixmapData.hpp"
+#include "ImageData.hpp"
 
 using QtNodes::NodeData;
 using QtNodes::NodeDataType;
@@ -43,15 +43,39 @@ public:
 
     void setInData(std::shared_ptr<NodeData>, PortIndex const portIndex) override {}
 
-    QWidget *embeddedWidget() override { return _label; }
+    /// Called by the graph once the request of the output changed.
+    void inputsUpdated() override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       PortIndex const portIndex) override;
+
+    QWidget *embeddedWidget() override;
 
     bool resizable() const override { return true; }
 
+    /// Replaces the loaded image, e.g. with the current image of a batch.
+    void setImage(QImage const &image);
+
 protected:
     bool eventFilter(QObject *object, QEvent *event) override;
 
 private:
+    /// Serves the part of `_image` the request and the preview mode ask for, off the GUI thread.
+    void updateOutput();
+
+    /// Crops `image` to `request` and downscales it by its density and `proxyFactor`.
+    static std::shared_ptr<ImageData> requestedImage(std::shared_ptr<ImageData> const &image,
+                                                     std::shared_ptr<ImageRequest const> const &request,
+                                                     double proxyFactor);
+
+private:
+    /// Created by `embeddedWidget`, headless graphs have none.
     QLabel *_label;
 
-    QPixmap _pixmap;
+    std::shared_ptr<ImageData> _image;
+
+    std::shared_ptr<ImageRequest const> _outRequest;
+
+    /// The part of `_image` served downstream.
+    std::shared_ptr<ImageData> _output;
 };
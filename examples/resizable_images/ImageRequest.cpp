@@ -0,0 +1,59 @@
+#include "ImageRequest.hpp"
+
+#include <QtCore/QJsonArray>
+
+#include <algorithm>
+
+ImageRequest::ImageRequest(QRectF const &region, QSizeF const &density)
+    : _region(region & QRectF(0, 0, 1, 1))
+    , _density(density)
+{}
+
+std::shared_ptr<QtNodes::NodeDataRequest const> ImageRequest::united(
+    QtNodes::NodeDataRequest const &other) const
+{
+    auto const *request = dynamic_cast<ImageRequest const *>(&other);
+
+    // Requests of an unknown kind are not restricted.
+    if (!request)
+        return nullptr;
+
+    return std::make_shared<ImageRequest>(_region | request->_region,
+                                          _density.expandedTo(request->_density));
+}
+
+bool ImageRequest::equals(QtNodes::NodeDataRequest const &other) const
+{
+    auto const *request = dynamic_cast<ImageRequest const *>(&other);
+
+    return request && _region == request->_region && _density == request->_density;
+}
+
+void ImageRequest::save(std::shared_ptr<ImageRequest const> const &request, QJsonObject &json)
+{
+    if (!request)
+        return;
+
+    QRectF const &r = request->_region;
+
+    json["request"] = QJsonArray{r.x(),
+                                 r.y(),
+                                 r.width(),
+                                 r.height(),
+                                 request->_density.width(),
+                                 request->_density.height()};
+}
+
+std::shared_ptr<ImageRequest const> ImageRequest::grown(
+    std::shared_ptr<ImageRequest const> const &request, QSizeF const &margin)
+{
+    if (!request || margin.isEmpty())
+        return request;
+
+    QRectF const region = request->_region.adjusted(-margin.width(),
+                                                    -margin.height(),
+                                                    margin.width(),
+                                                    margin.height());
+
+    return std::make_shared<ImageRequest>(region, request->_density);
+}
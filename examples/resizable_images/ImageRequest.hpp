@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QRectF>
+#include <QtCore/QSizeF>
+
+#include <QtNodes/NodeData>
+
+#include <memory>
+
+/// Region and resolution of an image a node needs from its input.
+/**
+ * The region is normalized to the frame, `(0, 0, 1, 1)` is the whole
+ * image, so that requests pass unchanged through nodes resizing their
+ * inputs. The density is the number of pixels needed across the whole
+ * frame width and height, e.g. a 200 px wide preview zoomed on the left
+ * half of the frame needs a density of 400.
+ *
+ * Processing nodes grow the request of their output by the footprint of
+ * their operation (@see grown) and compute only the pixels of the
+ * requested region (@see ImageData::area).
+ */
+class ImageRequest : public QtNodes::NodeDataRequest
+{
+public:
+    ImageRequest(QRectF const &region, QSizeF const &density);
+
+    QRectF region() const { return _region; }
+
+    QSizeF density() const { return _density; }
+
+public:
+    std::shared_ptr<QtNodes::NodeDataRequest const> united(
+        QtNodes::NodeDataRequest const &other) const override;
+
+    bool equals(QtNodes::NodeDataRequest const &other) const override;
+
+public:
+    /// Adds the request to the computation parameters of a model, a null request adds nothing.
+    static void save(std::shared_ptr<ImageRequest const> const &request, QJsonObject &json);
+
+    /**
+   * @returns `request` grown by `margin`, given in normalized frame
+   * coordinates. A null request stays null.
+   */
+    static std::shared_ptr<ImageRequest const> grown(
+        std::shared_ptr<ImageRequest const> const &request, QSizeF const &margin);
+
+private:
+    QRectF _region;
+
+    QSizeF _density;
+};
@@ -1,16 +1,37 @@
 #include "ImageShowModel.hpp"
 
-#include "PixmapData.hpp"
+#include "ImageData.hpp"
 
 #include <QtNodes/NodeDelegateModelRegistry>
 
 #include <QtCore/QDir>
 #include <QtCore/QEvent>
+#include <QtGui/QMouseEvent>
 #include <QtWidgets/QFileDialog>
 
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// The smallest view, relative to the frame.
+constexpr double minimumView = 1.0 / 64;
+
+} // namespace
+
 ImageShowModel::ImageShowModel()
-    : _label(new QLabel("Image will appear here"))
+    : _label(nullptr)
+    , _view(0, 0, 1, 1)
+    , _outputConnections(0)
+    , _fullResolution(false)
+{}
+
+QWidget *ImageShowModel::embeddedWidget()
 {
+    if (_label)
+        return _label;
+
+    _label = new QLabel("Image will appear here");
     _label->setAlignment(Qt::AlignVCenter | Qt::AlignHCenter);
 
     QFont f = _label->font();
@@ -21,7 +42,14 @@ ImageShowModel::ImageShowModel()
 
     _label->setMinimumSize(200, 200);
 
+    _label->setToolTip("Double click to zoom in, right click to zoom out, drag to pan");
+
     _label->installEventFilter(this);
+
+    // The resize on embedding requests the resolution of the label upstream.
+    updatePixmap();
+
+    return _label;
 }
 
 unsigned int ImageShowModel::nPorts(PortType portType) const
@@ -46,23 +74,170 @@ unsigned int ImageShowModel::nPorts(PortType portType) const
 bool ImageShowModel::eventFilter(QObject *object, QEvent *event)
 {
     if (object == _label) {
-        int w = _label->width();
-        int h = _label->height();
+        switch (event->type()) {
+        case QEvent::Resize:
+            updatePixmap();
+
+            // The label may need a finer resolution.
+            Q_EMIT inRequestsChanged();
+            break;
+
+        case QEvent::MouseButtonDblClick: {
+            auto mouseEvent = static_cast<QMouseEvent *>(event);
+            QPointF const center = framePosition(mouseEvent->pos());
+
+            QSizeF const size = _view.size() / 2;
+            setView(QRectF(center - QPointF(size.width() / 2, size.height() / 2), size));
+            return true;
+        }
+
+        case QEvent::MouseButtonPress: {
+            auto mouseEvent = static_cast<QMouseEvent *>(event);
+
+            if (mouseEvent->button() == Qt::RightButton) {
+                QSizeF const size = _view.size() * 2;
+                setView(QRectF(_view.center() - QPointF(size.width() / 2, size.height() / 2),
+                               size));
+            } else {
+                _dragPosition = mouseEvent->pos();
+            }
+            return true;
+        }
+
+        case QEvent::MouseMove: {
+            auto mouseEvent = static_cast<QMouseEvent *>(event);
+
+            if (mouseEvent->buttons() & Qt::LeftButton) {
+                QPointF const delta = framePosition(_dragPosition)
+                                      - framePosition(mouseEvent->pos());
+                _dragPosition = mouseEvent->pos();
 
-        if (event->type() == QEvent::Resize) {
-            auto d = std::dynamic_pointer_cast<PixmapData>(_nodeData);
-            if (d) {
-                _label->setPixmap(d->pixmap().scaled(w, h, Qt::KeepAspectRatio));
+                setView(_view.translated(delta));
             }
+            return true;
+        }
+
+        default:
+            break;
         }
     }
 
     return false;
 }
 
+void ImageShowModel::updatePixmap()
+{
+    if (!_label)
+        return;
+
+    auto d = std::dynamic_pointer_cast<ImageData>(_nodeData);
+
+    if (!d || d->isNull()) {
+        _label->setPixmap(QPixmap());
+        _pixmapSize = QSize();
+        return;
+    }
+
+    cv::Rect const area = d->area(std::make_shared<ImageRequest>(_view, QSizeF()));
+
+    QImage const image = d->buffer()
+                             ->image()
+                             .copy(area.x, area.y, area.width, area.height)
+                             .scaled(_label->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    _label->setPixmap(QPixmap::fromImage(image));
+    _pixmapSize = image.size();
+}
+
+void ImageShowModel::setView(QRectF const &view)
+{
+    QSizeF const size(qBound(minimumView, view.width(), 1.0),
+                      qBound(minimumView, view.height(), 1.0));
+
+    // Keeps the view inside the frame.
+    QPointF const topLeft(qBound(0.0, view.left(), 1.0 - size.width()),
+                          qBound(0.0, view.top(), 1.0 - size.height()));
+
+    QRectF const bounded(topLeft, size);
+    if (bounded == _view)
+        return;
+
+    _view = bounded;
+
+    updatePixmap();
+
+    Q_EMIT inRequestsChanged();
+}
+
+QPointF ImageShowModel::framePosition(QPoint const &position) const
+{
+    QSizeF const pixmapSize = _pixmapSize.isEmpty() ? _label->size() : _pixmapSize;
+
+    // The pixmap is centered in the label.
+    QPointF const offset((_label->width() - pixmapSize.width()) / 2,
+                         (_label->height() - pixmapSize.height()) / 2);
+
+    QPointF const relative = position - offset;
+
+    return QPointF(_view.left() + relative.x() / pixmapSize.width() * _view.width(),
+                   _view.top() + relative.y() / pixmapSize.height() * _view.height());
+}
+
+void ImageShowModel::setFullResolution(bool fullResolution)
+{
+    if (_fullResolution == fullResolution)
+        return;
+
+    _fullResolution = fullResolution;
+
+    Q_EMIT inRequestsChanged();
+}
+
+std::shared_ptr<QtNodes::NodeDataRequest const> ImageShowModel::inRequest(PortIndex const) const
+{
+    // Without a display the image is passed on in full.
+    if (_fullResolution || !_label)
+        return nullptr;
+
+    // Rounded up to a power of two, resizing the node rarely changes the request.
+    auto level = [](double pixels) { return std::exp2(std::ceil(std::log2(std::max(1.0, pixels)))); };
+
+    QSizeF const density(level(_label->width() / _view.width()),
+                         level(_label->height() / _view.height()));
+
+    auto const request = std::make_shared<ImageRequest>(_view, density);
+
+    if (_outputConnections == 0)
+        return request;
+
+    // The nodes attached to the output need their part of the image as well.
+    if (!_outRequest)
+        return nullptr;
+
+    return request->united(*_outRequest);
+}
+
+bool ImageShowModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                                   PortIndex const)
+{
+    // The image is passed on unchanged, the request goes upstream with `inRequest`.
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return false;
+}
+
+void ImageShowModel::outputConnectionCreated(ConnectionId const &)
+{
+    ++_outputConnections;
+}
+
+void ImageShowModel::outputConnectionDeleted(ConnectionId const &)
+{
+    --_outputConnections;
+}
+
 NodeDataType ImageShowModel::dataType(PortType const, PortIndex const) const
 {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<NodeData> ImageShowModel::outData(PortIndex)
@@ -74,16 +249,7 @@ void ImageShowModel::setInData(std::shared_ptr<NodeData> nodeData, PortIndex con
 {
     _nodeData = nodeData;
 
-    if (_nodeData) {
-        auto d = std::dynamic_pointer_cast<PixmapData>(_nodeData);
-
-        int w = _label->width();
-        int h = _label->height();
-
-        _label->setPixmap(d->pixmap().scaled(w, h, Qt::KeepAspectRatio));
-    } else {
-        _label->setPixmap(QPixmap());
-    }
+    updatePixmap();
 
     Q_EMIT dataUpdated(0);
 }
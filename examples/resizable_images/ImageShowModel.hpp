@@ -8,14 +8,22 @@
 #include <QtNodes/NodeDelegateModel>
 #include <QtNodes/NodeDelegateModelRegistry>
 
+#include "ImageRequest.hpp"
+
+using QtNodes::ConnectionId;
 using QtNodes::NodeData;
 using QtNodes::NodeDataType;
 using QtNodes::NodeDelegateModel;
 using QtNodes::PortIndex;
 using QtNodes::PortType;
 
-/// The model dictates the number of inputs and outputs for the Node.
-/// In this example it has no logic.
+/// Displays the incoming image and passes it on.
+/**
+ * The display is the sink of the image requests: the nodes upstream
+ * compute only the region shown and in the resolution of the label. Double
+ * click zooms in around the cursor, a right click zooms out and dragging
+ * pans the zoomed view.
+ */
 class ImageShowModel : public NodeDelegateModel
 {
     Q_OBJECT
@@ -41,15 +49,52 @@ public:
 
     void setInData(std::shared_ptr<NodeData> nodeData, PortIndex const port) override;
 
-    QWidget *embeddedWidget() override { return _label; }
+    QWidget *embeddedWidget() override;
 
     bool resizable() const override { return true; }
 
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(PortIndex const port) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       PortIndex const port) override;
+
+    /// Requests the whole frame in full resolution instead of the view, e.g. to save the image.
+    void setFullResolution(bool fullResolution);
+
+public Q_SLOTS:
+    void outputConnectionCreated(ConnectionId const &) override;
+
+    void outputConnectionDeleted(ConnectionId const &) override;
+
 protected:
     bool eventFilter(QObject *object, QEvent *event) override;
 
 private:
+    void updatePixmap();
+
+    /// Shows the `view` part of the frame and requests it upstream.
+    void setView(QRectF const &view);
+
+    /// Maps a point of the label to normalized frame coordinates.
+    QPointF framePosition(QPoint const &position) const;
+
+private:
+    /// Created by `embeddedWidget`, headless graphs have none.
     QLabel *_label;
 
     std::shared_ptr<NodeData> _nodeData;
+
+    /// The displayed part of the frame.
+    QRectF _view;
+
+    QPoint _dragPosition;
+
+    /// Size of the displayed pixmap, centered in the label.
+    QSize _pixmapSize;
+
+    std::shared_ptr<ImageRequest const> _outRequest;
+
+    int _outputConnections;
+
+    bool _fullResolution;
 };
@@ -0,0 +1,54 @@
+#include "LookupTable.hpp"
+
+#include <QtCore/QtGlobal>
+
+LookupTable::LookupTable(int channels)
+    : _table(1, 256, CV_8UC(channels))
+{
+    for (int v = 0; v < 256; ++v) {
+        for (int c = 0; c < channels; ++c) {
+            set(c, v, v);
+        }
+    }
+}
+
+LookupTable LookupTable::fromFunction(int channels, std::function<int(int)> const &function)
+{
+    LookupTable table(channels);
+    int const colorChannels = channels == 4 ? 3 : channels;
+
+    for (int v = 0; v < 256; ++v) {
+        int const result = function(v);
+        for (int c = 0; c < colorChannels; ++c) {
+            table.set(c, v, result);
+        }
+    }
+
+    return table;
+}
+
+void LookupTable::set(int channel, int value, int result)
+{
+    _table.ptr()[value * channels() + channel] = static_cast<uchar>(qBound(0, result, 255));
+}
+
+LookupTable LookupTable::then(LookupTable const &next) const
+{
+    Q_ASSERT(next.channels() == channels());
+
+    LookupTable table(channels());
+
+    for (int v = 0; v < 256; ++v) {
+        for (int c = 0; c < channels(); ++c) {
+            table.set(c, v, next.at(c, at(c, v)));
+        }
+    }
+
+    return table;
+}
+
+void LookupTable::apply(cv::Mat const &input, cv::Mat &output) const
+{
+    // Keeps writing into the view when it has the size and type already.
+    cv::LUT(input, _table, output);
+}
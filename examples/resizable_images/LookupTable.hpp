@@ -0,0 +1,42 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <functional>
+
+/// A point operation on 8-bit channels as a table of 256 entries per channel.
+/**
+ * Tone adjustments are functions of the input byte, so a table computed
+ * once replaces the arithmetic and branches per pixel. Tables of
+ * successive operations compose into a single one (@see then), a run of
+ * such operations then costs one lookup per channel of every pixel.
+ */
+class LookupTable
+{
+public:
+    /// The identity on `channels` channels.
+    explicit LookupTable(int channels);
+
+    /**
+   * Maps the color channels through `function`. The fourth channel of
+   * four-channel formats is alpha and is kept.
+   */
+    static LookupTable fromFunction(int channels, std::function<int(int)> const &function);
+
+public:
+    int channels() const { return _table.channels(); }
+
+    uchar at(int channel, int value) const { return _table.ptr()[value * channels() + channel]; }
+
+    void set(int channel, int value, int result);
+
+    /// @returns the table applying this one and then `next`.
+    LookupTable then(LookupTable const &next) const;
+
+    /// Maps the pixels of `input` into `output`, which may be a view into a larger image.
+    void apply(cv::Mat const &input, cv::Mat &output) const;
+
+private:
+    /// 1x256 entries, the channels of an entry interleaved like the pixels.
+    cv::Mat _table;
+};
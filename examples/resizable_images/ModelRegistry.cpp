@@ -0,0 +1,37 @@
+#include "ModelRegistry.hpp"
+
+#include "BlendModel.hpp"
+#include "BrightnessContrastModel.hpp"
+#include "ConvolutionFilterModel.hpp"
+#include "EdgeDetectionModel.hpp"
+#include "GaussianBlurModel.hpp"
+#include "ImageLoaderModel.hpp"
+#include "ImageShowModel.hpp"
+#include "NoiseGenerationModel.hpp"
+#include "ThresholdModel.hpp"
+
+using QtNodes::NodeDelegateModelRegistry;
+
+std::shared_ptr<NodeDelegateModelRegistry> registerDataModels()
+{
+    auto ret = std::make_shared<NodeDelegateModelRegistry>();
+    ret->registerModel<ImageShowModel>();
+
+    ret->registerModel<ImageLoaderModel>();
+
+    ret->registerModel<BrightnessContrastModel>();
+
+    ret->registerModel<GaussianBlurModel>();
+
+    ret->registerModel<ThresholdModel>();
+
+    ret->registerModel<EdgeDetectionModel>();
+
+    ret->registerModel<BlendModel>();
+
+    ret->registerModel<NoiseGenerationModel>();
+
+    ret->registerModel<ConvolutionFilterModel>();
+
+    return ret;
+}
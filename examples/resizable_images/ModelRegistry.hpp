@@ -0,0 +1,8 @@
+#pragma once
+
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <memory>
+
+/// Registers the image processing models, shared by the editor and the batch runner.
+std::shared_ptr<QtNodes::NodeDelegateModelRegistry> registerDataModels();
@@ -0,0 +1,280 @@
+#include "NoiseEngine.hpp"
+
+#include <QtNodes/TaskScheduler>
+
+#include <QtCore/QStringList>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+/// Rows per task of `render`.
+int const bandSize = 16;
+
+float const diagonal = 0.70710678f;
+
+/// Unit gradients, picked by the low bits of a hash.
+float const gradientX[8] = {1.0f, -1.0f, 0.0f, 0.0f, diagonal, -diagonal, diagonal, -diagonal};
+float const gradientY[8] = {0.0f, 0.0f, 1.0f, -1.0f, diagonal, diagonal, -diagonal, -diagonal};
+
+/// The peak of 2D Perlin noise with unit gradients is 1 / sqrt(2).
+float const perlinNormalization = 1.41421356f;
+
+float const simplexNormalization = 99.2f;
+
+inline float fade(float t)
+{
+    return t * t * t * (t * (t * 6 - 15) + 10);
+}
+
+inline float lerp(float a, float b, float t)
+{
+    return a + t * (b - a);
+}
+
+inline int floorToInt(double v)
+{
+    return static_cast<int>(std::floor(v));
+}
+
+} // namespace
+
+NoiseEngine::Type NoiseEngine::type(QString const &name)
+{
+    int const index = QStringList{"Perlin", "Simplex", "Worley"}.indexOf(name);
+    return index < 0 ? Type::Perlin : static_cast<Type>(index);
+}
+
+NoiseEngine::NoiseEngine(quint32 seed)
+{
+    for (int i = 0; i < 256; ++i) {
+        _permutation[i] = i;
+    }
+
+    // Fisher-Yates with the raw output of mt19937, which the standard
+    // fixes, unlike std::shuffle and the distributions.
+    std::mt19937 generator(seed);
+    for (int i = 255; i > 0; --i) {
+        int const j = static_cast<int>(generator() % static_cast<unsigned int>(i + 1));
+        std::swap(_permutation[i], _permutation[j]);
+    }
+
+    for (int i = 0; i < 256; ++i) {
+        _permutation[256 + i] = _permutation[i];
+    }
+}
+
+float NoiseEngine::perlin(float x, float y) const
+{
+    float value = 0.0f;
+    perlinRow(x, y, 0.0, 1, 1.0f, &value);
+    return value;
+}
+
+float NoiseEngine::simplex(float x, float y) const
+{
+    float value = 0.0f;
+    simplexRow(x, y, 0.0, 1, 1.0f, &value);
+    return value;
+}
+
+float NoiseEngine::worley(float x, float y) const
+{
+    float value = 0.0f;
+    worleyRow(x, y, 0.0, 1, 1.0f, &value);
+    // The row holds the distance mapped to -1..1 for the fractal sum.
+    return (value + 1.0f) * 0.5f;
+}
+
+void NoiseEngine::perlinRow(double x, double y, double step, int count, float amplitude, float *row) const
+{
+    int const Y = floorToInt(y);
+    float const fy = static_cast<float>(y - Y);
+    float const v = fade(fy);
+
+    for (int begin = 0; begin < count;) {
+        int const X = floorToInt(x + begin * step);
+
+        // The samples up to the next lattice line share the corners.
+        int end = count;
+        if (step > 0.0)
+            end = std::min(count, std::max(begin + 1, static_cast<int>(std::ceil((X + 1 - x) / step))));
+
+        int const h00 = hash(X, Y) & 7;
+        int const h10 = hash(X + 1, Y) & 7;
+        int const h01 = hash(X, Y + 1) & 7;
+        int const h11 = hash(X + 1, Y + 1) & 7;
+
+        // The dot products are linear in the offset along the row.
+        float const g00x = gradientX[h00], c00 = gradientY[h00] * fy;
+        float const g10x = gradientX[h10], c10 = gradientY[h10] * fy;
+        float const g01x = gradientX[h01], c01 = gradientY[h01] * (fy - 1.0f);
+        float const g11x = gradientX[h11], c11 = gradientY[h11] * (fy - 1.0f);
+
+        double const origin = x - X;
+        float const scale = amplitude * perlinNormalization;
+
+        for (int i = begin; i < end; ++i) {
+            float const fx = static_cast<float>(origin + i * step);
+            float const u = fade(fx);
+
+            float const d00 = g00x * fx + c00;
+            float const d10 = g10x * (fx - 1.0f) + c10;
+            float const d01 = g01x * fx + c01;
+            float const d11 = g11x * (fx - 1.0f) + c11;
+
+            row[i] += scale * lerp(lerp(d00, d10, u), lerp(d01, d11, u), v);
+        }
+
+        begin = end;
+    }
+}
+
+void NoiseEngine::simplexRow(double x, double y, double step, int count, float amplitude, float *row) const
+{
+    // Skews the plane so the triangles of the lattice become half squares.
+    double const F2 = 0.5 * (std::sqrt(3.0) - 1.0);
+    double const G2 = (3.0 - std::sqrt(3.0)) / 6.0;
+
+    for (int k = 0; k < count; ++k) {
+        double const px = x + k * step;
+        double const s = (px + y) * F2;
+        int const i = floorToInt(px + s);
+        int const j = floorToInt(y + s);
+        double const t = (i + j) * G2;
+
+        float const x0 = static_cast<float>(px - (i - t));
+        float const y0 = static_cast<float>(y - (j - t));
+
+        // The triangle the sample lies in.
+        int const i1 = x0 > y0 ? 1 : 0;
+        int const j1 = 1 - i1;
+
+        float const g2 = static_cast<float>(G2);
+        float const x1 = x0 - i1 + g2;
+        float const y1 = y0 - j1 + g2;
+        float const x2 = x0 - 1.0f + 2.0f * g2;
+        float const y2 = y0 - 1.0f + 2.0f * g2;
+
+        float const corners[3][2] = {{x0, y0}, {x1, y1}, {x2, y2}};
+        int const hashes[3] = {hash(i, j) & 7, hash(i + i1, j + j1) & 7, hash(i + 1, j + 1) & 7};
+
+        float value = 0.0f;
+        for (int c = 0; c < 3; ++c) {
+            float const cx = corners[c][0];
+            float const cy = corners[c][1];
+            float falloff = 0.5f - cx * cx - cy * cy;
+            if (falloff > 0.0f) {
+                falloff *= falloff;
+                value += falloff * falloff * (gradientX[hashes[c]] * cx + gradientY[hashes[c]] * cy);
+            }
+        }
+
+        row[k] += amplitude * simplexNormalization * value;
+    }
+}
+
+void NoiseEngine::worleyRow(double x, double y, double step, int count, float amplitude, float *row) const
+{
+    int const Y = floorToInt(y);
+
+    for (int begin = 0; begin < count;) {
+        int const X = floorToInt(x + begin * step);
+
+        int end = count;
+        if (step > 0.0)
+            end = std::min(count, std::max(begin + 1, static_cast<int>(std::ceil((X + 1 - x) / step))));
+
+        // The feature points of the 3x3 cells around, relative to the cell.
+        float featureX[9];
+        float squaredY[9];
+        for (int n = 0; n < 9; ++n) {
+            int const cx = X + n % 3 - 1;
+            int const cy = Y + n / 3 - 1;
+            featureX[n] = (n % 3 - 1) + (hash(cx, cy) + 0.5f) / 256.0f;
+            float const dy = static_cast<float>(y - Y) - ((n / 3 - 1) + (hash(cx + 101, cy + 211) + 0.5f) / 256.0f);
+            squaredY[n] = dy * dy;
+        }
+
+        double const origin = x - X;
+
+        for (int i = begin; i < end; ++i) {
+            float const fx = static_cast<float>(origin + i * step);
+
+            float nearest = 8.0f;
+            for (int n = 0; n < 9; ++n) {
+                float const dx = fx - featureX[n];
+                nearest = std::min(nearest, dx * dx + squaredY[n]);
+            }
+
+            row[i] += amplitude * (2.0f * std::min(std::sqrt(nearest), 1.0f) - 1.0f);
+        }
+
+        begin = end;
+    }
+}
+
+void NoiseEngine::render(Type type,
+                         cv::Mat &output,
+                         cv::Point2d const &origin,
+                         double cellSize,
+                         int octaves,
+                         double persistence,
+                         CancelCheck const &cancelled) const
+{
+    CV_Assert(output.type() == CV_32FC1);
+
+    octaves = std::max(1, octaves);
+
+    float total = 0.0f;
+    float amplitude = 1.0f;
+    for (int o = 0; o < octaves; ++o) {
+        total += amplitude;
+        amplitude *= static_cast<float>(persistence);
+    }
+
+    auto const bands = static_cast<std::size_t>((output.rows + bandSize - 1) / bandSize);
+
+    QtNodes::TaskScheduler::globalInstance().parallelFor(bands, [&](std::size_t band) {
+        if (cancelled && cancelled())
+            return;
+
+        int const end = std::min(output.rows, static_cast<int>(band + 1) * bandSize);
+        for (int y = static_cast<int>(band) * bandSize; y < end; ++y) {
+            float *row = output.ptr<float>(y);
+            std::fill(row, row + output.cols, 0.0f);
+
+            float layerAmplitude = 1.0f;
+            double frequency = 1.0 / cellSize;
+
+            for (int o = 0; o < octaves; ++o) {
+                // The lattices of the octaves would all meet at the origin.
+                double const shift = o * 19.19;
+                double const sx = origin.x * frequency + shift;
+                double const sy = (origin.y + y) * frequency + shift;
+
+                switch (type) {
+                case Type::Perlin:
+                    perlinRow(sx, sy, frequency, output.cols, layerAmplitude, row);
+                    break;
+                case Type::Simplex:
+                    simplexRow(sx, sy, frequency, output.cols, layerAmplitude, row);
+                    break;
+                case Type::Worley:
+                    worleyRow(sx, sy, frequency, output.cols, layerAmplitude, row);
+                    break;
+                }
+
+                layerAmplitude *= static_cast<float>(persistence);
+                frequency *= 2.0;
+            }
+
+            float const scale = 0.5f / total;
+            for (int x = 0; x < output.cols; ++x) {
+                row[x] = std::min(1.0f, std::max(0.0f, row[x] * scale + 0.5f));
+            }
+        }
+    });
+}
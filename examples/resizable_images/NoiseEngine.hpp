@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QtGlobal>
+
+#include <opencv2/core.hpp>
+
+#include <array>
+#include <functional>
+
+/// Seeded 2D gradient and cellular noise.
+/**
+ * The permutation table is shuffled from the seed alone, so the same
+ * seed gives the same noise on every run and platform, and the noise of
+ * a parameter set can be memoized.
+ *
+ * `render` evaluates rows in parallel. Along a row the pixels between two
+ * lattice lines share their gradients (Perlin) or feature points (Worley),
+ * which are looked up once per cell; the inner loops over those pixels
+ * are plain arithmetic the compiler vectorizes.
+ */
+class NoiseEngine
+{
+public:
+    enum class Type
+    {
+        Perlin,
+        Simplex,
+        Worley,
+    };
+
+    using CancelCheck = std::function<bool()>;
+
+    /// @returns the type called `name`, `Perlin` for unknown names.
+    static Type type(QString const &name);
+
+    explicit NoiseEngine(quint32 seed = 0);
+
+public:
+    /// Classic gradient noise, about -1 to 1.
+    float perlin(float x, float y) const;
+
+    /// Gradient noise on a triangular lattice, about -1 to 1.
+    float simplex(float x, float y) const;
+
+    /// Distance to the nearest feature point, one per lattice cell, in cells.
+    float worley(float x, float y) const;
+
+    /**
+   * Fills the `CV_32FC1` `output` with the fractal sum of `octaves` layers
+   * of noise, normalized to 0..1. The pixel (x, y) samples the noise at
+   * `(origin + (x, y)) / cellSize`, every octave doubles the frequency and
+   * scales the amplitude by `persistence`. Stops early if cancelled.
+   */
+    void render(Type type,
+                cv::Mat &output,
+                cv::Point2d const &origin,
+                double cellSize,
+                int octaves,
+                double persistence,
+                CancelCheck const &cancelled = CancelCheck()) const;
+
+private:
+    int hash(int x, int y) const { return _permutation[_permutation[x & 255] + (y & 255)]; }
+
+    /// Adds `amplitude` times the noise of `count` samples `step` apart from `(x, y)` to `row`.
+    void perlinRow(double x, double y, double step, int count, float amplitude, float *row) const;
+
+    void simplexRow(double x, double y, double step, int count, float amplitude, float *row) const;
+
+    void worleyRow(double x, double y, double step, int count, float amplitude, float *row) const;
+
+private:
+    /// Two copies of a permutation of 0..255, indices need no wrapping.
+    std::array<int, 512> _permutation;
+};
@@ -1,14 +1,85 @@
 #include "NoiseGenerationModel.hpp"
-#include <QImage>
-#include <QPainter>
-#include <cmath>
-#include <cstdlib>
-#include <QRandomGenerator>
-#include <random>
+
+#include "ProxyPreview.hpp"
+
+#include <QtCore/QSignalBlocker>
 
 
 NoiseGenerationModel::NoiseGenerationModel()
+    : _kernel(std::make_shared<NoiseKernel const>())
+{
+    // Regenerates the noise in the resolution of the preview mode.
+    connect(&ProxyPreview::instance(), &ProxyPreview::interactiveChanged, this, &NoiseGenerationModel::generateNoise);
+
+    generateNoise();
+}
+
+QJsonObject NoiseGenerationModel::save() const
+{
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
+
+void NoiseGenerationModel::load(QJsonObject const& modelJson)
+{
+    setParameters(NoiseKernel::load(modelJson, _kernel->parameters()));
+}
+
+unsigned int NoiseGenerationModel::nPorts(QtNodes::PortType portType) const
+{
+    return (portType == QtNodes::PortType::Out) ? 1 : 0;
+}
+
+QtNodes::NodeDataType NoiseGenerationModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const
 {
+    return ImageData().type();
+}
+
+std::shared_ptr<QtNodes::NodeData> NoiseGenerationModel::outData(QtNodes::PortIndex)
+{
+    return _output;
+}
+
+void NoiseGenerationModel::inputsUpdated()
+{
+    // Called after a request the output did not cover.
+    generateNoise();
+}
+
+bool NoiseGenerationModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                                         QtNodes::PortIndex)
+{
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
+}
+
+QJsonObject NoiseGenerationModel::computationParameters() const
+{
+    QJsonObject parameters;
+    _kernel->save(parameters);
+    ImageRequest::save(request(), parameters);
+    return parameters;
+}
+
+bool NoiseGenerationModel::restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const& outputs)
+{
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d)
+        return false;
+
+    _output = d;
+    updatePreview();
+    return true;
+}
+
+QWidget* NoiseGenerationModel::embeddedWidget()
+{
+    if (_widget)
+        return _widget;
+
+    NoiseKernel::Parameters const& parameters = _kernel->parameters();
+
     _widget = new QWidget;
     _previewLabel = new QLabel("Noise Preview");
     _previewLabel->setMinimumSize(200, 200);
@@ -16,154 +87,136 @@ NoiseGenerationModel::NoiseGenerationModel()
 
     _noiseTypeCombo = new QComboBox;
     _noiseTypeCombo->addItems({"Perlin", "Simplex", "Worley"});
+    _noiseTypeCombo->setCurrentText(parameters.type);
 
     _scaleSlider = new QSlider(Qt::Horizontal);
     _scaleSlider->setRange(1, 100);
-    _scaleSlider->setValue(10);
+    _scaleSlider->setValue(parameters.scale);
 
     _octaveSlider = new QSlider(Qt::Horizontal);
     _octaveSlider->setRange(1, 8);
-    _octaveSlider->setValue(4);
+    _octaveSlider->setValue(parameters.octaves);
 
     _persistenceSlider = new QSlider(Qt::Horizontal);
     _persistenceSlider->setRange(0, 100);
-    _persistenceSlider->setValue(50);
+    _persistenceSlider->setValue(parameters.persistence);
 
     _displacementCheck = new QCheckBox("Displacement Map Output");
+    _displacementCheck->setChecked(parameters.displacement);
+
+    _resolutionCombo = new QComboBox;
+    for (int size : {256, 512, 1024, 2048, 4096})
+        _resolutionCombo->addItem(QString("%1 x %1").arg(size), size);
+    _resolutionCombo->setCurrentIndex(_resolutionCombo->findData(parameters.resolution));
+
+    _seedSpin = new QSpinBox;
+    _seedSpin->setRange(0, 99999);
+    _seedSpin->setValue(parameters.seed);
 
     auto* form = new QFormLayout;
     form->addRow("Noise Type:", _noiseTypeCombo);
     form->addRow("Scale:", _scaleSlider);
     form->addRow("Octaves:", _octaveSlider);
     form->addRow("Persistence:", _persistenceSlider);
+    form->addRow("Resolution:", _resolutionCombo);
+    form->addRow("Seed:", _seedSpin);
     form->addRow(_displacementCheck);
 
     auto* layout = new QVBoxLayout(_widget);
     layout->addLayout(form);
     layout->addWidget(_previewLabel);
 
-    connect(_noiseTypeCombo, &QComboBox::currentTextChanged, this, &NoiseGenerationModel::generateNoise);
-    connect(_scaleSlider, &QSlider::valueChanged, this, &NoiseGenerationModel::generateNoise);
-    connect(_octaveSlider, &QSlider::valueChanged, this, &NoiseGenerationModel::generateNoise);
-    connect(_persistenceSlider, &QSlider::valueChanged, this, &NoiseGenerationModel::generateNoise);
-    connect(_displacementCheck, &QCheckBox::toggled, this, &NoiseGenerationModel::generateNoise);
+    connect(_noiseTypeCombo, &QComboBox::currentTextChanged, this, &NoiseGenerationModel::onParametersEdited);
+    connect(_scaleSlider, &QSlider::valueChanged, this, &NoiseGenerationModel::onParametersEdited);
+    connect(_octaveSlider, &QSlider::valueChanged, this, &NoiseGenerationModel::onParametersEdited);
+    connect(_persistenceSlider, &QSlider::valueChanged, this, &NoiseGenerationModel::onParametersEdited);
+    connect(_displacementCheck, &QCheckBox::toggled, this, &NoiseGenerationModel::onParametersEdited);
+    connect(_resolutionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &NoiseGenerationModel::onParametersEdited);
+    connect(_seedSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &NoiseGenerationModel::onParametersEdited);
 
-    generateNoise();
-}
+    ProxyPreview::instance().trackSlider(_scaleSlider);
+    ProxyPreview::instance().trackSlider(_octaveSlider);
+    ProxyPreview::instance().trackSlider(_persistenceSlider);
 
-unsigned int NoiseGenerationModel::nPorts(QtNodes::PortType portType) const
-{
-    return (portType == QtNodes::PortType::Out) ? 1 : 0;
-}
+    updatePreview();
 
-QtNodes::NodeDataType NoiseGenerationModel::dataType(QtNodes::PortType, QtNodes::PortIndex) const
-{
-    return PixmapData().type();
+    return _widget;
 }
 
-std::shared_ptr<QtNodes::NodeData> NoiseGenerationModel::outData(QtNodes::PortIndex)
-{
-    return std::make_shared<PixmapData>(_pixmap);
-}
-
-void NoiseGenerationModel::generateNoise()
+void NoiseGenerationModel::setParameters(NoiseKernel::Parameters const& parameters)
 {
-    const int width = 256;
-    const int height = 256;
-    const QString type = _noiseTypeCombo->currentText();
-
-    if (type == "Perlin") {
-        float scale = _scaleSlider->value() / 10.0f;
-        int octaves = _octaveSlider->value();
-        float persistence = _persistenceSlider->value() / 100.0f;
-        QImage img = generatePerlinNoise(width, height, scale, octaves, persistence);
-        _pixmap = QPixmap::fromImage(img);
-    } else {
-        QImage img = generateMockNoise(width, height);
-        _pixmap = QPixmap::fromImage(img);
+    _kernel = std::make_shared<NoiseKernel const>(parameters);
+
+    if (_widget) {
+        QSignalBlocker const typeBlocker(_noiseTypeCombo);
+        QSignalBlocker const scaleBlocker(_scaleSlider);
+        QSignalBlocker const octaveBlocker(_octaveSlider);
+        QSignalBlocker const persistenceBlocker(_persistenceSlider);
+        QSignalBlocker const displacementBlocker(_displacementCheck);
+        QSignalBlocker const resolutionBlocker(_resolutionCombo);
+        QSignalBlocker const seedBlocker(_seedSpin);
+
+        _noiseTypeCombo->setCurrentText(parameters.type);
+        _scaleSlider->setValue(parameters.scale);
+        _octaveSlider->setValue(parameters.octaves);
+        _persistenceSlider->setValue(parameters.persistence);
+        _displacementCheck->setChecked(parameters.displacement);
+        _resolutionCombo->setCurrentIndex(_resolutionCombo->findData(parameters.resolution));
+        _seedSpin->setValue(parameters.seed);
     }
 
-    _previewLabel->setPixmap(_pixmap.scaled(_previewLabel->size(), Qt::KeepAspectRatio));
-    Q_EMIT dataUpdated(0);
+    generateNoise();
 }
 
-QImage NoiseGenerationModel::generateMockNoise(int width, int height)
+void NoiseGenerationModel::onParametersEdited()
 {
-    QImage img(width, height, QImage::Format_Grayscale8);
-    for (int y = 0; y < height; ++y)
-        for (int x = 0; x < width; ++x)
-           img.setPixel(x, y, qRgb(QRandomGenerator::global()->bounded(256), 0, 0));
-
-    return img;
+    NoiseKernel::Parameters parameters;
+    parameters.type = _noiseTypeCombo->currentText();
+    parameters.scale = _scaleSlider->value();
+    parameters.octaves = _octaveSlider->value();
+    parameters.persistence = _persistenceSlider->value();
+    parameters.displacement = _displacementCheck->isChecked();
+    // Resolutions loaded from a file may be missing from the list.
+    if (_resolutionCombo->currentIndex() >= 0)
+        parameters.resolution = _resolutionCombo->currentData().toInt();
+    else
+        parameters.resolution = _kernel->parameters().resolution;
+    parameters.seed = _seedSpin->value();
+    setParameters(parameters);
 }
 
-// Basic Perlin noise function
-static float fade(float t) {
-    return t * t * t * (t * (t * 6 - 15) + 10);
-}
-
-static float lerp(float a, float b, float t) {
-    return a + t * (b - a);
-}
-
-static float grad(int hash, float x, float y) {
-    int h = hash & 3;
-    float u = h < 2 ? x : y;
-    float v = h < 2 ? y : x;
-    return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+std::shared_ptr<ImageRequest const> NoiseGenerationModel::request() const
+{
+    // The preview mode asks for a frame of a lower density.
+    double const factor = ProxyPreview::instance().currentFactor();
+    if (factor >= 1.0)
+        return _outRequest;
+
+    QRectF const region = _outRequest ? _outRequest->region() : QRectF(0, 0, 1, 1);
+    double const density = _kernel->frameSize() * factor;
+    return std::make_shared<ImageRequest>(region, QSizeF(density, density));
 }
 
-QImage NoiseGenerationModel::generatePerlinNoise(int width, int height, float scale, int octaves, float persistence)
+void NoiseGenerationModel::generateNoise()
 {
-    QImage img(width, height, QImage::Format_Grayscale8);
-    std::vector<int> p(512);
-    for (int i = 0; i < 256; ++i) p[i] = i;
-    // std::random_shuffle(p.begin(), p.begin() + 256);
-    std::shuffle(p.begin(), p.begin() + 256, std::mt19937{std::random_device{}()});
-
-    for (int i = 0; i < 256; ++i) p[256 + i] = p[i];
+    std::shared_ptr<NoiseKernel const> const kernel = _kernel;
+    std::shared_ptr<ImageRequest const> const request = this->request();
 
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            float xf = x / scale;
-            float yf = y / scale;
-            float amplitude = 1.0f;
-            float frequency = 1.0f;
-            float noise = 0.0f;
+    runComputation([this, kernel, request]() {
+        std::shared_ptr<ImageData> const result
+            = kernel->compute(ImageKernel::Inputs(), request, []() { return computationCancelled(); });
 
-            for (int o = 0; o < octaves; ++o) {
-                int X = (int)floor(xf * frequency) & 255;
-                int Y = (int)floor(yf * frequency) & 255;
+        return [this, result]() {
+            _output = result;
 
-                float x0 = xf * frequency - floor(xf * frequency);
-                float y0 = yf * frequency - floor(yf * frequency);
-
-                float u = fade(x0);
-                float v = fade(y0);
-
-                int aa = p[p[X] + Y];
-                int ab = p[p[X] + Y + 1];
-                int ba = p[p[X + 1] + Y];
-                int bb = p[p[X + 1] + Y + 1];
-
-                float grad00 = grad(aa, x0, y0);
-                float grad01 = grad(ab, x0, y0 - 1);
-                float grad10 = grad(ba, x0 - 1, y0);
-                float grad11 = grad(bb, x0 - 1, y0 - 1);
-
-                float x1 = lerp(grad00, grad10, u);
-                float x2 = lerp(grad01, grad11, u);
-                float result = lerp(x1, x2, v);
-
-                noise += result * amplitude;
-                amplitude *= persistence;
-                frequency *= 2.0f;
-            }
-
-            int color = static_cast<int>((noise + 1.0f) * 127.5f);
-            img.setPixel(x, y, qRgb(color, color, color));
-        }
-    }
+            updatePreview();
+            Q_EMIT dataUpdated(0);
+        };
+    });
+}
 
-    return img;
+void NoiseGenerationModel::updatePreview()
+{
+    if (_previewLabel && _output)
+        _previewLabel->setPixmap(_output->toPixmap(_previewLabel->size()));
 }
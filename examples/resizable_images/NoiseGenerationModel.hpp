@@ -5,10 +5,13 @@
 #include <QtWidgets/QComboBox>
 #include <QtWidgets/QSlider>
 #include <QtWidgets/QCheckBox>
+#include <QtWidgets/QSpinBox>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QFormLayout>
 
-#include "PixmapData.hpp"
+#include "ImageData.hpp"
+#include "ImageRequest.hpp"
+#include "NoiseKernel.hpp"
 
 class NoiseGenerationModel : public QtNodes::NodeDelegateModel
 {
@@ -22,23 +25,48 @@ public:
     QString name() const override { return "NoiseGenerationModel"; }
     QString modelName() const  { return "Noise Generator"; }
 
+    QJsonObject save() const override;
+    void load(QJsonObject const& modelJson) override;
+
     unsigned int nPorts(QtNodes::PortType portType) const override;
     QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override;
     std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex port) override;
     void setInData(std::shared_ptr<QtNodes::NodeData>, QtNodes::PortIndex) override {}
 
-    QWidget* embeddedWidget() override { return _widget; }
+    void inputsUpdated() override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       QtNodes::PortIndex portIndex) override;
+
+    /// The noise is deterministic, equal parameters give equal images.
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const& outputs) override;
+
+    QWidget* embeddedWidget() override;
     bool resizable() const override { return true; }
 
+    std::shared_ptr<NoiseKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and regenerates the noise.
+    void setParameters(NoiseKernel::Parameters const& parameters);
+
 private Q_SLOTS:
     void generateNoise();
 
+    /// Takes the parameters from the widgets.
+    void onParametersEdited();
+
 private:
     void updatePreview();
-    QImage generatePerlinNoise(int width, int height, float scale, int octaves, float persistence);
-    QImage generateMockNoise(int width, int height); // for Simplex/Worley
+
+    /// The requested part of the frame, in the density of the preview mode while interactive.
+    std::shared_ptr<ImageRequest const> request() const;
 
 private:
+    // Created by `embeddedWidget`, headless graphs have none.
     QWidget* _widget = nullptr;
     QLabel* _previewLabel = nullptr;
 
@@ -47,6 +75,12 @@ private:
     QSlider* _octaveSlider = nullptr;
     QSlider* _persistenceSlider = nullptr;
     QCheckBox* _displacementCheck = nullptr;
+    QComboBox* _resolutionCombo = nullptr;
+    QSpinBox* _seedSpin = nullptr;
+
+    std::shared_ptr<NoiseKernel const> _kernel;
+
+    std::shared_ptr<ImageData> _output;
 
-    QPixmap _pixmap;
+    std::shared_ptr<ImageRequest const> _outRequest;
 };
@@ -0,0 +1,103 @@
+#include "NoiseKernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+NoiseKernel::NoiseKernel(Parameters const &parameters)
+    : _parameters(parameters)
+    , _engine(static_cast<quint32>(parameters.seed))
+{
+    _parameters.resolution = std::max(1, _parameters.resolution);
+}
+
+NoiseKernel::Parameters NoiseKernel::load(QJsonObject const &json, Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.type = json["type"].toString(defaults.type);
+    parameters.scale = json["scale"].toInt(defaults.scale);
+    parameters.octaves = json["octaves"].toInt(defaults.octaves);
+    parameters.persistence = json["persistence"].toInt(defaults.persistence);
+    parameters.displacement = json["displacement"].toBool(defaults.displacement);
+    parameters.resolution = json["resolution"].toInt(defaults.resolution);
+    parameters.seed = json["seed"].toInt(defaults.seed);
+    return parameters;
+}
+
+std::shared_ptr<ImageData> NoiseKernel::compute(Inputs const &,
+                                                std::shared_ptr<ImageRequest const> const &request,
+                                                CancelCheck const &cancelled) const
+{
+    // The noise features keep their size relative to the image.
+    double factor = 1.0;
+    if (request && !request->density().isEmpty()) {
+        factor = std::min(1.0,
+                          std::max(request->density().width(), request->density().height())
+                              / frameSize());
+    }
+
+    int const size = std::max(1, static_cast<int>(frameSize() * factor));
+
+    QRectF region(0, 0, 1, 1);
+    if (request && request->region().intersects(region))
+        region = request->region() & region;
+
+    int const left = static_cast<int>(std::floor(region.left() * size));
+    int const top = static_cast<int>(std::floor(region.top() * size));
+    int const right = static_cast<int>(std::ceil(region.right() * size));
+    int const bottom = static_cast<int>(std::ceil(region.bottom() * size));
+    cv::Rect const area = cv::Rect(left, top, right - left, bottom - top) & cv::Rect(0, 0, size, size);
+
+    double const cellSize = std::max(0.01, _parameters.scale / 10.0 * size / 256.0);
+    double const persistence = _parameters.persistence / 100.0;
+    NoiseEngine::Type const type = NoiseEngine::type(_parameters.type);
+
+    // The displacement noises are far apart in the plane, they do not correlate.
+    std::vector<cv::Point2d> origins{cv::Point2d(area.x, area.y)};
+    if (_parameters.displacement)
+        origins.push_back(cv::Point2d(area.x + 7919.0 * cellSize, area.y + 6151.0 * cellSize));
+
+    std::vector<cv::Mat> channels;
+    for (cv::Point2d const &origin : origins) {
+        cv::Mat field(area.size(), CV_32FC1);
+        _engine.render(type, field, origin, cellSize, _parameters.octaves, persistence, cancelled);
+
+        if (cancelled && cancelled())
+            return nullptr;
+
+        cv::Mat bytes;
+        field.convertTo(bytes, CV_8U, 255.0);
+        channels.push_back(bytes);
+    }
+
+    cv::Mat pixels;
+    ImageBuffer::Format format = ImageBuffer::Format::Gray8;
+
+    if (_parameters.displacement) {
+        // Blue, green (y), red (x).
+        channels.insert(channels.begin(), cv::Mat::zeros(area.size(), CV_8UC1));
+        std::swap(channels[1], channels[2]);
+        cv::merge(channels, pixels);
+        format = ImageBuffer::Format::BGR888;
+    } else {
+        pixels = channels.front();
+    }
+
+    QRectF const generated(area.x / static_cast<double>(size),
+                           area.y / static_cast<double>(size),
+                           area.width / static_cast<double>(size),
+                           area.height / static_cast<double>(size));
+
+    return std::make_shared<ImageData>(ImageBuffer::fromMat(pixels, format), generated);
+}
+
+void NoiseKernel::save(QJsonObject &json) const
+{
+    json["type"] = _parameters.type;
+    json["scale"] = _parameters.scale;
+    json["octaves"] = _parameters.octaves;
+    json["persistence"] = _parameters.persistence;
+    json["displacement"] = _parameters.displacement;
+    json["resolution"] = _parameters.resolution;
+    json["seed"] = _parameters.seed;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ImageKernel.hpp"
+#include "NoiseEngine.hpp"
+
+#include <QtCore/QString>
+
+/// Generates a noise image, @see NoiseEngine.
+/**
+ * The frame is `frameSize()` pixels wide and high. Requests of a lower
+ * density, e.g. in the proxy preview, get a smaller image with the
+ * features scaled along, so the noise keeps its look relative to the
+ * frame. Only the requested region is generated.
+ */
+class NoiseKernel : public ImageKernel
+{
+public:
+    struct Parameters
+    {
+        /// "Perlin", "Simplex" or "Worley".
+        QString type = "Perlin";
+
+        /// Feature size in tenths of a pixel of a 256 px frame, 1 to 100.
+        int scale = 10;
+
+        int octaves = 4;
+
+        /// Amplitude ratio of successive octaves in percent.
+        int persistence = 50;
+
+        /// Two independent noises in the red and green channels, for displacing x and y.
+        bool displacement = false;
+
+        /// Edge length of the frame in pixels.
+        int resolution = 256;
+
+        /// Picks the permutation of the lattice, equal seeds give equal noise.
+        int seed = 0;
+    };
+
+    explicit NoiseKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+    /// Edge length of the full-resolution frame in pixels.
+    int frameSize() const { return _parameters.resolution; }
+
+public:
+    /// Needs no inputs.
+    std::shared_ptr<ImageData> compute(Inputs const &inputs,
+                                       std::shared_ptr<ImageRequest const> const &request,
+                                       CancelCheck const &cancelled) const override;
+
+    void save(QJsonObject &json) const override;
+
+private:
+    Parameters _parameters;
+
+    NoiseEngine _engine;
+};
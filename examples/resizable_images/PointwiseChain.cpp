@@ -0,0 +1,119 @@
+#include "PointwiseChain.hpp"
+
+#include "PointwiseKernel.hpp"
+#include "TileEngine.hpp"
+
+PointwiseChain::PointwiseChain(std::shared_ptr<ImageBuffer const> source, cv::Rect const &area)
+    : _source(std::move(source))
+    , _area(area)
+{}
+
+ImageBuffer::Format PointwiseChain::format() const
+{
+    return _stages.empty() ? _source->format() : _stages.back().outputFormat;
+}
+
+std::shared_ptr<PointwiseChain const> PointwiseChain::cropped(cv::Rect const &area) const
+{
+    auto chain = std::make_shared<PointwiseChain>(*this);
+
+    chain->_area = cv::Rect(_area.tl() + area.tl(), area.size());
+
+    for (Stage &stage : chain->_stages) {
+        for (Extra &extra : stage.extras) {
+            extra.area = cv::Rect(extra.area.tl() + area.tl(), area.size());
+        }
+    }
+
+    return chain;
+}
+
+std::shared_ptr<PointwiseChain const> PointwiseChain::appended(
+    std::shared_ptr<PointwiseKernel const> kernel, std::vector<Extra> extras) const
+{
+    auto chain = std::make_shared<PointwiseChain>(*this);
+
+    Stage stage;
+    stage.inputFormat = kernel->inputFormat(format());
+    stage.outputFormat = kernel->outputFormat(stage.inputFormat);
+    stage.lookupTable = kernel->lookupTable(stage.inputFormat);
+
+    // A table reading the output of a table without conversion in between joins it.
+    if (stage.lookupTable && !chain->_stages.empty()) {
+        Stage &last = chain->_stages.back();
+
+        if (last.lookupTable && last.outputFormat == stage.inputFormat) {
+            last.lookupTable = std::make_shared<LookupTable const>(
+                last.lookupTable->then(*stage.lookupTable));
+            last.kernels.push_back(std::move(kernel));
+            last.outputFormat = stage.outputFormat;
+            return chain;
+        }
+    }
+
+    stage.kernels.push_back(std::move(kernel));
+    stage.extras = std::move(extras);
+
+    chain->_stages.push_back(std::move(stage));
+
+    return chain;
+}
+
+std::shared_ptr<ImageBuffer const> PointwiseChain::run(ImageKernel::CancelCheck const &cancelled) const
+{
+    ImageBuffer::Format const outputFormat = format();
+
+    cv::Mat const result = TileEngine::process(_source->mat(), _area,
+        CV_8UC(ImageBuffer::channels(outputFormat)), 0,
+        [&](cv::Mat const &source, cv::Rect const &tile, cv::Mat &destination) {
+            if (cancelled && cancelled())
+                return;
+
+            // The destination is a view into the output, which covers the area of the chain.
+            cv::Size wholeSize;
+            cv::Point offset;
+            destination.locateROI(wholeSize, offset);
+            cv::Rect const position(offset, destination.size());
+
+            cv::Mat current = source(tile);
+            ImageBuffer::Format currentFormat = _source->format();
+
+            if (_stages.empty())
+                current.copyTo(destination);
+
+            for (std::size_t i = 0; i < _stages.size(); ++i) {
+                Stage const &stage = _stages[i];
+
+                if (stage.inputFormat != currentFormat) {
+                    cv::Mat converted;
+                    ImageBuffer::convert(current, currentFormat, converted, stage.inputFormat);
+                    current = converted;
+                }
+
+                std::vector<cv::Mat> extras;
+                for (Extra const &extra : stage.extras) {
+                    extras.push_back(extra.buffer->mat()(extra.area)(position));
+                }
+
+                // The last kernel writes straight into the output.
+                cv::Mat output = i + 1 == _stages.size()
+                                     ? destination
+                                     : cv::Mat(current.size(),
+                                               CV_8UC(ImageBuffer::channels(stage.outputFormat)));
+
+                // A kernel alone may have a faster path than its table.
+                if (stage.kernels.size() > 1)
+                    stage.lookupTable->apply(current, output);
+                else
+                    stage.kernels.front()->apply(current, extras, output);
+
+                current = output;
+                currentFormat = stage.outputFormat;
+            }
+        });
+
+    if (cancelled && cancelled())
+        return nullptr;
+
+    return ImageBuffer::fromMat(result, outputFormat);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ImageBuffer.hpp"
+#include "ImageKernel.hpp"
+#include "LookupTable.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class PointwiseKernel;
+
+/// A run of pointwise kernels applied to an image in a single pass.
+/**
+ * The chain starts from the pixels `area` of a source buffer. `run`
+ * applies all the kernels tile by tile, so the intermediate results of a
+ * tile stay in the cache and the frame is read and written once, however
+ * long the run. Chains are immutable, `appended` and `cropped` return new
+ * ones.
+ *
+ * Kernels appended as lookup tables to a table stage are composed into
+ * it, so a run of tone adjustments costs one table lookup per pixel.
+ */
+class PointwiseChain
+{
+public:
+    /// A further input of a kernel, pixels aligned with the output of the chain.
+    struct Extra
+    {
+        std::shared_ptr<ImageBuffer const> buffer;
+
+        cv::Rect area;
+    };
+
+    /// A chain without kernels, its output are the pixels `area` of `source`.
+    PointwiseChain(std::shared_ptr<ImageBuffer const> source, cv::Rect const &area);
+
+public:
+    cv::Size size() const { return _area.size(); }
+
+    /// The format of the output.
+    ImageBuffer::Format format() const;
+
+    /// The number of passes over a tile, composed tables count once.
+    std::size_t length() const { return _stages.size(); }
+
+    /// @returns the chain computing the pixels `area` of the output only.
+    std::shared_ptr<PointwiseChain const> cropped(cv::Rect const &area) const;
+
+    /// @returns the chain followed by `kernel`, reading `extras` besides the output of the chain.
+    std::shared_ptr<PointwiseChain const> appended(std::shared_ptr<PointwiseKernel const> kernel,
+                                                   std::vector<Extra> extras) const;
+
+    /// Computes the output, null if the computation was cancelled.
+    std::shared_ptr<ImageBuffer const> run(
+        ImageKernel::CancelCheck const &cancelled = ImageKernel::CancelCheck()) const;
+
+private:
+    struct Stage
+    {
+        /// Several kernels if their tables were composed.
+        std::vector<std::shared_ptr<PointwiseKernel const>> kernels;
+
+        std::vector<Extra> extras;
+
+        /// The composed table of the kernels, null if the stage is not one.
+        std::shared_ptr<LookupTable const> lookupTable;
+
+        ImageBuffer::Format inputFormat;
+
+        ImageBuffer::Format outputFormat;
+    };
+
+    std::shared_ptr<ImageBuffer const> _source;
+
+    cv::Rect _area;
+
+    std::vector<Stage> _stages;
+};
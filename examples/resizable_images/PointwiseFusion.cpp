@@ -0,0 +1,59 @@
+#include "PointwiseFusion.hpp"
+
+#include <QtNodes/NodeDelegateModel>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModel;
+using QtNodes::NodeId;
+using QtNodes::PortType;
+
+namespace {
+
+PointwiseModel *pointwiseModel(DataFlowGraphModel &graph, NodeId nodeId)
+{
+    return dynamic_cast<PointwiseModel *>(graph.delegateModel<NodeDelegateModel>(nodeId));
+}
+
+} // namespace
+
+PointwiseFusion::PointwiseFusion(DataFlowGraphModel &graph)
+    : _graph(graph)
+{
+    connect(&_graph, &DataFlowGraphModel::nodeCreated, this, &PointwiseFusion::plan);
+
+    connect(&_graph, &DataFlowGraphModel::connectionCreated, this, [this](ConnectionId const id) {
+        plan(id.outNodeId);
+    });
+
+    connect(&_graph, &DataFlowGraphModel::connectionDeleted, this, [this](ConnectionId const id) {
+        plan(id.outNodeId);
+    });
+
+    update();
+}
+
+void PointwiseFusion::update()
+{
+    for (NodeId const nodeId : _graph.allNodeIds()) {
+        plan(nodeId);
+    }
+}
+
+void PointwiseFusion::plan(NodeId nodeId)
+{
+    PointwiseModel *model = pointwiseModel(_graph, nodeId);
+    if (!model)
+        return;
+
+    bool deferred = false;
+
+    // The pointwise nodes have a single output port.
+    auto const consumers = _graph.connections(nodeId, PortType::Out, 0);
+
+    // Further inputs, like the second image of a blend, are read as pixels.
+    if (consumers.size() == 1 && consumers.begin()->inPortIndex == 0)
+        deferred = pointwiseModel(_graph, consumers.begin()->inNodeId) != nullptr;
+
+    model->setDeferredOutput(deferred);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QtCore/QObject>
+
+#include <QtNodes/DataFlowGraphModel>
+
+/// Implemented by the models of pointwise kernels, @see PointwiseFusion.
+class PointwiseModel
+{
+public:
+    virtual ~PointwiseModel() = default;
+
+    /**
+   * Lets the model pass its output on deferred instead of computing it,
+   * @see PointwiseKernel::defer. Models showing a preview of the output
+   * compute it anyway.
+   */
+    virtual void setDeferredOutput(bool deferred) = 0;
+};
+
+/// Fuses runs of pointwise nodes of a graph into single passes.
+/**
+ * A PointwiseModel whose output feeds the first input of exactly one
+ * other PointwiseModel defers its output: the consumer extends the chain of kernels and runs
+ * the whole run in one pass over the frame. Outputs feeding a branch or
+ * a node that is not pointwise are computed, so every intermediate image
+ * somebody looks at exists once.
+ *
+ * The plan follows the connections of the graph.
+ */
+class PointwiseFusion : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PointwiseFusion(QtNodes::DataFlowGraphModel &graph);
+
+public Q_SLOTS:
+    /// Plans the whole graph again.
+    void update();
+
+private:
+    /// Decides if the output of `nodeId` is deferred.
+    void plan(QtNodes::NodeId nodeId);
+
+private:
+    QtNodes::DataFlowGraphModel &_graph;
+};
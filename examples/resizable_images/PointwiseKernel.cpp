@@ -0,0 +1,68 @@
+#include "PointwiseKernel.hpp"
+
+#include "PointwiseChain.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+std::shared_ptr<ImageData> PointwiseKernel::compute(Inputs const &inputs,
+                                                    std::shared_ptr<ImageRequest const> const &request,
+                                                    CancelCheck const &cancelled) const
+{
+    std::shared_ptr<ImageData> const deferred = defer(inputs, request);
+    if (!deferred)
+        return nullptr;
+
+    std::shared_ptr<ImageBuffer const> const buffer = deferred->chain()->run(cancelled);
+    if (!buffer)
+        return nullptr;
+
+    return std::make_shared<ImageData>(buffer, deferred->region());
+}
+
+std::shared_ptr<ImageData> PointwiseKernel::defer(Inputs const &inputs,
+                                                  std::shared_ptr<ImageRequest const> const &request) const
+{
+    for (auto const &input : inputs) {
+        if (!input || input->isNull())
+            return nullptr;
+    }
+
+    if (inputs.empty())
+        return nullptr;
+
+    ImageData const &input = *inputs[0];
+    cv::Rect const area = input.area(request);
+    QRectF const region = input.regionOf(area);
+
+    std::shared_ptr<PointwiseChain const> const chain
+        = input.isDeferred() ? input.chain()->cropped(area)
+                             : std::make_shared<PointwiseChain const>(input.buffer(), area);
+
+    std::vector<PointwiseChain::Extra> extras;
+    ImageBuffer::Format const format = extraFormat();
+
+    for (std::size_t i = 1; i < inputs.size(); ++i) {
+        // The part of the further input lying under the region of the first one.
+        ImageData const &extraInput = *inputs[i];
+        cv::Rect const extraArea = extraInput.area(std::make_shared<ImageRequest>(region, QSizeF()));
+        std::shared_ptr<ImageBuffer const> const buffer
+            = extraInput.buffer()->converted(format);
+
+        PointwiseChain::Extra extra;
+
+        if (extraArea.size() == area.size()) {
+            extra.buffer = buffer;
+            extra.area = extraArea;
+        } else {
+            cv::Mat resized;
+            cv::resize(buffer->mat()(extraArea), resized, area.size());
+            extra.buffer = ImageBuffer::fromMat(resized, format);
+            extra.area = cv::Rect(cv::Point(0, 0), area.size());
+        }
+
+        extras.push_back(extra);
+    }
+
+    return std::make_shared<ImageData>(chain->appended(shared_from_this(), std::move(extras)),
+                                       region);
+}
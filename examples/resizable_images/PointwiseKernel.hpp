@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ImageKernel.hpp"
+#include "LookupTable.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <vector>
+
+/// A kernel computing every output pixel from the input pixels at the same position.
+/**
+ * Subclasses only implement `apply` on a tile. The output of a pointwise
+ * kernel may be deferred (@see defer): the next pointwise kernel appends
+ * itself to the PointwiseChain of its input instead of reading pixels,
+ * and a whole run of kernels costs a single pass over the frame.
+ *
+ * Inputs after the first are the further inputs of `apply`, resized to
+ * the region of the first one like the second image of a blend.
+ *
+ * Kernels that are functions of the input byte of every channel also
+ * expose themselves as a LookupTable. Adjacent tables of a chain are
+ * composed and applied as one.
+ */
+class PointwiseKernel
+    : public ImageKernel
+    , public std::enable_shared_from_this<PointwiseKernel>
+{
+public:
+    /// The format `apply` reads the first input in, given the format of the data.
+    virtual ImageBuffer::Format inputFormat(ImageBuffer::Format format) const { return format; }
+
+    /// The format `apply` writes, given the result of `inputFormat`.
+    virtual ImageBuffer::Format outputFormat(ImageBuffer::Format format) const { return format; }
+
+    /// The format `apply` reads the further inputs in.
+    virtual ImageBuffer::Format extraFormat() const { return ImageBuffer::Format::BGR888; }
+
+    /**
+   * The kernel as a table for input in the given format, the result of
+   * `inputFormat`, or null if it is none. Table kernels have no further
+   * inputs and keep the format. The table replaces `apply` once composed
+   * with others.
+   */
+    virtual std::shared_ptr<LookupTable const> lookupTable(ImageBuffer::Format) const
+    {
+        return nullptr;
+    }
+
+    /**
+   * Fills `output`, allocated in `outputFormat` and of the size of the
+   * tile, from the pixels of `input` and of the further inputs `extras` in
+   * `extraFormat`. Runs on worker threads, on many tiles at once.
+   */
+    virtual void apply(cv::Mat const &input,
+                       std::vector<cv::Mat> const &extras,
+                       cv::Mat &output) const
+        = 0;
+
+public:
+    /// Runs the chain of the deferred output.
+    std::shared_ptr<ImageData> compute(Inputs const &inputs,
+                                       std::shared_ptr<ImageRequest const> const &request,
+                                       CancelCheck const &cancelled) const override;
+
+    /**
+   * @returns the output for `request` as deferred ImageData, extending the
+   * chain of a deferred first input. Only the further inputs are read.
+   */
+    std::shared_ptr<ImageData> defer(Inputs const &inputs,
+                                     std::shared_ptr<ImageRequest const> const &request) const;
+};
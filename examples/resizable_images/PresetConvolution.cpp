@@ -0,0 +1,273 @@
+#include "PresetConvolution.hpp"
+
+#include "TileEngine.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+
+using namespace Presets;
+
+// The coefficients are indexed at runtime as well, by `compiledMatrix`.
+constexpr int Sharpen3::coefficients[];
+constexpr int Emboss3::coefficients[];
+constexpr int EdgeEnhance3::coefficients[];
+constexpr int Sharpen5::coefficients[];
+constexpr int Emboss5::coefficients[];
+constexpr int EdgeEnhance5::coefficients[];
+
+namespace {
+
+/// A multiplication by a constant, none for the taps of zero weight.
+template<int Coefficient>
+struct Tap
+{
+    template<typename T>
+    static int weigh(T sample)
+    {
+        return Coefficient * static_cast<int>(sample);
+    }
+};
+
+template<>
+struct Tap<0>
+{
+    template<typename T>
+    static int weigh(T)
+    {
+        return 0;
+    }
+};
+
+/**
+ * The weighted sum of the taps up to `Index` in row-major order, unrolled
+ * by the recursion. `rows` are the padded rows under the kernel and
+ * `offset` the sample of the leftmost tap in them, the taps of a row are
+ * `Channels` samples apart.
+ */
+template<typename Preset, int Channels, int Index = Preset::size * Preset::size - 1>
+struct Taps
+{
+    template<typename T>
+    static int sum(T const *const *rows, int offset)
+    {
+        return Tap<Preset::coefficients[Index]>::weigh(
+                   rows[Index / Preset::size][offset + (Index % Preset::size) * Channels])
+               + Taps<Preset, Channels, Index - 1>::sum(rows, offset);
+    }
+};
+
+template<typename Preset, int Channels>
+struct Taps<Preset, Channels, -1>
+{
+    template<typename T>
+    static int sum(T const *const *, int)
+    {
+        return 0;
+    }
+};
+
+/// Fills `destination` from `padded`, which has the half kernel size around it.
+template<typename Preset, int Channels, typename T>
+void convolveRows(cv::Mat const &padded, cv::Mat &destination)
+{
+    int const rounding = (1 << Preset::shift) >> 1;
+    int const samples = destination.cols * Channels;
+
+    T const *rows[Preset::size];
+
+    for (int y = 0; y < destination.rows; ++y) {
+        for (int k = 0; k < Preset::size; ++k) {
+            rows[k] = padded.ptr<T>(y + k);
+        }
+
+        T *output = destination.ptr<T>(y);
+
+        // The channels are interleaved, every sample is a pixel of its own channel.
+        for (int offset = 0; offset < samples; ++offset) {
+            int const sum = Taps<Preset, Channels>::sum(rows, offset);
+            output[offset] = cv::saturate_cast<T>((sum + rounding) >> Preset::shift);
+        }
+    }
+}
+
+using Routine = void (*)(cv::Mat const &padded, cv::Mat &destination);
+
+template<typename Preset>
+Routine routine(int type)
+{
+    switch (type) {
+    case CV_8UC1:
+        return &convolveRows<Preset, 1, uchar>;
+    case CV_8UC3:
+        return &convolveRows<Preset, 3, uchar>;
+    case CV_8UC4:
+        return &convolveRows<Preset, 4, uchar>;
+    case CV_16UC1:
+        return &convolveRows<Preset, 1, ushort>;
+    case CV_16UC3:
+        return &convolveRows<Preset, 3, ushort>;
+    case CV_16UC4:
+        return &convolveRows<Preset, 4, ushort>;
+    }
+
+    return nullptr;
+}
+
+template<typename Preset>
+cv::Mat compiledMatrix(int)
+{
+    cv::Mat_<float> kernel(Preset::size, Preset::size);
+    for (int i = 0; i < Preset::size * Preset::size; ++i) {
+        kernel(i / Preset::size, i % Preset::size) = static_cast<float>(Preset::coefficients[i])
+                                                     / (1 << Preset::shift);
+    }
+    return kernel;
+}
+
+// The 3x3 kernels grow into arms of the radius, weighted to keep their sum.
+
+cv::Mat sharpenMatrix(int size)
+{
+    int const r = size / 2;
+    cv::Mat_<float> kernel = cv::Mat_<float>::zeros(size, size);
+    for (int i = 1; i <= r; ++i) {
+        kernel(r - i, r) = kernel(r + i, r) = -1.0f / r;
+        kernel(r, r - i) = kernel(r, r + i) = -1.0f / r;
+    }
+    kernel(r, r) = 5.0f;
+    return kernel;
+}
+
+cv::Mat embossMatrix(int size)
+{
+    int const r = size / 2;
+    cv::Mat_<float> kernel(size, size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            kernel(y, x) = static_cast<float>((x - r) + (y - r)) / r;
+        }
+    }
+    kernel(r, r) = 1.0f;
+    return kernel;
+}
+
+cv::Mat edgeEnhanceMatrix(int size)
+{
+    int const r = size / 2;
+    cv::Mat_<float> kernel = cv::Mat_<float>::zeros(size, size);
+    for (int x = 0; x < r; ++x) {
+        kernel(r, x) = -1.0f / r;
+    }
+    kernel(r, r) = 1.0f;
+    return kernel;
+}
+
+cv::Mat boxBlurMatrix(int size)
+{
+    return cv::Mat_<float>(size, size, 1.0f / (size * size));
+}
+
+struct Entry
+{
+    char const *preset;
+
+    /// The size of the integer routine, 0 for the float coefficients at the other sizes.
+    int size;
+
+    /// Picks the routine for a `cv::Mat` type, null without a routine.
+    Routine (*routine)(int type);
+
+    cv::Mat (*matrix)(int size);
+};
+
+template<typename Preset>
+Entry compiled(char const *preset)
+{
+    return Entry{preset, Preset::size, &routine<Preset>, &compiledMatrix<Preset>};
+}
+
+/// All the presets, the compiled sizes before the row of the other sizes.
+Entry const entries[] = {
+    compiled<Sharpen3>("Sharpen"),
+    compiled<Sharpen5>("Sharpen"),
+    Entry{"Sharpen", 0, nullptr, &sharpenMatrix},
+
+    compiled<Emboss3>("Emboss"),
+    compiled<Emboss5>("Emboss"),
+    Entry{"Emboss", 0, nullptr, &embossMatrix},
+
+    compiled<EdgeEnhance3>("Edge Enhance"),
+    compiled<EdgeEnhance5>("Edge Enhance"),
+    Entry{"Edge Enhance", 0, nullptr, &edgeEnhanceMatrix},
+
+    Entry{"Box Blur", 0, nullptr, &boxBlurMatrix},
+};
+
+/// The entry of `preset` at `size`, the only choice made at runtime.
+Entry const *find(QString const &preset, int size)
+{
+    for (Entry const &entry : entries) {
+        if ((entry.size == size || entry.size == 0) && preset == QLatin1String(entry.preset))
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+Routine routine(QString const &preset, int size, int type)
+{
+    Entry const *entry = find(preset, size);
+    return entry && entry->routine ? entry->routine(type) : nullptr;
+}
+
+} // namespace
+
+bool PresetConvolution::supports(QString const &preset, int size, int type)
+{
+    return routine(preset, size, type) != nullptr;
+}
+
+cv::Mat PresetConvolution::matrix(QString const &preset, int size)
+{
+    size = std::max(1, size | 1);
+
+    Entry const *entry = find(preset, size);
+    if (!entry || size == 1) {
+        cv::Mat_<float> identity = cv::Mat_<float>::zeros(size, size);
+        identity(size / 2, size / 2) = 1.0f;
+        return identity;
+    }
+
+    return entry->matrix(size);
+}
+
+cv::Mat PresetConvolution::convolve(cv::Mat const &input,
+                                    cv::Rect const &area,
+                                    QString const &preset,
+                                    int size,
+                                    CancelCheck const &cancelled)
+{
+    Routine const run = routine(preset, size, input.type());
+    if (!run || (cancelled && cancelled()))
+        return cv::Mat();
+
+    int const halo = size / 2;
+
+    cv::Mat const result = TileEngine::process(input, area, input.type(), halo,
+        [run, halo, &cancelled](cv::Mat const &source, cv::Rect const &tile, cv::Mat &destination) {
+            if (cancelled && cancelled())
+                return;
+
+            // The pixels around the tile, reflected at the edges of the input only.
+            cv::Mat padded;
+            cv::copyMakeBorder(source(tile), padded, halo, halo, halo, halo, cv::BORDER_REFLECT_101);
+
+            run(padded, destination);
+        });
+
+    if (cancelled && cancelled())
+        return cv::Mat();
+
+    return result;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <QtCore/QString>
+
+#include <opencv2/core.hpp>
+
+#include <functional>
+
+/**
+ * The preset kernels at the sizes with compiled routines. The coefficients
+ * are integers scaled by `2^shift`, the result of a pixel is the weighted
+ * sum shifted back with rounding.
+ */
+namespace Presets {
+
+struct Sharpen3
+{
+    static constexpr int size = 3;
+    static constexpr int shift = 0;
+    static constexpr int coefficients[size * size] = {
+         0, -1,  0,
+        -1,  5, -1,
+         0, -1,  0,
+    };
+};
+
+struct Emboss3
+{
+    static constexpr int size = 3;
+    static constexpr int shift = 0;
+    static constexpr int coefficients[size * size] = {
+        -2, -1,  0,
+        -1,  1,  1,
+         0,  1,  2,
+    };
+};
+
+struct EdgeEnhance3
+{
+    static constexpr int size = 3;
+    static constexpr int shift = 0;
+    static constexpr int coefficients[size * size] = {
+         0,  0,  0,
+        -1,  1,  0,
+         0,  0,  0,
+    };
+};
+
+struct Sharpen5
+{
+    static constexpr int size = 5;
+    static constexpr int shift = 1;
+    static constexpr int coefficients[size * size] = {
+         0,  0, -1,  0,  0,
+         0,  0, -1,  0,  0,
+        -1, -1, 10, -1, -1,
+         0,  0, -1,  0,  0,
+         0,  0, -1,  0,  0,
+    };
+};
+
+struct Emboss5
+{
+    static constexpr int size = 5;
+    static constexpr int shift = 1;
+    static constexpr int coefficients[size * size] = {
+        -4, -3, -2, -1,  0,
+        -3, -2, -1,  0,  1,
+        -2, -1,  2,  1,  2,
+        -1,  0,  1,  2,  3,
+         0,  1,  2,  3,  4,
+    };
+};
+
+struct EdgeEnhance5
+{
+    static constexpr int size = 5;
+    static constexpr int shift = 1;
+    static constexpr int coefficients[size * size] = {
+         0,  0,  0,  0,  0,
+         0,  0,  0,  0,  0,
+        -1, -1,  2,  0,  0,
+         0,  0,  0,  0,  0,
+         0,  0,  0,  0,  0,
+    };
+};
+
+} // namespace Presets
+
+/// Integer convolution with the preset kernels of `Presets`.
+/**
+ * Every preset has a fully unrolled routine per channel count and pixel
+ * type, instantiated from its coefficients at compile time: the taps of
+ * zero weight vanish and the others are integer multiply-adds on the
+ * samples, without a conversion to float. The routines run on the tiles
+ * of the TileEngine and reflect the border like `cv::filter2D`, whose
+ * results they match up to the rounding of halves.
+ */
+class PresetConvolution
+{
+public:
+    using CancelCheck = std::function<bool()>;
+
+    /// Whether a routine exists for `preset` at `size` and the `cv::Mat` `type`.
+    static bool supports(QString const &preset, int size, int type);
+
+    /**
+   * The coefficients of `preset` at any odd `size` as floats, an identity
+   * for unknown presets. The sizes with a routine share its coefficients,
+   * the others grow the 3x3 kernel.
+   */
+    static cv::Mat matrix(QString const &preset, int size);
+
+    /**
+   * @returns the pixels `area` of `input` convolved with `preset`, empty if
+   * the computation was cancelled or there is no routine for it.
+   */
+    static cv::Mat convolve(cv::Mat const &input,
+                            cv::Rect const &area,
+                            QString const &preset,
+                            int size,
+                            CancelCheck const &cancelled = CancelCheck());
+};
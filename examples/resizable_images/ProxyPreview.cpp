@@ -0,0 +1,69 @@
+#include "ProxyPreview.hpp"
+
+#include <QtWidgets/QAbstractSlider>
+
+#include <algorithm>
+
+ProxyPreview &ProxyPreview::instance()
+{
+    static ProxyPreview preview;
+    return preview;
+}
+
+ProxyPreview::ProxyPreview()
+    : _proxyFactor(0.25)
+    , _interactive(false)
+{
+    _idleTimer.setSingleShot(true);
+    _idleTimer.setInterval(500);
+
+    // The graph went idle: refine even if the slider is still held.
+    connect(&_idleTimer, &QTimer::timeout, this, &ProxyPreview::endInteraction);
+}
+
+void ProxyPreview::setProxyFactor(double factor)
+{
+    _proxyFactor = std::min(1.0, std::max(0.01, factor));
+}
+
+void ProxyPreview::trackSlider(QAbstractSlider *slider)
+{
+    connect(slider, &QAbstractSlider::sliderPressed, this, [this]() { touch(); });
+
+    connect(slider, &QAbstractSlider::sliderReleased, this, &ProxyPreview::endInteraction);
+
+    // Only user actions, programmatic `setValue` calls do not count.
+    connect(slider, &QAbstractSlider::actionTriggered, this, [this](int) { touch(); });
+}
+
+void ProxyPreview::touch()
+{
+    _idleTimer.start();
+
+    if (!_interactive)
+        beginInteraction();
+}
+
+void ProxyPreview::beginInteraction()
+{
+    if (_interactive)
+        return;
+
+    _interactive = true;
+
+    if (_proxyFactor < 1.0)
+        Q_EMIT interactiveChanged(true);
+}
+
+void ProxyPreview::endInteraction()
+{
+    _idleTimer.stop();
+
+    if (!_interactive)
+        return;
+
+    _interactive = false;
+
+    if (_proxyFactor < 1.0)
+        Q_EMIT interactiveChanged(false);
+}
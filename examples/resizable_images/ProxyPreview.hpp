@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+class QAbstractSlider;
+
+/// Graph-wide interactive preview mode.
+/**
+ * While a tracked slider is dragged the sources of the graph emit images
+ * downscaled by `proxyFactor()` so that every node downstream processes a
+ * proxy and follows the cursor. Once the drag ends, or no value changed
+ * during `idleTimeout()` milliseconds, the interaction finishes and the
+ * sources emit the full-resolution images again.
+ *
+ * Processing models only need to register their sliders with
+ * `trackSlider`. Source models check `interactive()` when producing data
+ * and re-emit it on `interactiveChanged`. Parameters given in pixels, like
+ * blur radii and kernel sizes, are scaled by `currentFactor()` so that the
+ * proxy looks like the downscaled full-resolution result.
+ */
+class ProxyPreview : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ProxyPreview &instance();
+
+public:
+    /// Scale of the proxy images, `1.0` disables the preview mode.
+    double proxyFactor() const { return _proxyFactor; }
+
+    void setProxyFactor(double factor);
+
+    int idleTimeout() const { return _idleTimer.interval(); }
+
+    void setIdleTimeout(int msec) { _idleTimer.setInterval(msec); }
+
+    /// @returns `true` while the graph should run on proxy images.
+    bool interactive() const { return _interactive && _proxyFactor < 1.0; }
+
+    /// @returns the scale the sources apply to their output images.
+    double currentFactor() const { return interactive() ? _proxyFactor : 1.0; }
+
+    /// Drags and keyboard or wheel steps of `slider` drive the interaction.
+    void trackSlider(QAbstractSlider *slider);
+
+public Q_SLOTS:
+    void beginInteraction();
+
+    void endInteraction();
+
+Q_SIGNALS:
+    /// The sources re-emit their data in the new resolution.
+    void interactiveChanged(bool interactive);
+
+private:
+    ProxyPreview();
+
+    /// Restarts the idle countdown, starting an interaction if needed.
+    void touch();
+
+private:
+    double _proxyFactor;
+
+    bool _interactive;
+
+    QTimer _idleTimer;
+};
@@ -0,0 +1,63 @@
+#include "Simd.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+
+namespace {
+
+std::atomic<int> forcedInstructionSet{-1};
+
+} // namespace
+
+bool Simd::available(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case InstructionSet::Scalar:
+        return true;
+#ifdef SIMD_X86
+    case InstructionSet::Sse41:
+        return cv::checkHardwareSupport(CV_CPU_SSE4_1);
+    case InstructionSet::Avx2:
+        return cv::checkHardwareSupport(CV_CPU_AVX2);
+#else
+    default:
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+Simd::InstructionSet Simd::supported()
+{
+    static InstructionSet const best = available(InstructionSet::Avx2)    ? InstructionSet::Avx2
+                                       : available(InstructionSet::Sse41) ? InstructionSet::Sse41
+                                                                          : InstructionSet::Scalar;
+    return best;
+}
+
+Simd::InstructionSet Simd::instructionSet()
+{
+    int const forced = forcedInstructionSet;
+    return forced < 0 ? supported() : static_cast<InstructionSet>(forced);
+}
+
+void Simd::setInstructionSet(InstructionSet instructionSet)
+{
+    forcedInstructionSet = available(instructionSet) ? static_cast<int>(instructionSet) : -1;
+}
+
+QString Simd::name(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case InstructionSet::Scalar:
+        return "scalar";
+    case InstructionSet::Sse41:
+        return "sse4.1";
+    case InstructionSet::Avx2:
+        return "avx2";
+    }
+
+    return QString();
+}
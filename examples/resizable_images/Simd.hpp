@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QtCore/QString>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SIMD_X86 1
+#endif
+
+// Lets GCC and Clang emit the instructions of a path without global flags,
+// MSVC accepts the intrinsics anyway.
+#if defined(__GNUC__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+/// The vector instruction sets the image kernels have paths for.
+/**
+ * The code of every path is compiled in regardless of the compiler flags
+ * (@see SIMD_TARGET) and the kernels pick `instructionSet()` at runtime.
+ */
+class Simd
+{
+public:
+    enum class InstructionSet
+    {
+        Scalar,
+        Sse41,
+        Avx2,
+    };
+
+    static bool available(InstructionSet instructionSet);
+
+    /// The widest instruction set of the CPU the kernels have paths for.
+    static InstructionSet supported();
+
+    /// The path taken by the kernels, `supported()` unless overridden.
+    static InstructionSet instructionSet();
+
+    /// Forces a path, e.g. to compare them. Falls back to `supported()` if the CPU lacks it.
+    static void setInstructionSet(InstructionSet instructionSet);
+
+    static QString name(InstructionSet instructionSet);
+};
@@ -0,0 +1,37 @@
+#include "ThresholdKernel.hpp"
+
+ThresholdKernel::ThresholdKernel(Parameters const &parameters)
+    : _parameters(parameters)
+{}
+
+ThresholdKernel::Parameters ThresholdKernel::load(QJsonObject const &json, Parameters const &defaults)
+{
+    Parameters parameters;
+    parameters.threshold = json["threshold"].toInt(defaults.threshold);
+    return parameters;
+}
+
+std::shared_ptr<LookupTable const> ThresholdKernel::lookupTable(ImageBuffer::Format format) const
+{
+    return table(ImageBuffer::channels(format));
+}
+
+void ThresholdKernel::apply(cv::Mat const &input, std::vector<cv::Mat> const &, cv::Mat &output) const
+{
+    table(input.channels())->apply(input, output);
+}
+
+std::shared_ptr<LookupTable const> ThresholdKernel::table(int channels) const
+{
+    int const thresholdValue = _parameters.threshold;
+
+    return std::make_shared<LookupTable const>(
+        LookupTable::fromFunction(channels, [thresholdValue](int v) {
+            return v >= thresholdValue ? 255 : 0;
+        }));
+}
+
+void ThresholdKernel::save(QJsonObject &json) const
+{
+    json["threshold"] = _parameters.threshold;
+}
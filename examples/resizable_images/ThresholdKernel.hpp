@@ -0,0 +1,40 @@
+#pragma once
+
+#include "PointwiseKernel.hpp"
+
+/// Binarizes the gray levels of an image.
+class ThresholdKernel : public PointwiseKernel
+{
+public:
+    struct Parameters
+    {
+        /// Gray levels from the threshold on turn white, 0 to 255.
+        int threshold = 128;
+    };
+
+    explicit ThresholdKernel(Parameters const &parameters = Parameters());
+
+    Parameters const &parameters() const { return _parameters; }
+
+    /// Reads the parameters saved by `save`, missing ones are taken from `defaults`.
+    static Parameters load(QJsonObject const &json, Parameters const &defaults = Parameters());
+
+public:
+    ImageBuffer::Format inputFormat(ImageBuffer::Format) const override
+    {
+        return ImageBuffer::Format::Gray8;
+    }
+
+    std::shared_ptr<LookupTable const> lookupTable(ImageBuffer::Format format) const override;
+
+    /// Looks the pixels up in the table.
+    void apply(cv::Mat const &input, std::vector<cv::Mat> const &extras, cv::Mat &output) const override;
+
+    void save(QJsonObject &json) const override;
+
+private:
+    std::shared_ptr<LookupTable const> table(int channels) const;
+
+private:
+    Parameters _parameters;
+};
@@ -1,35 +1,24 @@
 #include "ThresholdModel.hpp"
 
-#include <QtGui/QImage>
-#include <QtGui/QPainter>
+#include "ProxyPreview.hpp"
+
 #include <QtCore/QEvent>
+#include <QtCore/QSignalBlocker>
 
 ThresholdModel::ThresholdModel()
-    : _label(new QLabel("Binary Image will appear here")),
-      _slider(new QSlider(Qt::Horizontal)),
-      _widget(new QWidget),
-      _layout(new QVBoxLayout(_widget))
-{
-    _label->setAlignment(Qt::AlignCenter);
-    _label->setMinimumSize(200, 200);
-    _label->installEventFilter(this);
+    : _kernel(std::make_shared<ThresholdKernel const>())
+{}
 
-    _slider->setMinimum(0);
-    _slider->setMaximum(255);
-    _slider->setValue(_thresholdValue);
-    _slider->setTickPosition(QSlider::TicksBelow);
-    _slider->setToolTip("Threshold value (0-255)");
-
-    connect(_slider, &QSlider::valueChanged, this, [this](int value) {
-        _thresholdValue = value;
-        if (!_originalPixmap.isNull()) {
-            applyThreshold(_originalPixmap);
-        }
-    });
+QJsonObject ThresholdModel::save() const
+{
+    QJsonObject modelJson = NodeDelegateModel::save();
+    _kernel->save(modelJson);
+    return modelJson;
+}
 
-    _layout->addWidget(_label);
-    _layout->addWidget(_slider);
-    _widget->setLayout(_layout);
+void ThresholdModel::load(QJsonObject const &modelJson)
+{
+    setParameters(ThresholdKernel::load(modelJson, _kernel->parameters()));
 }
 
 unsigned int ThresholdModel::nPorts(PortType portType) const
@@ -40,8 +29,8 @@ unsigned int ThresholdModel::nPorts(PortType portType) const
 bool ThresholdModel::eventFilter(QObject *object, QEvent *event)
 {
     if (object == _label && event->type() == QEvent::Resize) {
-        if (!_thresholdPixmap.isNull()) {
-            _label->setPixmap(_thresholdPixmap.scaled(_label->size(), Qt::KeepAspectRatio));
+        if (_output) {
+            _label->setPixmap(_output->toPixmap(_label->size()));
         }
     }
     return false;
@@ -49,43 +38,139 @@ bool ThresholdModel::eventFilter(QObject *object, QEvent *event)
 
 NodeDataType ThresholdModel::dataType(PortType const, PortIndex const) const
 {
-    return PixmapData().type();
+    return ImageData().type();
 }
 
 std::shared_ptr<NodeData> ThresholdModel::outData(PortIndex)
 {
-    return std::make_shared<PixmapData>(_thresholdPixmap);
+    return _output;
+}
+
+QJsonObject ThresholdModel::computationParameters() const
+{
+    QJsonObject parameters;
+    _kernel->save(parameters);
+    parameters["deferred"] = _deferredOutput && !_widget;
+    ImageRequest::save(_outRequest, parameters);
+    return parameters;
+}
+
+bool ThresholdModel::restoreOutData(std::vector<std::shared_ptr<NodeData>> const &outputs)
+{
+    auto d = std::dynamic_pointer_cast<ImageData>(outputs.front());
+    if (!d)
+        return false;
+
+    _output = d;
+    if (_label)
+        _label->setPixmap(_output->toPixmap(_label->size()));
+    return true;
 }
 
 void ThresholdModel::setInData(std::shared_ptr<NodeData> nodeData, PortIndex const)
 {
-    if (auto d = std::dynamic_pointer_cast<PixmapData>(nodeData)) {
-        _originalPixmap = d->pixmap();
-        applyThreshold(_originalPixmap);
+    auto d = std::dynamic_pointer_cast<ImageData>(nodeData);
+    if (d && !d->isNull()) {
+        _input = d;
+        applyThreshold();
     }
 }
 
-void ThresholdModel::applyThreshold(const QPixmap &input)
+std::shared_ptr<QtNodes::NodeDataRequest const> ThresholdModel::inRequest(PortIndex) const
+{
+    // A pointwise operation needs just the requested pixels.
+    return _outRequest;
+}
+
+bool ThresholdModel::setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request, PortIndex)
 {
-    if (input.isNull()) return;
+    _outRequest = std::dynamic_pointer_cast<ImageRequest const>(request);
+    return _output && !_output->covers(_outRequest);
+}
+
+QWidget *ThresholdModel::embeddedWidget()
+{
+    if (_widget)
+        return _widget;
 
-    QImage gray = input.toImage().convertToFormat(QImage::Format_Grayscale8);
-    QImage binary(gray.size(), QImage::Format_Grayscale8);
+    _label = new QLabel("Binary Image will appear here");
+    _slider = new QSlider(Qt::Horizontal);
+    _widget = new QWidget;
+    _layout = new QVBoxLayout(_widget);
 
-    for (int y = 0; y < gray.height(); ++y) {
-        const uchar *srcLine = gray.constScanLine(y);
-        uchar *dstLine = binary.scanLine(y);
-        for (int x = 0; x < gray.width(); ++x) {
-            dstLine[x] = (srcLine[x] >= _thresholdValue) ? 255 : 0;
-        }
+    _label->setAlignment(Qt::AlignCenter);
+    _label->setMinimumSize(200, 200);
+    _label->installEventFilter(this);
+
+    _slider->setMinimum(0);
+    _slider->setMaximum(255);
+    _slider->setValue(_kernel->parameters().threshold);
+    _slider->setTickPosition(QSlider::TicksBelow);
+    _slider->setToolTip("Threshold value (0-255)");
+
+    connect(_slider, &QSlider::valueChanged, this, [this](int value) {
+        ThresholdKernel::Parameters parameters = _kernel->parameters();
+        parameters.threshold = value;
+        setParameters(parameters);
+    });
+
+    ProxyPreview::instance().trackSlider(_slider);
+
+    _layout->addWidget(_label);
+    _layout->addWidget(_slider);
+    _widget->setLayout(_layout);
+
+    return _widget;
+}
+
+void ThresholdModel::setParameters(ThresholdKernel::Parameters const &parameters)
+{
+    _kernel = std::make_shared<ThresholdKernel const>(parameters);
+
+    if (_slider) {
+        QSignalBlocker const blocker(_slider);
+        _slider->setValue(parameters.threshold);
     }
 
-    _thresholdPixmap = QPixmap::fromImage(binary);
-    _label->setPixmap(_thresholdPixmap.scaled(_label->size(), Qt::KeepAspectRatio));
-    _label->setToolTip(QString("Size: %1 x %2\nThreshold: %3")
-                           .arg(_originalPixmap.width())
-                           .arg(_originalPixmap.height())
-                           .arg(_thresholdValue));
+    applyThreshold();
+}
+
+void ThresholdModel::setDeferredOutput(bool deferred)
+{
+    if (deferred == _deferredOutput)
+        return;
+
+    _deferredOutput = deferred;
+    applyThreshold();
+}
+
+void ThresholdModel::applyThreshold()
+{
+    if (!_input) return;
+
+    std::shared_ptr<ThresholdKernel const> const kernel = _kernel;
+    ImageKernel::Inputs const inputs{_input};
+    std::shared_ptr<ImageRequest const> const request = _outRequest;
+    // The preview needs the pixels.
+    bool const defer = _deferredOutput && !_widget;
 
-    Q_EMIT dataUpdated(0);
+    runComputation([this, kernel, inputs, request, defer]() {
+        std::shared_ptr<ImageData> const binary
+            = defer ? kernel->defer(inputs, request)
+                    : kernel->compute(inputs, request, []() { return computationCancelled(); });
+
+        return [this, kernel, binary]() {
+            _output = binary;
+
+            if (_label && _output) {
+                _label->setPixmap(_output->toPixmap(_label->size()));
+                _label->setToolTip(QString("Size: %1 x %2\nThreshold: %3")
+                                       .arg(_output->width())
+                                       .arg(_output->height())
+                                       .arg(kernel->parameters().threshold));
+            }
+
+            Q_EMIT dataUpdated(0);
+        };
+    });
 }
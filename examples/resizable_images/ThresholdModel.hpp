@@ -8,7 +8,9 @@
 
 #include <QtNodes/NodeDelegateModel>
 
-#include "PixmapData.hpp"
+#include "ImageData.hpp"
+#include "PointwiseFusion.hpp"
+#include "ThresholdKernel.hpp"
 
 using QtNodes::NodeData;
 using QtNodes::NodeDataType;
@@ -16,7 +18,9 @@ using QtNodes::NodeDelegateModel;
 using QtNodes::PortIndex;
 using QtNodes::PortType;
 
-class ThresholdModel : public NodeDelegateModel
+class ThresholdModel
+    : public NodeDelegateModel
+    , public PointwiseModel
 {
     Q_OBJECT
 
@@ -29,29 +33,55 @@ public:
     QString name() const override { return QString("ThresholdModel"); }
     QString modelName() const { return QString("Threshold"); }
 
+    QJsonObject save() const override;
+    void load(QJsonObject const &modelJson) override;
+
     unsigned int nPorts(PortType portType) const override;
     NodeDataType dataType(PortType portType, PortIndex portIndex) const override;
 
     std::shared_ptr<NodeData> outData(PortIndex port) override;
+
+    bool cacheable() const override { return true; }
+
+    QJsonObject computationParameters() const override;
+
+    bool restoreOutData(std::vector<std::shared_ptr<NodeData>> const &outputs) override;
     void setInData(std::shared_ptr<NodeData> nodeData, PortIndex port) override;
 
-    QWidget *embeddedWidget() override { return _widget; }
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(PortIndex port) const override;
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       PortIndex port) override;
+
+    QWidget *embeddedWidget() override;
     bool resizable() const override { return true; }
 
+    std::shared_ptr<ThresholdKernel const> kernel() const { return _kernel; }
+
+    /// Replaces the parameter snapshot and recomputes the output.
+    void setParameters(ThresholdKernel::Parameters const &parameters);
+
+    void setDeferredOutput(bool deferred) override;
+
 protected:
     bool eventFilter(QObject *object, QEvent *event) override;
 
 private:
-    void applyThreshold(const QPixmap &input);
+    void applyThreshold();
 
 private:
-    QLabel *_label;
-    QSlider *_slider;
-    QWidget *_widget;
-    QVBoxLayout *_layout;
+    // Created by `embeddedWidget`, headless graphs have none.
+    QLabel *_label = nullptr;
+    QSlider *_slider = nullptr;
+    QWidget *_widget = nullptr;
+    QVBoxLayout *_layout = nullptr;
+
+    std::shared_ptr<ImageData> _input;
+    std::shared_ptr<ImageData> _output;
+
+    std::shared_ptr<ImageRequest const> _outRequest;
 
-    QPixmap _originalPixmap;
-    QPixmap _thresholdPixmap;
+    std::shared_ptr<ThresholdKernel const> _kernel;
 
-    int _thresholdValue = 128;
+    bool _deferredOutput = false;
 };
@@ -0,0 +1,66 @@
+#include "TileEngine.hpp"
+
+#include <QtNodes/TaskScheduler>
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+std::atomic<int> currentTileSize{256};
+
+} // namespace
+
+int TileEngine::tileSize()
+{
+    return currentTileSize;
+}
+
+void TileEngine::setTileSize(int size)
+{
+    currentTileSize = std::max(16, size);
+}
+
+cv::Mat TileEngine::process(cv::Mat const &input, int outputType, int halo, TileFunction const &function)
+{
+    return process(input, cv::Rect(0, 0, input.cols, input.rows), outputType, halo, function);
+}
+
+cv::Mat TileEngine::process(cv::Mat const &input,
+                            cv::Rect const &area,
+                            int outputType,
+                            int halo,
+                            TileFunction const &function)
+{
+    cv::Mat output(area.size(), outputType);
+
+    int const size = tileSize();
+    int const columns = (area.width + size - 1) / size;
+    int const rows = (area.height + size - 1) / size;
+
+    cv::Rect const frame(0, 0, input.cols, input.rows);
+
+    auto processTile = [&](std::size_t index) {
+        int const column = static_cast<int>(index) % columns;
+        int const row = static_cast<int>(index) / columns;
+
+        cv::Rect const tile = cv::Rect(area.x + column * size, area.y + row * size, size, size)
+                              & area;
+
+        // The halo is clipped at the frame, kernels handle the border there.
+        cv::Rect const region = cv::Rect(tile.x - halo,
+                                         tile.y - halo,
+                                         tile.width + 2 * halo,
+                                         tile.height + 2 * halo)
+                                & frame;
+
+        cv::Mat destination = output(tile - area.tl());
+
+        function(input(region), tile - region.tl(), destination);
+    };
+
+    QtNodes::TaskScheduler::globalInstance().parallelFor(static_cast<std::size_t>(columns) * rows,
+                                                         processTile);
+
+    return output;
+}
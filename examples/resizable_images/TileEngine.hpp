@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <functional>
+
+/// Runs image kernels tile by tile on the worker pool.
+/**
+ * The output frame is split into square tiles. Every tile is computed
+ * from the input region it covers grown by the halo (apron) of the
+ * operator, e.g. the radius of a convolution kernel, and the tiles are
+ * processed in parallel with QtNodes::TaskScheduler::parallelFor.
+ *
+ * Tiling parallelizes a kernel and keeps its working set in cache, the
+ * nodes still exchange whole frames.
+ */
+class TileEngine
+{
+public:
+    /**
+   * Computes one tile. `source` is the input region including the halo,
+   * `tile` the rectangle of the tile within `source` and `destination` the
+   * view of the tile in the output, to be filled by the function.
+   */
+    using TileFunction = std::function<void(cv::Mat const &source, cv::Rect const &tile, cv::Mat &destination)>;
+
+    /// @returns the output of `function` applied to all the tiles of `input`.
+    static cv::Mat process(cv::Mat const &input, int outputType, int halo, TileFunction const &function);
+
+    /**
+   * @returns the output of `function` for the pixels `area` of `input`
+   * only. The halo of the tiles still reaches into the input around the
+   * area.
+   */
+    static cv::Mat process(cv::Mat const &input,
+                           cv::Rect const &area,
+                           int outputType,
+                           int halo,
+                           TileFunction const &function);
+
+    /// Edge length of the tiles in pixels.
+    static int tileSize();
+
+    static void setTileSize(int size);
+};
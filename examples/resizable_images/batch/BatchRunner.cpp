@@ -0,0 +1,282 @@
+#include "BatchRunner.hpp"
+
+#include "ImageData.hpp"
+#include "ImageLoaderModel.hpp"
+#include "ImageShowModel.hpp"
+
+#include <QtNodes/NodeDelegateModel>
+#include <QtNodes/TaskScheduler>
+
+#include <QtCore/QDebug>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMetaObject>
+
+#include <algorithm>
+#include <stdexcept>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::TaskScheduler;
+
+namespace {
+
+/// @returns whether a node of `sources` is `nodeId` or upstream of it.
+bool reaches(DataFlowGraphModel const &graph,
+             std::unordered_set<NodeId> const &sources,
+             NodeId const nodeId)
+{
+    std::unordered_set<NodeId> visited{nodeId};
+    std::vector<NodeId> stack{nodeId};
+
+    while (!stack.empty()) {
+        NodeId const current = stack.back();
+        stack.pop_back();
+
+        if (sources.count(current) > 0)
+            return true;
+
+        for (ConnectionId const &cid : graph.allConnectionIds(current)) {
+            if (cid.inNodeId == current && visited.insert(cid.outNodeId).second)
+                stack.push_back(cid.outNodeId);
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(std::shared_ptr<NodeDelegateModelRegistry> registry, Options options)
+    : _registry(std::move(registry))
+    , _options(std::move(options))
+    , _total(0)
+    , _processed(0)
+    , _failed(0)
+    , _inFlight(0)
+{}
+
+BatchRunner::~BatchRunner()
+{
+    // The reading and writing tasks refer to the runner.
+    TaskScheduler::globalInstance().waitForIdle();
+}
+
+bool BatchRunner::start(QJsonObject const &graph, QString &errorMessage)
+{
+    QStringList const filters{"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.tif", "*.tiff"};
+    QStringList const files = _options.inputDirectory.entryList(filters, QDir::Files, QDir::Name);
+
+    if (files.isEmpty()) {
+        errorMessage = QString("No images in %1").arg(_options.inputDirectory.path());
+        return false;
+    }
+
+    if (!_options.outputDirectory.mkpath(".")) {
+        errorMessage = QString("Cannot create %1").arg(_options.outputDirectory.path());
+        return false;
+    }
+
+    int const laneCount = std::max(1, std::min(_options.jobs, static_cast<int>(files.size())));
+
+    for (int i = 0; i < laneCount; ++i) {
+        auto lane = std::make_unique<Lane>();
+        lane->graph = std::make_unique<DataFlowGraphModel>(_registry);
+
+        // Every image differs, memoized outputs would only take memory.
+        lane->graph->computationCache().setByteBudget(0);
+        lane->graph->setAsyncExecution(true);
+
+        try {
+            lane->graph->load(graph);
+        } catch (std::logic_error const &e) {
+            errorMessage = e.what();
+            return false;
+        }
+
+        lane->fusion = std::make_unique<PointwiseFusion>(*lane->graph);
+
+        std::unordered_set<NodeId> loaderIds;
+
+        for (NodeId const nodeId : lane->graph->allNodeIds()) {
+            if (auto loader = lane->graph->delegateModel<ImageLoaderModel>(nodeId)) {
+                lane->loaders.push_back(loader);
+                loaderIds.insert(nodeId);
+            }
+
+            if (auto sink = lane->graph->delegateModel<ImageShowModel>(nodeId)) {
+                sink->setFullResolution(true);
+                lane->sinks.emplace_back(nodeId, sink);
+            }
+        }
+
+        if (lane->loaders.empty()) {
+            errorMessage = "The graph has no Image Source node";
+            return false;
+        }
+
+        if (lane->sinks.empty()) {
+            errorMessage = "The graph has no Image Display node";
+            return false;
+        }
+
+        // Names the outputs of several sinks consistently across the lanes.
+        std::sort(lane->sinks.begin(), lane->sinks.end());
+
+        // Sinks fed by generators alone, e.g. noise, keep their result from image to image.
+        for (auto const &sink : lane->sinks) {
+            if (reaches(*lane->graph, loaderIds, sink.first))
+                lane->fedSinks.insert(sink.first);
+        }
+
+        // Queued, the graph evaluates the nodes downstream right after the signal.
+        Lane *l = lane.get();
+        connect(lane->graph.get(),
+                &DataFlowGraphModel::nodeComputingFinished,
+                this,
+                [this, l]() { checkLane(*l); },
+                Qt::QueuedConnection);
+
+        _lanes.push_back(std::move(lane));
+    }
+
+    _pending.assign(files.begin(), files.end());
+    _total = static_cast<int>(files.size());
+
+    for (auto &lane : _lanes) {
+        feed(*lane);
+    }
+
+    return true;
+}
+
+void BatchRunner::feed(Lane &lane)
+{
+    if (_pending.empty()) {
+        lane.fileName.clear();
+        checkFinished();
+        return;
+    }
+
+    lane.fileName = _pending.front();
+    _pending.pop_front();
+
+    QString const path = _options.inputDirectory.filePath(lane.fileName);
+
+    ++_inFlight;
+
+    Lane *l = &lane;
+    TaskScheduler::globalInstance().submit([this, l, path]() {
+        QImage const image(path);
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, l, image]() {
+                --_inFlight;
+
+                if (image.isNull()) {
+                    reportFailure(l->fileName, "cannot be read");
+                    feed(*l);
+                    return;
+                }
+
+                for (auto const &sink : l->sinks) {
+                    auto const data = sink.second->outData(0);
+                    l->submitted[sink.first] = data ? data->identity() : 0;
+                }
+
+                l->applied = true;
+
+                for (ImageLoaderModel *loader : l->loaders) {
+                    loader->setImage(image);
+                }
+
+                // A graph without asynchronous nodes is done already.
+                checkLane(*l);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void BatchRunner::checkLane(Lane &lane)
+{
+    // Several checks may be queued for one image, and the next image may still be decoding.
+    if (!lane.applied)
+        return;
+
+    for (NodeId const nodeId : lane.graph->allNodeIds()) {
+        auto model = lane.graph->delegateModel<NodeDelegateModel>(nodeId);
+        if (model && model->computing())
+            return;
+    }
+
+    lane.applied = false;
+
+    QString const baseName = QFileInfo(lane.fileName).completeBaseName();
+    bool const numbered = lane.sinks.size() > 1;
+
+    for (auto const &sink : lane.sinks) {
+        QString const name = numbered
+                                 ? QString("%1_%2.%3").arg(baseName).arg(sink.first).arg(_options.format)
+                                 : QString("%1.%2").arg(baseName, _options.format);
+
+        std::shared_ptr<ImageData const> const data = std::dynamic_pointer_cast<ImageData>(
+            sink.second->outData(0));
+
+        // A failed computation leaves the result the sink held before the image behind.
+        bool const stale = data && lane.fedSinks.count(sink.first) > 0
+                           && data->identity() == lane.submitted[sink.first];
+        if (!data || data->isNull() || stale) {
+            reportFailure(lane.fileName, QString("no result for %1").arg(name));
+            continue;
+        }
+
+        QString const path = _options.outputDirectory.filePath(name);
+        QString const source = lane.fileName;
+
+        ++_inFlight;
+
+        // Deferred data runs its fused point operators here, off the GUI thread.
+        TaskScheduler::globalInstance().submit([this, data, path, source]() {
+            bool const written = data->buffer()->image().save(path);
+
+            QMetaObject::invokeMethod(
+                this,
+                [this, written, path, source]() {
+                    --_inFlight;
+
+                    if (!written)
+                        reportFailure(source, QString("cannot write %1").arg(path));
+
+                    checkFinished();
+                },
+                Qt::QueuedConnection);
+        });
+    }
+
+    ++_processed;
+    qInfo().noquote() << QString("[%1/%2] %3").arg(_processed).arg(_total).arg(lane.fileName);
+
+    feed(lane);
+}
+
+void BatchRunner::reportFailure(QString const &fileName, QString const &reason)
+{
+    ++_failed;
+    qWarning().noquote() << QString("%1: %2").arg(fileName, reason);
+}
+
+void BatchRunner::checkFinished()
+{
+    if (_inFlight > 0 || !_pending.empty())
+        return;
+
+    for (auto const &lane : _lanes) {
+        if (!lane->fileName.isEmpty())
+            return;
+    }
+
+    Q_EMIT finished();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QtCore/QDir>
+#include <QtCore/QJsonObject>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include "PointwiseFusion.hpp"
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class ImageLoaderModel;
+class ImageShowModel;
+
+/// Runs a saved graph over a directory of images without a scene.
+/**
+ * The graph is loaded into several DataFlowGraphModel instances, the
+ * lanes, each processing one image at a time. Every image is decoded on
+ * the worker pool, handed to all the `ImageLoaderModel` nodes of a lane
+ * and, once no node of the lane computes anymore, the images of the
+ * `ImageShowModel` sinks are computed, if fused point operators left
+ * them deferred, and encoded into the output directory on the pool as
+ * well.
+ *
+ * The node computations of all the lanes run asynchronously on
+ * TaskScheduler::globalInstance(), so the lanes overlap the decoding,
+ * the nodes that cannot be tiled and the encoding of different images.
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        QDir inputDirectory;
+
+        QDir outputDirectory;
+
+        /// File suffix of the written images, selects the encoder.
+        QString format = "png";
+
+        /// Number of images processed at once.
+        int jobs = 1;
+    };
+
+public:
+    BatchRunner(std::shared_ptr<QtNodes::NodeDelegateModelRegistry> registry, Options options);
+
+    ~BatchRunner() override;
+
+    /**
+   * Loads `graph` into the lanes and starts processing the images.
+   *
+   * @returns `false` with `errorMessage` set if the graph has no image
+   * sources or sinks, or the input directory holds no images.
+   */
+    bool start(QJsonObject const &graph, QString &errorMessage);
+
+    int processedImages() const { return _processed; }
+
+    int failedImages() const { return _failed; }
+
+Q_SIGNALS:
+    /// All the images were processed and written.
+    void finished();
+
+private:
+    struct Lane
+    {
+        std::unique_ptr<QtNodes::DataFlowGraphModel> graph;
+
+        /// Nothing displays the intermediate images, point operators run fused.
+        std::unique_ptr<PointwiseFusion> fusion;
+
+        std::vector<ImageLoaderModel *> loaders;
+
+        std::vector<std::pair<QtNodes::NodeId, ImageShowModel *>> sinks;
+
+        /// The image being processed, empty for an idle lane.
+        QString fileName;
+
+        /// The loaders hold the image of `fileName` and its results are not written yet.
+        bool applied = false;
+
+        /// Sinks downstream of a loader, every image has to give them a new result.
+        std::unordered_set<QtNodes::NodeId> fedSinks;
+
+        /// Identities the sinks held when the image was handed to the loaders.
+        std::unordered_map<QtNodes::NodeId, std::size_t> submitted;
+    };
+
+    /// Starts the next image on the lane.
+    void feed(Lane &lane);
+
+    /// Writes the results once no node of the lane computes anymore.
+    void checkLane(Lane &lane);
+
+    void reportFailure(QString const &fileName, QString const &reason);
+
+    /// Emits `finished` once no image is pending, processed or written.
+    void checkFinished();
+
+private:
+    std::shared_ptr<QtNodes::NodeDelegateModelRegistry> _registry;
+
+    Options _options;
+
+    std::vector<std::unique_ptr<Lane>> _lanes;
+
+    std::deque<QString> _pending;
+
+    int _total;
+
+    int _processed;
+
+    int _failed;
+
+    /// Images read or being written.
+    int _inFlight;
+};
@@ -0,0 +1,92 @@
+#include <QtNodes/TaskScheduler>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+
+#include "BatchRunner.hpp"
+#include "ModelRegistry.hpp"
+
+using QtNodes::TaskScheduler;
+
+int main(int argc, char *argv[])
+{
+    // The models create their widgets only once embedded in a scene.
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Runs a graph saved by resizable_images over a directory of images.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("graph", "The .flow file.");
+    parser.addPositionalArgument("input", "Directory of the images fed to the Image Source nodes.");
+    parser.addPositionalArgument("output", "Directory receiving the images of the Image Display nodes.");
+
+    QCommandLineOption jobsOption(QStringList{"j", "jobs"},
+                                  "Images processed at once, the number of worker threads by default.",
+                                  "count");
+    parser.addOption(jobsOption);
+
+    QCommandLineOption threadsOption("threads",
+                                     "Worker threads, 0 uses all the cores.",
+                                     "count",
+                                     "0");
+    parser.addOption(threadsOption);
+
+    QCommandLineOption formatOption("format", "Suffix of the written images.", "suffix", "png");
+    parser.addOption(formatOption);
+
+    parser.process(app);
+
+    QStringList const arguments = parser.positionalArguments();
+    if (arguments.size() != 3)
+        parser.showHelp(1);
+
+    TaskScheduler &scheduler = TaskScheduler::globalInstance();
+    scheduler.setWorkerCount(parser.value(threadsOption).toUInt());
+
+    QFile file(arguments[0]);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical().noquote() << QString("Cannot open %1").arg(arguments[0]);
+        return 1;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument const document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (document.isNull()) {
+        qCritical().noquote() << QString("%1: %2").arg(arguments[0], parseError.errorString());
+        return 1;
+    }
+
+    BatchRunner::Options options;
+    options.inputDirectory = QDir(arguments[1]);
+    options.outputDirectory = QDir(arguments[2]);
+    options.format = parser.value(formatOption);
+    options.jobs = parser.isSet(jobsOption) ? parser.value(jobsOption).toInt()
+                                            : static_cast<int>(scheduler.workerCount());
+
+    BatchRunner runner(registerDataModels(), options);
+
+    QObject::connect(&runner, &BatchRunner::finished, &app, &QCoreApplication::quit);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QString errorMessage;
+    if (!runner.start(document.object(), errorMessage)) {
+        qCritical().noquote() << errorMessage;
+        return 1;
+    }
+
+    app.exec();
+
+    qInfo().noquote() << QString("%1 images in %2 s, %3 failures")
+                             .arg(runner.processedImages())
+                             .arg(timer.elapsed() / 1000.0, 0, 'f', 1)
+                             .arg(runner.failedImages());
+
+    return runner.failedImages() > 0 ? 1 : 0;
+}
@@ -0,0 +1,335 @@
+#include <QtNodes/TaskScheduler>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include "BlendKernel.hpp"
+#include "BlendModes.hpp"
+#include "BrightnessContrastKernel.hpp"
+#include "ConvolutionKernel.hpp"
+#include "EdgeDetectionKernel.hpp"
+#include "GaussianBlurKernel.hpp"
+#include "ImageBuffer.hpp"
+#include "ImageData.hpp"
+#include "ImageKernel.hpp"
+#include "ImageRequest.hpp"
+#include "NoiseKernel.hpp"
+#include "Simd.hpp"
+#include "ThresholdKernel.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using QtNodes::TaskScheduler;
+
+namespace {
+
+struct Resolution
+{
+    QString name;
+    int width;
+    int height;
+};
+
+std::vector<Resolution> const resolutions{{"512", 512, 512},
+                                          {"2K", 2048, 1080},
+                                          {"4K", 3840, 2160},
+                                          {"8K", 7680, 4320}};
+
+ImageBuffer::Format format(int channels)
+{
+    switch (channels) {
+    case 1:
+        return ImageBuffer::Format::Gray8;
+    case 4:
+        return ImageBuffer::Format::BGRA8888;
+    }
+
+    return ImageBuffer::Format::BGR888;
+}
+
+/// A kernel of the editor with the parameters it is measured at.
+struct Case
+{
+    QString kernel;
+    QString variant;
+
+    std::shared_ptr<ImageKernel const> op;
+
+    /// Images the kernel blends, 0 for the generators.
+    int inputs;
+};
+
+/// Every kernel that works on frames of `channels` channels, `width` pixels wide.
+std::vector<Case> cases(int channels, int width)
+{
+    std::vector<Case> result;
+
+    {
+        BrightnessContrastKernel::Parameters parameters;
+        parameters.brightness = 20;
+        parameters.contrast = 35;
+        result.push_back({"brightness-contrast", "20/35",
+                          std::make_shared<BrightnessContrastKernel const>(parameters), 1});
+    }
+
+    {
+        ThresholdKernel::Parameters parameters;
+        parameters.threshold = 128;
+        result.push_back({"threshold", "128", std::make_shared<ThresholdKernel const>(parameters), 1});
+    }
+
+    for (int const radius : {5, 48}) {
+        GaussianBlurKernel::Parameters parameters;
+        parameters.radius = radius;
+        result.push_back({"gaussian-blur", QString("radius %1").arg(radius),
+                          std::make_shared<GaussianBlurKernel const>(parameters), 1});
+    }
+
+    for (bool const sobel : {true, false}) {
+        EdgeDetectionKernel::Parameters parameters;
+        parameters.sobel = sobel;
+        result.push_back({"edge-detection", sobel ? "sobel" : "canny",
+                          std::make_shared<EdgeDetectionKernel const>(parameters), 1});
+    }
+
+    // The alpha blend needs the alpha channel, the others blend the colors.
+    for (QString const &mode : BlendModes::names()) {
+        BlendKernel::Parameters parameters;
+        parameters.mode = mode;
+        parameters.alpha = channels == 4;
+        result.push_back({"blend", mode.toLower(), std::make_shared<BlendKernel const>(parameters), 2});
+    }
+
+    for (int const size : {3, 5}) {
+        for (QString const &preset : {QString("Sharpen"), QString("Emboss"), QString("Edge Enhance")}) {
+            ConvolutionKernel::Parameters parameters;
+            parameters.preset = preset;
+            parameters.kernelSize = size;
+            result.push_back({"convolution", QString("%1 %2x%2").arg(preset.toLower()).arg(size),
+                              std::make_shared<ConvolutionKernel const>(parameters), 1});
+        }
+    }
+
+    // The noise comes in gray and as a displacement map in three channels.
+    if (channels != 4) {
+        for (QString const &type : {QString("Perlin"), QString("Simplex"), QString("Worley")}) {
+            NoiseKernel::Parameters parameters;
+            parameters.type = type;
+            parameters.scale = 100;
+            parameters.displacement = channels == 3;
+            parameters.resolution = width;
+            result.push_back({"noise", type.toLower(), std::make_shared<NoiseKernel const>(parameters), 0});
+        }
+    }
+
+    return result;
+}
+
+/// @returns the fastest of `repeats` runs in seconds.
+double measure(int repeats, std::function<void()> const &run)
+{
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < repeats; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        run();
+        best = std::min(best, timer.nsecsElapsed() / 1e9);
+    }
+
+    return best;
+}
+
+/// Identifies a result across builds.
+QString key(QJsonObject const &result)
+{
+    return QString("%1|%2|%3|%4")
+        .arg(result["kernel"].toString(),
+             result["variant"].toString(),
+             result["size"].toString())
+        .arg(result["channels"].toInt());
+}
+
+/// The megapixels per second of the results in the file written by an earlier run.
+QHash<QString, double> loadBaseline(QString const &fileName)
+{
+    QHash<QString, double> baseline;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning().noquote() << "Cannot read the baseline" << fileName;
+        return baseline;
+    }
+
+    QJsonArray const results = QJsonDocument::fromJson(file.readAll()).object()["results"].toArray();
+    for (QJsonValue const &value : results) {
+        QJsonObject const result = value.toObject();
+        baseline.insert(key(result), result["megapixelsPerSecond"].toDouble());
+    }
+
+    return baseline;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures every image kernel at 512², 2K, 4K and 8K in 1, 3 and 4 channels, "
+        "in megapixels per second.");
+    parser.addHelpOption();
+
+    QCommandLineOption jsonOption("json", "Writes the results to the file.", "file");
+    parser.addOption(jsonOption);
+
+    QCommandLineOption baselineOption("baseline",
+                                      "Compares the results with those of an earlier run.",
+                                      "file");
+    parser.addOption(baselineOption);
+
+    QCommandLineOption labelOption("label", "Name of the build in the results.", "label");
+    parser.addOption(labelOption);
+
+    QCommandLineOption sizesOption("sizes", "Resolutions to run.", "list", "512,2K,4K,8K");
+    parser.addOption(sizesOption);
+
+    QCommandLineOption channelsOption("channels", "Channel counts to run.", "list", "1,3,4");
+    parser.addOption(channelsOption);
+
+    QCommandLineOption filterOption("filter", "Runs the kernels whose name contains the text.", "text");
+    parser.addOption(filterOption);
+
+    QCommandLineOption repeatsOption("repeats", "Runs per measurement, the fastest counts.", "count", "3");
+    parser.addOption(repeatsOption);
+
+    QCommandLineOption threadsOption("threads", "Worker threads, 0 uses all the cores.", "count", "0");
+    parser.addOption(threadsOption);
+
+    parser.process(app);
+
+    QStringList const sizes = parser.value(sizesOption).split(',');
+    QStringList const channelCounts = parser.value(channelsOption).split(',');
+    QString const filter = parser.value(filterOption);
+    int const repeats = std::max(1, parser.value(repeatsOption).toInt());
+
+    TaskScheduler &scheduler = TaskScheduler::globalInstance();
+    scheduler.setWorkerCount(parser.value(threadsOption).toUInt());
+    int const threads = static_cast<int>(scheduler.workerCount());
+
+    QHash<QString, double> const baseline = parser.isSet(baselineOption)
+                                                ? loadBaseline(parser.value(baselineOption))
+                                                : QHash<QString, double>();
+
+    qInfo().noquote() << QString("OpenCV %1, %2, %3 threads")
+                             .arg(CV_VERSION, Simd::name(Simd::supported()))
+                             .arg(threads);
+
+    QJsonArray results;
+
+    for (Resolution const &resolution : resolutions) {
+        if (!sizes.contains(resolution.name, Qt::CaseInsensitive))
+            continue;
+
+        double const megapixels = resolution.width * static_cast<double>(resolution.height) / 1e6;
+
+        // The noise is square, the request crops it to the frame.
+        auto const request = std::make_shared<ImageRequest const>(
+            QRectF(0, 0, 1, resolution.height / static_cast<double>(resolution.width)),
+            QSizeF(resolution.width, resolution.width));
+
+        for (QString const &channelCount : channelCounts) {
+            int const channels = channelCount.toInt();
+            if (channels != 1 && channels != 3 && channels != 4)
+                continue;
+
+            ImageBuffer::Format const frameFormat = format(channels);
+
+            // Two random frames, the second one is the top layer of the blends.
+            std::vector<std::shared_ptr<ImageData>> frames;
+            for (int i = 0; i < 2; ++i) {
+                cv::Mat frame(resolution.height, resolution.width, CV_8UC(channels));
+                cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+                frames.push_back(std::make_shared<ImageData>(ImageBuffer::fromMat(frame, frameFormat)));
+            }
+
+            qInfo().noquote() << QString("%1 x %2, %3 channels, %4 MP")
+                                     .arg(resolution.width)
+                                     .arg(resolution.height)
+                                     .arg(channels)
+                                     .arg(megapixels, 0, 'f', 1);
+
+            for (Case const &test : cases(channels, resolution.width)) {
+                QString const name = QString("%1 %2").arg(test.kernel, test.variant);
+                if (!filter.isEmpty() && !name.contains(filter, Qt::CaseInsensitive))
+                    continue;
+
+                ImageKernel::Inputs const inputs(frames.begin(), frames.begin() + test.inputs);
+
+                // The format conversions are cached in the frames, the fastest run leaves them out.
+                double const seconds = measure(repeats, [&]() {
+                    test.op->compute(inputs, test.inputs == 0 ? request : nullptr, {});
+                });
+
+                QJsonObject result;
+                result["kernel"] = test.kernel;
+                result["variant"] = test.variant;
+                result["size"] = resolution.name;
+                result["width"] = resolution.width;
+                result["height"] = resolution.height;
+                result["channels"] = channels;
+                result["seconds"] = seconds;
+                result["megapixelsPerSecond"] = megapixels / seconds;
+                results.append(result);
+
+                QString line = QString("%1 %2 ms %3 MP/s")
+                                   .arg(name, -32)
+                                   .arg(seconds * 1000.0, 9, 'f', 1)
+                                   .arg(megapixels / seconds, 9, 'f', 1);
+
+                auto const previous = baseline.find(key(result));
+                if (previous != baseline.end() && previous.value() > 0.0)
+                    line += QString(" %1x").arg(megapixels / seconds / previous.value(), 6, 'f', 2);
+
+                qInfo().noquote() << line;
+            }
+        }
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QJsonObject document;
+        document["label"] = parser.value(labelOption);
+        document["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        document["qt"] = QString(qVersion());
+        document["opencv"] = QString(CV_VERSION);
+        document["simd"] = Simd::name(Simd::supported());
+        document["threads"] = threads;
+        document["repeats"] = repeats;
+        document["results"] = results;
+
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(document).toJson()) < 0) {
+            qWarning().noquote() << "Cannot write" << parser.value(jsonOption);
+            return 1;
+        }
+    }
+
+    return 0;
+}
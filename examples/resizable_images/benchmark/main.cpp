@@ -0,0 +1,283 @@
+#include <QtNodes/TaskScheduler>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+
+#include "BlendModes.hpp"
+#include "BrightnessContrastKernel.hpp"
+#include "BrightnessContrastSimd.hpp"
+#include "Convolution.hpp"
+#include "ImageBuffer.hpp"
+#include "GaussianBlur.hpp"
+#include "ImageData.hpp"
+#include "NoiseKernel.hpp"
+#include "PresetConvolution.hpp"
+#include "Simd.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using QtNodes::TaskScheduler;
+
+namespace {
+
+int const brightness = 20;
+int const contrast = 35;
+
+/// The per-pixel implementation the kernel replaced.
+void referenceBrightnessContrast(QImage &img)
+{
+    for (int y = 0; y < img.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(img.scanLine(y));
+        for (int x = 0; x < img.width(); ++x) {
+            QColor clr = QColor::fromRgba(line[x]);
+            int r = qBound(0, ((clr.red() - 127) * contrast / 100) + 127 + brightness, 255);
+            int g = qBound(0, ((clr.green() - 127) * contrast / 100) + 127 + brightness, 255);
+            int b = qBound(0, ((clr.blue() - 127) * contrast / 100) + 127 + brightness, 255);
+            line[x] = qRgba(r, g, b, clr.alpha());
+        }
+    }
+}
+
+/// @returns the fastest of `repeats` runs in seconds.
+double measure(int repeats, std::function<void()> const &run)
+{
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < repeats; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        run();
+        best = std::min(best, timer.nsecsElapsed() / 1e9);
+    }
+
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures the brightness/contrast, blend, blur, convolution and noise kernels in megapixels per second.");
+    parser.addHelpOption();
+
+    QCommandLineOption widthOption("width", "Width of the frame.", "pixels", "6000");
+    parser.addOption(widthOption);
+
+    QCommandLineOption heightOption("height", "Height of the frame.", "pixels", "4000");
+    parser.addOption(heightOption);
+
+    QCommandLineOption repeatsOption("repeats", "Runs per variant, the fastest counts.", "count", "5");
+    parser.addOption(repeatsOption);
+
+    QCommandLineOption threadsOption("threads", "Worker threads, 0 uses all the cores.", "count", "0");
+    parser.addOption(threadsOption);
+
+    parser.process(app);
+
+    int const width = parser.value(widthOption).toInt();
+    int const height = parser.value(heightOption).toInt();
+    int const repeats = std::max(1, parser.value(repeatsOption).toInt());
+
+    TaskScheduler &scheduler = TaskScheduler::globalInstance();
+    scheduler.setWorkerCount(parser.value(threadsOption).toUInt());
+
+    // The byte order of QImage::Format_ARGB32, which the reference works on.
+    cv::Mat frame(height, width, CV_8UC4);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    double const megapixels = width * static_cast<double>(height) / 1e6;
+
+    auto report = [megapixels](QString const &variant, int threads, double seconds) {
+        qInfo().noquote() << QString("%1 %2 threads %3 ms %4 MP/s")
+                                 .arg(variant, -24)
+                                 .arg(threads, 3)
+                                 .arg(seconds * 1000.0, 9, 'f', 1)
+                                 .arg(megapixels / seconds, 9, 'f', 1);
+    };
+
+    qInfo().noquote() << QString("%1 x %2 BGRA8888, %3 MP").arg(width).arg(height).arg(megapixels, 0, 'f', 1);
+
+    {
+        QImage const source(frame.data, width, height, static_cast<int>(frame.step), QImage::Format_ARGB32);
+
+        double const seconds = measure(repeats, [&source]() {
+            QImage image = source.copy();
+            referenceBrightnessContrast(image);
+        });
+
+        // The copy is part of the reference, it modified its own QImage.
+        report("reference (QColor)", 1, seconds);
+    }
+
+    BrightnessContrastKernel::Parameters parameters;
+    parameters.brightness = brightness;
+    parameters.contrast = contrast;
+    auto const kernel = std::make_shared<BrightnessContrastKernel const>(parameters);
+
+    cv::Mat output(frame.size(), frame.type());
+
+    {
+        auto const table = kernel->lookupTable(ImageBuffer::Format::BGRA8888);
+        double const seconds = measure(repeats, [&]() { table->apply(frame, output); });
+        report("lookup table", 1, seconds);
+    }
+
+    using InstructionSet = Simd::InstructionSet;
+
+    for (InstructionSet const instructionSet :
+         {InstructionSet::Scalar, InstructionSet::Sse41, InstructionSet::Avx2}) {
+        Simd::setInstructionSet(instructionSet);
+        if (Simd::instructionSet() != instructionSet)
+            continue;
+
+        double const seconds = measure(repeats, [&]() {
+            BrightnessContrastSimd::apply(frame, output, brightness, contrast);
+        });
+        report(Simd::name(instructionSet), 1, seconds);
+    }
+
+    Simd::setInstructionSet(Simd::supported());
+
+    {
+        // The way the model runs it, in tiles spread over the workers.
+        ImageKernel::Inputs const inputs{
+            std::make_shared<ImageData>(ImageBuffer::fromMat(frame, ImageBuffer::Format::BGRA8888))};
+
+        double const seconds = measure(repeats, [&]() { kernel->compute(inputs, nullptr, {}); });
+        report(QString("tiled %1").arg(Simd::name(Simd::supported())),
+               static_cast<int>(scheduler.workerCount()),
+               seconds);
+    }
+
+    // Blending, every mode on every path, single-threaded.
+    cv::Mat top(frame.size(), frame.type());
+    cv::randu(top, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    cv::Mat bottomColor;
+    cv::Mat topColor;
+    cv::cvtColor(frame, bottomColor, cv::COLOR_BGRA2BGR);
+    cv::cvtColor(top, topColor, cv::COLOR_BGRA2BGR);
+    cv::Mat blended(bottomColor.size(), bottomColor.type());
+
+    for (QString const &name : BlendModes::names()) {
+        BlendModes::Mode const mode = BlendModes::mode(name);
+
+        for (InstructionSet const instructionSet :
+             {InstructionSet::Scalar, InstructionSet::Sse41, InstructionSet::Avx2}) {
+            Simd::setInstructionSet(instructionSet);
+            if (Simd::instructionSet() != instructionSet)
+                continue;
+
+            double seconds = measure(repeats, [&]() {
+                BlendModes::blend(mode, bottomColor, topColor, blended, false);
+            });
+            report(QString("%1 %2").arg(name, Simd::name(instructionSet)), 1, seconds);
+
+            seconds = measure(repeats, [&]() { BlendModes::blend(mode, frame, top, output, true); });
+            report(QString("%1 alpha %2").arg(name, Simd::name(instructionSet)), 1, seconds);
+        }
+    }
+
+    Simd::setInstructionSet(Simd::supported());
+
+    // Blurring on all the workers, the cost should not grow with the radius.
+    cv::Rect const whole(0, 0, width, height);
+    for (int const radius : {3, 9, 24, 48, 96, 192}) {
+        double const sigma = radius / 3.0;
+        double const seconds = measure(repeats, [&]() { GaussianBlur::blur(frame, whole, sigma); });
+        report(QString("blur radius %1 %2")
+                   .arg(radius)
+                   .arg(sigma < GaussianBlur::recursiveSigma() ? "separable" : "recursive"),
+               static_cast<int>(scheduler.workerCount()),
+               seconds);
+    }
+
+    // Convolving the colors, every strategy the kernel allows. The direct
+    // filter of a large kernel is the cost the other strategies avoid.
+    cv::Mat randomKernel(31, 31, CV_32F);
+    cv::randu(randomKernel, cv::Scalar(-1.0), cv::Scalar(1.0));
+    randomKernel /= cv::sum(randomKernel)[0];
+
+    cv::Mat const boxKernel = cv::Mat::ones(31, 31, CV_32F) / (31.0 * 31.0);
+    cv::Mat const smallKernel = cv::Mat(randomKernel, cv::Rect(0, 0, 5, 5)).clone();
+
+    using Strategy = Convolution::Strategy;
+
+    struct Case
+    {
+        QString name;
+        cv::Mat kernel;
+    };
+
+    for (Case const &test : {Case{"box", boxKernel}, Case{"random", randomKernel}, Case{"random", smallKernel}}) {
+        for (Strategy const strategy : {Strategy::Direct, Strategy::Separable, Strategy::Fourier}) {
+            cv::Mat column;
+            cv::Mat row;
+            if (strategy == Strategy::Separable && !Convolution::separate(test.kernel, column, row))
+                continue;
+
+            double const seconds = measure(repeats, [&]() {
+                Convolution::convolve(bottomColor, whole, test.kernel, strategy);
+            });
+            report(QString("convolve %1x%1 %2 %3")
+                       .arg(test.kernel.rows)
+                       .arg(test.name, Convolution::name(strategy)),
+                   static_cast<int>(scheduler.workerCount()),
+                   seconds);
+        }
+    }
+
+    // The compiled presets against the float filter they replace.
+    for (int const size : {3, 5}) {
+        for (QString const &preset : {QString("Sharpen"), QString("Emboss"), QString("Edge Enhance")}) {
+            cv::Mat const kernel = PresetConvolution::matrix(preset, size);
+
+            double seconds = measure(repeats, [&]() {
+                Convolution::convolve(bottomColor, whole, kernel, Strategy::Direct);
+            });
+            report(QString("%1 %2x%2 float").arg(preset).arg(size),
+                   static_cast<int>(scheduler.workerCount()),
+                   seconds);
+
+            seconds = measure(repeats, [&]() {
+                PresetConvolution::convolve(bottomColor, whole, preset, size);
+            });
+            report(QString("%1 %2x%2 integer").arg(preset).arg(size),
+                   static_cast<int>(scheduler.workerCount()),
+                   seconds);
+        }
+    }
+
+    // A 4K displacement map of every noise type.
+    for (QString const &type : {QString("Perlin"), QString("Simplex"), QString("Worley")}) {
+        NoiseKernel::Parameters noiseParameters;
+        noiseParameters.type = type;
+        noiseParameters.scale = 100;
+        noiseParameters.resolution = 4096;
+        noiseParameters.displacement = true;
+        NoiseKernel const noise(noiseParameters);
+
+        double const seconds = measure(repeats, [&]() { noise.compute({}, nullptr, {}); });
+        double const noiseMegapixels = 4096.0 * 4096.0 / 1e6;
+        qInfo().noquote() << QString("%1 %2 threads %3 ms %4 MP/s")
+                                 .arg(QString("noise 4K %1 x2").arg(type), -24)
+                                 .arg(static_cast<int>(scheduler.workerCount()), 3)
+                                 .arg(seconds * 1000.0, 9, 'f', 1)
+                                 .arg(noiseMegapixels / seconds, 9, 'f', 1);
+    }
+
+    return 0;
+}
@@ -4,18 +4,16 @@
 #include <QtNodes/NodeData>
 #include <QtNodes/NodeDelegateModelRegistry>
 
+#include <QtCore/QCommandLineParser>
 #include <QtGui/QScreen>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QMenuBar>
+#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QVBoxLayout>
 
-#include "ImageLoaderModel.hpp"
-#include "ImageShowModel.hpp"
-#include "BrightnessContrastModel.hpp"
-#include "GaussianBlurModel.hpp"
-#include "ThresholdModel.hpp"
-#include "EdgeDetectionModel.hpp"
-#include "BlendModel.hpp"
-#include "NoiseGenerationModel.hpp"
-#include "ConvolutionFilterModel.hpp"
+#include "ModelRegistry.hpp"
+#include "ProxyPreview.hpp"
 
 using QtNodes::ConnectionStyle;
 using QtNodes::DataFlowGraphicsScene;
@@ -23,50 +21,94 @@ using QtNodes::DataFlowGraphModel;
 using QtNodes::GraphicsView;
 using QtNodes::NodeDelegateModelRegistry;
 
-static std::shared_ptr<NodeDelegateModelRegistry> registerDataModels()
+/// The saved graphs can be run over directories of images by `resizable_images_batch`.
+static QMenuBar *createSaveRestoreMenu(DataFlowGraphicsScene *scene,
+                                       GraphicsView &view,
+                                       DataFlowGraphModel &model)
 {
-    auto ret = std::make_shared<NodeDelegateModelRegistry>();
-    ret->registerModel<ImageShowModel>();
-
-    ret->registerModel<ImageLoaderModel>();
-
-    ret->registerModel<BrightnessContrastModel>();
-
-    ret->registerModel<GaussianBlurModel>();
-
-    ret->registerModel<ThresholdModel>();
-
-    ret->registerModel<EdgeDetectionModel>();
-
-    ret->registerModel<BlendModel>();
-
-    ret->registerModel<NoiseGenerationModel>();
-
-    ret->registerModel<ConvolutionFilterModel>();
-
-
-
-
-    return ret;
+    auto menuBar = new QMenuBar();
+    QMenu *menu = menuBar->addMenu("File");
+    auto saveAction = menu->addAction("Save Scene");
+    auto loadAction = menu->addAction("Load Scene");
+    menu->addSeparator();
+    auto traceAction = menu->addAction("Record Trace");
+    traceAction->setCheckable(true);
+
+    // Tints the nodes by their compute time, to spot the bottleneck of a graph.
+    menuBar->addMenu("View")->addAction(view.computeCostAction());
+
+    QObject::connect(saveAction, &QAction::triggered, scene, [scene] { scene->save(); });
+
+    QObject::connect(loadAction, &QAction::triggered, scene, [scene, &view] {
+        if (scene->load())
+            view.centerScene();
+    });
+
+    // The spans of the node evaluations until unchecked, for Perfetto or chrome://tracing.
+    QObject::connect(traceAction, &QAction::toggled, scene, [&model, &view](bool recording) {
+        if (recording) {
+            model.computationTrace().start();
+            return;
+        }
+
+        model.computationTrace().stop();
+
+        QString const fileName = QFileDialog::getSaveFileName(&view,
+                                                              "Save Trace",
+                                                              "trace.json",
+                                                              "Chrome Trace (*.json)");
+        if (fileName.isEmpty())
+            return;
+
+        if (!model.computationTrace().writeChromeTrace(fileName))
+            QMessageBox::warning(&view, "Save Trace", QString("Could not write %1.").arg(fileName));
+    });
+
+    return menuBar;
 }
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+
+    QCommandLineOption proxyFactorOption("proxy-factor",
+                                         "Scale of the images processed while dragging a slider, "
+                                         "1 disables the preview mode.",
+                                         "factor",
+                                         "0.25");
+    parser.addOption(proxyFactorOption);
+    parser.process(app);
+
+    ProxyPreview::instance().setProxyFactor(parser.value(proxyFactorOption).toDouble());
+
     std::shared_ptr<NodeDelegateModelRegistry> registry = registerDataModels();
 
     DataFlowGraphModel dataFlowGraphModel(registry);
 
-    DataFlowGraphicsScene scene(dataFlowGraphModel);
+    // Keeps the GUI responsive while the nodes process large images.
+    dataFlowGraphModel.setAsyncExecution(true);
+
+    // Main app window holding menu and a scene view.
+    QWidget window;
+    window.setWindowTitle("Mixar Final-v3 Project");
+    window.resize(800, 600);
+
+    auto scene = new DataFlowGraphicsScene(dataFlowGraphModel, &window);
+
+    GraphicsView view(scene);
 
-    GraphicsView view(&scene);
+    QVBoxLayout *l = new QVBoxLayout(&window);
+    l->setContentsMargins(0, 0, 0, 0);
+    l->setSpacing(0);
+    l->addWidget(createSaveRestoreMenu(scene, view, dataFlowGraphModel));
+    l->addWidget(&view);
 
-    view.setWindowTitle("Mixar Final-v3 Project");
-    view.resize(800, 600);
     // Center window.
-    view.move(QApplication::primaryScreen()->availableGeometry().center() - view.rect().center());
-    view.show();
+    window.move(QApplication::primaryScreen()->availableGeometry().center() - window.rect().center());
+    window.show();
 
     return app.exec();
 }
@@ -124,6 +124,9 @@ QVariant SimpleGraphModel::nodeData(NodeId nodeId, NodeRole role) const
     case NodeRole::Widget:
         result = QVariant();
         break;
+
+    case NodeRole::ComputeCost:
+        break;
     }
 
     return result;
@@ -169,6 +172,9 @@ bool SimpleGraphModel::setNodeData(NodeId nodeId, NodeRole role, QVariant value)
 
     case NodeRole::Widget:
         break;
+
+    case NodeRole::ComputeCost:
+        break;
     }
 
     return result;
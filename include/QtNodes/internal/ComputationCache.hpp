@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Export.hpp"
+#include "NodeData.hpp"
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * Memoized node outputs with a least-recently-used byte budget.
+ *
+ * An entry is keyed on the name of the node model, the snapshot of its
+ * parameters (@see NodeDelegateModel::computationParameters) and the
+ * identities of its input data (@see NodeData::identity). Nodes with the
+ * same model, parameters and inputs therefore share their results, which
+ * makes reconnecting a wire or restoring a deleted node instant. The
+ * parameters are compared in full, colliding hashes never share a result.
+ *
+ * The cache is owned by DataFlowGraphModel and only accessed from the
+ * thread of the models.
+ */
+class NODE_EDITOR_PUBLIC ComputationCache
+{
+public:
+    struct Key
+    {
+        QString modelName;
+        QJsonObject parameters;
+        std::vector<std::size_t> inputs;
+
+        bool operator==(Key const &other) const
+        {
+            return inputs == other.inputs && modelName == other.modelName
+                   && parameters == other.parameters;
+        }
+    };
+
+    using Outputs = std::vector<std::shared_ptr<NodeData>>;
+
+public:
+    /// @param byteBudget `0` disables the cache.
+    explicit ComputationCache(std::size_t byteBudget = 512 * 1024 * 1024);
+
+public:
+    /// Looks the key up and counts a hit or a miss.
+    bool find(Key const &key, Outputs &outputs);
+
+    /// Stores `outputs`, evicting the least recently used entries over budget.
+    void insert(Key const &key, Outputs outputs);
+
+    void clear();
+
+public:
+    std::size_t byteBudget() const { return _byteBudget; }
+
+    void setByteBudget(std::size_t byteBudget);
+
+    std::size_t usedBytes() const { return _usedBytes; }
+
+    std::size_t entryCount() const { return _entries.size(); }
+
+    std::size_t hits() const { return _hits; }
+
+    std::size_t misses() const { return _misses; }
+
+    void resetStatistics();
+
+private:
+    struct KeyHash
+    {
+        std::size_t operator()(Key const &key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        Outputs outputs;
+        std::size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void evict();
+
+private:
+    std::size_t _byteBudget;
+
+    std::size_t _usedBytes;
+
+    std::size_t _hits;
+
+    std::size_t _misses;
+
+    /// The most recently used entries come first.
+    EntryList _entries;
+
+    std::unordered_map<Key, EntryList::iterator, KeyHash> _index;
+};
+
+} // namespace QtNodes
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Definitions.hpp"
+#include "Export.hpp"
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * Timing spans of the node evaluations, exported as Chrome trace events.
+ *
+ * While recording, DataFlowGraphModel adds a span for every node it
+ * delivers inputs to and NodeDelegateModel one for every computation
+ * started with `runComputation`, on the thread that ran it. The
+ * computation spans of synchronous models nest in their evaluation
+ * spans, those of asynchronous models appear on the worker threads.
+ *
+ * The spans are recorded from any thread. The file written by
+ * `writeChromeTrace` opens in Perfetto and `chrome://tracing`.
+ */
+class NODE_EDITOR_PUBLIC ComputationTrace
+{
+public:
+    enum class SpanKind
+    {
+        /// Delivering the inputs to the node, including synchronous work.
+        Evaluation,
+        /// A `runComputation` task, or the restoration of its cached outputs.
+        Computation,
+    };
+
+    struct Span
+    {
+        NodeId nodeId;
+        QString modelName;
+        SpanKind kind;
+
+        /// The outputs were restored from the ComputationCache.
+        bool cached;
+
+        /// NodeData::byteSize of the data at every input port, 0 for missing data.
+        std::vector<std::size_t> inputBytes;
+
+        /// Nanoseconds since `start`.
+        std::int64_t start;
+        std::int64_t duration;
+
+        /// Small number of the recording thread, 0 for the thread that called `start`.
+        int thread;
+    };
+
+public:
+    ComputationTrace();
+
+public:
+    /// Drops the recorded spans, restarts the clock and starts recording.
+    void start();
+
+    void stop();
+
+    bool recording() const { return _recording; }
+
+    /// Nanoseconds since `start`.
+    std::int64_t now() const;
+
+    /// Adds `span` while recording, its `thread` is set to the calling one.
+    void record(Span span);
+
+    std::vector<Span> spans() const;
+
+    void clear();
+
+public:
+    /// The spans as complete events ("ph": "X"), with the thread names as metadata.
+    QJsonObject toChromeTrace() const;
+
+    /// @returns `false` if the file could not be written.
+    bool writeChromeTrace(QString const &fileName) const;
+
+private:
+    /// @returns the number of the calling thread. `_mutex` must be locked.
+    int threadNumber();
+
+private:
+    std::atomic<bool> _recording;
+
+    /// The steady clock at `start` in nanoseconds, read by the workers.
+    std::atomic<std::int64_t> _origin;
+
+    mutable std::mutex _mutex;
+
+    std::vector<Span> _spans;
+
+    std::unordered_map<std::thread::id, int> _threads;
+};
+
+} // namespace QtNodes
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "AbstractGraphModel.hpp"
+#include "ComputationCache.hpp"
+#include "ComputationTrace.hpp"
+#include "ConnectionIdHash.hpp"
 #include "ConnectionIdUtils.hpp"
 #include "NodeDelegateModelRegistry.hpp"
 #include "Serializable.hpp"
@@ -11,6 +14,10 @@
 #include <QJsonObject>
 
 #include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace QtNodes {
 
@@ -78,6 +85,31 @@ public:
 
     void load(QJsonObject const &json) override;
 
+    /// Makes the current and future nodes run their computations on worker threads.
+    /**
+   * @see NodeDelegateModel::runComputation
+   */
+    void setAsyncExecution(bool async);
+
+    bool asyncExecution() const { return _asyncExecution; }
+
+    /// Memoized outputs of the nodes, with the byte budget and hit/miss counters.
+    /**
+   * @see NodeDelegateModel::cacheable
+   */
+    ComputationCache &computationCache() { return *_computationCache; }
+
+    ComputationCache const &computationCache() const { return *_computationCache; }
+
+    /// Timing spans of the node evaluations, recorded between `start` and `stop`.
+    /**
+   * `computationTrace().writeChromeTrace(fileName)` dumps them as Chrome
+   * trace events, @see ComputationTrace.
+   */
+    ComputationTrace &computationTrace() { return *_computationTrace; }
+
+    ComputationTrace const &computationTrace() const { return *_computationTrace; }
+
     /**
    * Fetches the NodeDelegateModel for the given `nodeId` and tries to cast the
    * stored pointer to the given type
@@ -97,23 +129,104 @@ public:
 Q_SIGNALS:
     void inPortDataWasSet(NodeId const, PortType const, PortIndex const);
 
+    /// The node started computing, possibly on a worker thread.
+    void nodeComputingStarted(NodeId const nodeId);
+
+    /// The last running computation of the node applied its result.
+    void nodeComputingFinished(NodeId const nodeId);
+
 private:
     NodeId newNodeId() override { return _nextNodeId++; }
 
+    /// Forwards the signals of a freshly created delegate model.
+    void connectDelegateModel(NodeId const nodeId, NodeDelegateModel *model);
+
+    /// Adds the connection to `_connectivity` and to the index of both its ports.
+    void insertConnection(ConnectionId const connectionId);
+
+    /// @returns `false` if the connection did not exist.
+    bool eraseConnection(ConnectionId const connectionId);
+
+    /// The connections at all the `portType` ports of the node, in O(ports + degree).
+    std::vector<ConnectionId> nodeConnections(NodeId const nodeId, PortType const portType) const;
+
     void sendConnectionCreation(ConnectionId const connectionId);
 
     void sendConnectionDeletion(ConnectionId const connectionId);
 
+    /// Delivers the data of dirty connections to the nodes downstream.
+    /**
+   * The nodes with dirty inputs and everything downstream of them are
+   * sorted topologically and visited once. A node receives the data of all
+   * its dirty input connections and then recomputes once via
+   * NodeDelegateModel::inputsUpdated. Connections dirtied while visiting a
+   * node are consumed later in the same pass.
+   *
+   * Nodes downstream of a node computing on a worker thread are not
+   * visited until its result arrives. Their dirty inputs stay marked and
+   * the evaluation resumes on NodeDelegateModel::computingFinished, so
+   * independent branches run in parallel while a node joining several
+   * branches still waits for all of them and computes once.
+   */
+    void evaluate();
+
+    /// Delivers the dirty inputs to `nodeId` and lets it recompute.
+    /**
+   * @returns `false` if the node had no dirty inputs.
+   */
+    bool evaluateNode(NodeId const nodeId);
+
+    /**
+   * Drops the pending results of the computing nodes downstream of
+   * `nodeId`, they were computed from the data `nodeId` is about to
+   * replace. Only the nodes in `_computingNodes` are looked at.
+   */
+    void cancelDownstreamComputations(NodeId const nodeId);
+
+    /**
+   * Merges the `inRequest`s of the consumers into the output requests of
+   * `nodes`. Where a request changed, the nodes upstream are merged in
+   * turn, the walk stops at unchanged requests. Nodes whose output no
+   * longer covers their request are evaluated again.
+   */
+    void propagateRequests(std::unordered_set<NodeId> const &nodes);
+
+    /// @returns `true` if the request of the output port changed.
+    bool updateOutRequest(NodeId const nodeId,
+                          PortIndex const portIndex,
+                          std::unordered_set<NodeId> &staleNodes);
+
+    /// The nodes attached to the output ports of `nodeId`, once per connection.
+    std::vector<NodeId> successors(NodeId const nodeId) const;
+
+    /// The nodes attached to the input ports of `nodeId`, once per connection.
+    std::vector<NodeId> predecessors(NodeId const nodeId) const;
+
+    /// @returns all the nodes reachable from the output ports of `roots`.
+    std::unordered_set<NodeId> downstreamNodes(std::unordered_set<NodeId> const &roots) const;
+
+    /// @returns `true` if `nodeId` is reachable from the input ports of `target`.
+    bool isUpstreamOf(NodeId const nodeId, NodeId const target) const;
+
+    /// @returns `sources` and all the nodes downstream in topological order.
+    /**
+   * Nodes participating in cycles cannot be ordered. They are appended
+   * to the end so that every node is still visited.
+   */
+    std::vector<NodeId> topologicalOrder(std::unordered_set<NodeId> const &sources) const;
+
 private Q_SLOTS:
     /**
-   * Fuction is called in three cases:
+   * Fuction is called in two cases:
    *
    * - By underlying NodeDelegateModel when a node has new data to propagate.
    *   @see DataFlowGraphModel::addNode
-   * - When a new connection is created.
-   *   @see DataFlowGraphModel::addConnection
    * - When a node restored from JSON an needs to send data downstream.
    *   @see DataFlowGraphModel::loadNode
+   *
+   * The connections of the port are marked dirty. Outside of a running
+   * evaluation pass a new pass is started, otherwise they are consumed by
+   * the current one.
    */
     void onOutPortDataUpdated(NodeId const nodeId, PortIndex const portIndex);
 
@@ -129,7 +242,32 @@ private:
 
     std::unordered_set<ConnectionId> _connectivity;
 
+    using PortKey = std::tuple<NodeId, PortType, PortIndex>;
+
+    /// The connections of every port with any, kept in step with `_connectivity`.
+    std::unordered_map<PortKey, std::unordered_set<ConnectionId>> _portConnections;
+
     mutable std::unordered_map<NodeId, NodeGeometryData> _nodeGeometryData;
+
+    /// Connections whose output data changed and was not yet delivered.
+    std::unordered_set<ConnectionId> _dirtyConnections;
+
+    bool _evaluating;
+
+    /// The nodes between NodeDelegateModel::computingStarted and computingFinished.
+    std::unordered_set<NodeId> _computingNodes;
+
+    /// The merged requests passed to NodeDelegateModel::setOutRequest.
+    std::unordered_map<std::pair<NodeId, PortIndex>, std::shared_ptr<NodeDataRequest const>>
+        _outRequests;
+
+    bool _asyncExecution;
+
+    /// Shared with the delegate models which may outlive the graph model.
+    std::shared_ptr<ComputationCache> _computationCache;
+
+    /// Shared with the delegate models and their running computations.
+    std::shared_ptr<ComputationTrace> _computationTrace;
 };
 
 } // namespace QtNodes
@@ -30,5 +30,25 @@ public:
     void drawEntryLabels(QPainter *painter, NodeGraphicsObject &ngo) const;
 
     void drawResizeRect(QPainter *painter, NodeGraphicsObject &ngo) const;
+
+    /// Busy indicator shown while the node is computing.
+    void drawComputingIndicator(QPainter *painter, NodeGraphicsObject &ngo) const;
+
+    /**
+   * Tints the node on a scale from green, 1 ms and less on average, to
+   * red, 1 s and more, and labels it along its bottom edge with the last
+   * and the average compute time and the output size. Nodes without
+   * NodeRole::ComputeCost are left as they are.
+   */
+    void drawComputeCost(QPainter *painter, NodeGraphicsObject &ngo) const;
+
+public:
+    /// The compute cost heatmap is drawn when visible, off by default.
+    bool computeCostVisible() const { return _computeCostVisible; }
+
+    void setComputeCostVisible(bool visible) { _computeCostVisible = visible; }
+
+private:
+    bool _computeCostVisible = false;
 };
 } // namespace QtNodes
@@ -20,6 +20,9 @@ Q_NAMESPACE_EXPORT(NODE_EDITOR_PUBLIC)
 
     /**
  * Constants used for fetching QVariant data from GraphModel.
+ *
+ * New roles are appended. A switch over all the roles has to list them,
+ * ComputeCost was added after Widget.
  */
     enum class NodeRole {
         Type = 0,           ///< Type of the current node, usually a string.
@@ -32,6 +35,7 @@ Q_NAMESPACE_EXPORT(NODE_EDITOR_PUBLIC)
         InPortCount = 7,    ///< `unsigned int`
         OutPortCount = 9,   ///< `unsigned int`
         Widget = 10,        ///< Optional `QWidget*` or `nullptr`
+        ComputeCost = 11,   ///< Optional `QVariantMap`, "last" and "average" ms, "outputBytes"
     };
 Q_ENUM_NS(NodeRole)
 
@@ -32,6 +32,9 @@ public:
 
     QAction *deleteSelectionAction() const;
 
+    /// Checkable, shows the compute cost heatmap of DefaultNodePainter.
+    QAction *computeCostAction() const;
+
     void setScene(BasicGraphicsScene *scene);
 
     void centerScene();
@@ -58,6 +61,9 @@ public Q_SLOTS:
 
     void onPasteObjects();
 
+    /// Tints the nodes by their compute cost, @see DefaultNodePainter::drawComputeCost.
+    void setComputeCostVisible(bool visible);
+
 Q_SIGNALS:
     void scaleChanged(double scale);
 
@@ -90,6 +96,7 @@ private:
     QAction *_duplicateSelectionAction = nullptr;
     QAction *_copySelectionAction = nullptr;
     QAction *_pasteAction = nullptr;
+    QAction *_computeCostAction = nullptr;
 
     QPointF _clickPos;
     ScaleRange _scaleRange;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include <QtCore/QObject>
@@ -36,6 +37,36 @@ public:
 
     /// Type for inner use
     virtual NodeDataType type() const = 0;
+
+    /**
+   * Identifies the content of the data for the memoization of the nodes
+   * consuming it (@see ComputationCache). Equal identities must stand for
+   * equal content. The default `0` means the content cannot be identified
+   * and disables the memoization of the consumers.
+   */
+    virtual std::size_t identity() const { return 0; }
+
+    /// Approximate memory held by the data, used for the cache budget.
+    virtual std::size_t byteSize() const { return 0; }
+};
+
+/**
+ * Describes the part of the data a node needs from an input port, e.g. the
+ * region and the resolution of an image. Requests travel upstream, against
+ * the flow of the data, so that the nodes compute only what the sinks
+ * need. A null request stands for the whole data.
+ *
+ * @see NodeDelegateModel::inRequest
+ */
+class NODE_EDITOR_PUBLIC NodeDataRequest
+{
+public:
+    virtual ~NodeDataRequest() = default;
+
+    /// @returns a request covering both this request and `other`.
+    virtual std::shared_ptr<NodeDataRequest const> united(NodeDataRequest const &other) const = 0;
+
+    virtual bool equals(NodeDataRequest const &other) const = 0;
 };
 
 } // namespace QtNodes
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include <QtWidgets/QWidget>
 
+#include "ComputationCache.hpp"
+#include "ComputationTrace.hpp"
 #include "Definitions.hpp"
 #include "Export.hpp"
 #include "NodeData.hpp"
@@ -12,6 +17,8 @@
 
 namespace QtNodes {
 
+class ComputationGuard;
+class DataFlowGraphModel;
 class StyleCollection;
 
 /**
@@ -24,10 +31,27 @@ class NODE_EDITOR_PUBLIC NodeDelegateModel : public QObject, public Serializable
 {
     Q_OBJECT
 
+public:
+    /// The cost of the computations started with `runComputation`.
+    struct ComputeStatistics
+    {
+        /// Applied computations, cache hits and superseded ones do not count.
+        std::size_t computations = 0;
+
+        /// Wall time of the task of the last applied computation.
+        std::int64_t lastNanoseconds = 0;
+
+        /// Exponential moving average of the wall times, weighing the last one by 1/4.
+        double averageNanoseconds = 0.0;
+
+        /// NodeData::byteSize of the outputs after the last applied computation.
+        std::size_t outputBytes = 0;
+    };
+
 public:
     NodeDelegateModel();
 
-    virtual ~NodeDelegateModel() = default;
+    virtual ~NodeDelegateModel();
 
     /// It is possible to hide caption in GUI
     virtual bool captionVisible() const { return true; }
@@ -66,6 +90,17 @@ public:
 
     virtual std::shared_ptr<NodeData> outData(PortIndex const port) = 0;
 
+    /**
+   * Called once all the inputs changed by one upstream update were
+   * delivered through `setInData`.
+   *
+   * DataFlowGraphModel evaluates the graph in topological order and
+   * visits every affected node once. Models with several input ports
+   * should recompute here instead of in `setInData` so that an update
+   * reaching them through several branches is processed only once.
+   */
+    virtual void inputsUpdated() {}
+
     /**
    * It is recommented to preform a lazy initialization for the
    * embedded widget and create it inside this function, not in the
@@ -80,6 +115,117 @@ public:
 
     virtual bool resizable() const { return false; }
 
+public:
+    /// Tells if `runComputation` offloads the work to a worker thread.
+    bool asyncExecution() const { return _asyncExecution; }
+
+    void setAsyncExecution(bool async);
+
+    /// @returns `true` while any computation started with `runComputation` is running.
+    bool computing() const { return _runningComputations > 0; }
+
+    /**
+   * Makes the running and queued computations stale. Queued tasks are
+   * skipped and the results of the running ones are not applied.
+   */
+    void cancelComputations();
+
+    ComputeStatistics const &computeStatistics() const { return _computeStatistics; }
+
+public:
+    /**
+   * Enables the memoization of the model, off by default.
+   *
+   * Memoized models skip `runComputation` tasks whose parameters and
+   * input data identities match a cached result, @see ComputationCache.
+   */
+    virtual bool cacheable() const { return false; }
+
+    /**
+   * Snapshot of everything the computations of a cacheable model depend
+   * on besides its inputs. The cache compares the snapshots in full.
+   * Defaults to `save()`.
+   */
+    virtual QJsonObject computationParameters() const { return save(); }
+
+    /**
+   * Adopts the cached `outputs`, one per output port, instead of
+   * computing them. The model emits `dataUpdated` for every output port
+   * afterwards.
+   *
+   * @returns `false` if the outputs cannot be adopted, the computation
+   * runs then.
+   */
+    virtual bool restoreOutData(std::vector<std::shared_ptr<NodeData>> const &outputs)
+    {
+        Q_UNUSED(outputs);
+        return false;
+    }
+
+public:
+    /**
+   * The part of the data the node needs from the input port, `nullptr`
+   * stands for all of it. Sinks declare what they display, other nodes
+   * usually pass their `setOutRequest` on, grown by the footprint of
+   * their operation. Emit `inRequestsChanged` when the result changes.
+   */
+    virtual std::shared_ptr<NodeDataRequest const> inRequest(PortIndex const portIndex) const
+    {
+        Q_UNUSED(portIndex);
+        return nullptr;
+    }
+
+    /**
+   * Tells the node which part of the output the nodes downstream need, the
+   * union of their `inRequest`s. `nullptr` stands for all of it, which is
+   * also the case for ports without connections.
+   *
+   * @returns `true` if the current output does not cover the request. The
+   * graph then delivers the inputs of the node again, or calls
+   * `inputsUpdated` for nodes without connected inputs, once the requests
+   * upstream were settled.
+   */
+    virtual bool setOutRequest(std::shared_ptr<NodeDataRequest const> request,
+                               PortIndex const portIndex)
+    {
+        Q_UNUSED(request);
+        Q_UNUSED(portIndex);
+        return false;
+    }
+
+protected:
+    /**
+   * A computation task performs the heavy work of the model and returns a
+   * function applying the result. The task runs on a worker thread in the
+   * asynchronous mode, so it must only operate on the copies of the
+   * parameters and input data it captured: no widgets, no `QPixmap`s and
+   * no unsynchronized access to the model members. The returned function
+   * is called on the thread of the model and is the place to store the
+   * result, refresh the embedded widget and emit `dataUpdated`.
+   */
+    using ComputeTask = std::function<std::function<void()>()>;
+
+    /**
+   * Runs `task` either in place or on TaskScheduler::globalInstance(),
+   * depending on `asyncExecution()`. The model emits `computingStarted`
+   * before the first of the overlapping computations and
+   * `computingFinished` after the last one was finished.
+   *
+   * Starting a computation supersedes the ones still running or queued:
+   * only the result of the latest computation is applied, so a parameter
+   * dragged across many values displays just the final state.
+   *
+   * Memoized models (@see cacheable) first look the result up in the
+   * cache of the graph and store the outputs once `task` was applied.
+   */
+    void runComputation(ComputeTask task);
+
+    /**
+   * Tells a computation task that its result will be dropped. Long tasks
+   * may poll it from the worker thread and return early.
+   */
+    static bool computationCancelled();
+
 public Q_SLOTS:
 
     virtual void inputConnectionCreated(ConnectionId const &) {}
@@ -102,6 +248,12 @@ Q_SIGNALS:
 
     void computingFinished();
 
+    /// Emitted by every `runComputation`, the previous results become stale.
+    void computationScheduled();
+
+    /// Triggers the propagation of the `inRequest`s upstream.
+    void inRequestsChanged();
+
     void embeddedWidgetSizeUpdated();
 
     /// Call this function before deleting the data associated with ports.
@@ -126,8 +278,48 @@ Q_SIGNALS:
     /// Call this function when data and port moditications are finished.
     void portsInserted();
 
+private:
+    friend class DataFlowGraphModel;
+
+    void setComputationCache(std::shared_ptr<ComputationCache> cache);
+
+    /// The computations are recorded as spans of `nodeId`.
+    void setComputationTrace(std::shared_ptr<ComputationTrace> trace, NodeId const nodeId);
+
+    /// A span of the model, timed by the caller.
+    ComputationTrace::Span traceSpan(ComputationTrace::SpanKind kind) const;
+
+    /// Records the identity and the size of the data delivered to the input port.
+    void setInputIdentity(PortIndex const portIndex, std::shared_ptr<NodeData> const &data);
+
+    /// @returns `false` if the current computation cannot be memoized.
+    bool computationKey(ComputationCache::Key &key) const;
+
+    void finishComputation(std::uint64_t generation, std::function<void()> const &apply);
+
+    /// Accounts an applied computation whose task took `nanoseconds`.
+    void updateComputeStatistics(std::int64_t nanoseconds);
+
 private:
     NodeStyle _nodeStyle;
+
+    bool _asyncExecution;
+
+    int _runningComputations;
+
+    std::shared_ptr<ComputationGuard> _computationGuard;
+
+    std::shared_ptr<ComputationCache> _computationCache;
+
+    std::vector<std::size_t> _inputIdentities;
+
+    std::vector<std::size_t> _inputBytes;
+
+    ComputeStatistics _computeStatistics;
+
+    std::shared_ptr<ComputationTrace> _computationTrace;
+
+    NodeId _traceNodeId;
 };
 
 } // namespace QtNodes
@@ -17,7 +17,7 @@ namespace QtNodes {
 class ConnectionGraphicsObject;
 class NodeGraphicsObject;
 
-/// Stores bool for hovering connections and resizing flag.
+/// Stores bool for hovering connections, resizing and computing flags.
 class NODE_EDITOR_PUBLIC NodeState
 {
 public:
@@ -32,6 +32,11 @@ public:
 
     bool resizing() const;
 
+    /// The node has a computation running, e.g. on a worker thread.
+    bool computing() const { return _computing; }
+
+    void setComputing(bool computing = true) { _computing = computing; }
+
     ConnectionGraphicsObject const *connectionForReaction() const;
 
     void storeConnectionForReaction(ConnectionGraphicsObject const *cgo);
@@ -45,6 +50,8 @@ private:
 
     bool _resizing;
 
+    bool _computing;
+
     // QPointer tracks the QObject inside and is automatically cleared
     // when the object is destroyed.
     QPointer<ConnectionGraphicsObject const> _connectionForReaction;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Export.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace QtNodes {
+
+/**
+ * A pool of worker threads with work stealing.
+ *
+ * Every worker owns a task queue. Tasks submitted from a worker thread go
+ * to the back of its own queue and are taken from there (LIFO), which keeps
+ * the data of a just finished task hot in the cache. Tasks submitted from
+ * other threads are spread over the queues round-robin. A worker running
+ * out of tasks steals from the front of the other queues, so independent
+ * graph branches keep all the cores busy.
+ *
+ * DataFlowGraphModel submits a node computation only when all the nodes
+ * upstream of it have finished, so the scheduler itself does not need to
+ * know about the dependencies between tasks.
+ *
+ * The worker threads are started by the first submitted task, the pool is
+ * fixed from then on.
+ */
+class NODE_EDITOR_PUBLIC TaskScheduler
+{
+public:
+    using Task = std::function<void()>;
+
+    /// @param workerCount `0` stands for the number of hardware threads.
+    explicit TaskScheduler(unsigned int workerCount = 0);
+
+    /// Finishes all the queued tasks and joins the workers.
+    ~TaskScheduler();
+
+    TaskScheduler(TaskScheduler const &) = delete;
+
+    TaskScheduler &operator=(TaskScheduler const &) = delete;
+
+    /// The scheduler used for node computations.
+    static TaskScheduler &globalInstance();
+
+public:
+    unsigned int workerCount() const;
+
+    /**
+   * Sizes the pool to `workerCount` threads, `0` stands for the number of
+   * hardware threads.
+   *
+   * @throws std::logic_error once a task was submitted, the running
+   * workers are never resized.
+   */
+    void setWorkerCount(unsigned int workerCount);
+
+    void submit(Task task);
+
+    /**
+   * Calls `body` for every index in `[0, count)` in parallel and returns
+   * once all the calls finished. The calling thread takes part in the
+   * work, so the function may be called from a task without exhausting
+   * the pool.
+   *
+   * Once `body` throws, the indices not started yet are skipped and the
+   * first exception is rethrown on the calling thread.
+   */
+    void parallelFor(std::size_t count, std::function<void(std::size_t)> const &body);
+
+    /// Blocks until all the submitted tasks are finished.
+    void waitForIdle();
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+
+        std::deque<Task> tasks;
+
+        std::thread thread;
+    };
+
+    /// Creates the workers, `_mutex` must be held.
+    void start();
+
+    void stop();
+
+    void run(std::size_t workerIndex);
+
+    bool takeTask(std::size_t workerIndex, Task &task);
+
+private:
+    /// Written before the workers start, read-only afterwards.
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    std::atomic<unsigned int> _workerCount;
+
+    bool _started;
+
+    std::atomic<std::size_t> _nextWorker;
+
+    std::mutex _mutex;
+
+    std::condition_variable _wakeUp;
+
+    std::condition_variable _idle;
+
+    /// Tasks sitting in the queues.
+    std::size_t _queuedTasks;
+
+    /// Queued and running tasks.
+    std::size_t _unfinishedTasks;
+
+    bool _stopping;
+};
+
+} // namespace QtNodes
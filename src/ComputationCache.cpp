@@ -0,0 +1,110 @@
+#include "ComputationCache.hpp"
+
+#include "ConnectionIdHash.hpp"
+#include "QStringStdHash.hpp"
+
+#include <QtCore/QJsonDocument>
+
+#include <utility>
+
+namespace QtNodes {
+
+std::size_t ComputationCache::KeyHash::operator()(Key const &key) const
+{
+    QByteArray const parameters = QJsonDocument(key.parameters).toJson(QJsonDocument::Compact);
+
+    std::size_t h = 0;
+    hash_combine(h, key.modelName, static_cast<std::size_t>(qHash(parameters)));
+
+    for (std::size_t const input : key.inputs) {
+        hash_combine(h, input);
+    }
+
+    return h;
+}
+
+ComputationCache::ComputationCache(std::size_t byteBudget)
+    : _byteBudget(byteBudget)
+    , _usedBytes(0)
+    , _hits(0)
+    , _misses(0)
+{}
+
+bool ComputationCache::find(Key const &key, Outputs &outputs)
+{
+    auto it = _index.find(key);
+
+    if (it == _index.end()) {
+        ++_misses;
+        return false;
+    }
+
+    ++_hits;
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    outputs = it->second->outputs;
+
+    return true;
+}
+
+void ComputationCache::insert(Key const &key, Outputs outputs)
+{
+    if (_byteBudget == 0)
+        return;
+
+    // Empty outputs still occupy some memory.
+    std::size_t bytes = sizeof(Entry);
+    for (auto const &data : outputs) {
+        if (data)
+            bytes += data->byteSize();
+    }
+
+    if (bytes > _byteBudget)
+        return;
+
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        _usedBytes -= it->second->bytes;
+        _entries.erase(it->second);
+        _index.erase(it);
+    }
+
+    _entries.push_front(Entry{key, std::move(outputs), bytes});
+    _index[key] = _entries.begin();
+    _usedBytes += bytes;
+
+    evict();
+}
+
+void ComputationCache::clear()
+{
+    _index.clear();
+    _entries.clear();
+    _usedBytes = 0;
+}
+
+void ComputationCache::setByteBudget(std::size_t byteBudget)
+{
+    _byteBudget = byteBudget;
+
+    evict();
+}
+
+void ComputationCache::resetStatistics()
+{
+    _hits = 0;
+    _misses = 0;
+}
+
+void ComputationCache::evict()
+{
+    while (_usedBytes > _byteBudget && !_entries.empty()) {
+        Entry const &entry = _entries.back();
+
+        _usedBytes -= entry.bytes;
+        _index.erase(entry.key);
+        _entries.pop_back();
+    }
+}
+
+} // namespace QtNodes
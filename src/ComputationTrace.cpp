@@ -0,0 +1,144 @@
+#include "ComputationTrace.hpp"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+
+#include <chrono>
+#include <utility>
+
+namespace QtNodes {
+
+namespace {
+
+std::int64_t steadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+ComputationTrace::ComputationTrace()
+    : _recording(false)
+    , _origin(steadyNanoseconds())
+{}
+
+void ComputationTrace::start()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _spans.clear();
+    _threads.clear();
+
+    // The starting thread is number 0, named "main" in the export.
+    threadNumber();
+
+    _origin = steadyNanoseconds();
+    _recording = true;
+}
+
+void ComputationTrace::stop()
+{
+    _recording = false;
+}
+
+std::int64_t ComputationTrace::now() const
+{
+    return steadyNanoseconds() - _origin;
+}
+
+void ComputationTrace::record(Span span)
+{
+    if (!_recording)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    span.thread = threadNumber();
+    _spans.push_back(std::move(span));
+}
+
+std::vector<ComputationTrace::Span> ComputationTrace::spans() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _spans;
+}
+
+void ComputationTrace::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _spans.clear();
+    _threads.clear();
+}
+
+int ComputationTrace::threadNumber()
+{
+    auto const inserted = _threads.emplace(std::this_thread::get_id(),
+                                           static_cast<int>(_threads.size()));
+    return inserted.first->second;
+}
+
+QJsonObject ComputationTrace::toChromeTrace() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    QJsonArray events;
+
+    for (auto const &thread : _threads) {
+        QJsonObject args;
+        args["name"] = thread.second == 0 ? QString("main") : QString("worker %1").arg(thread.second);
+
+        QJsonObject event;
+        event["name"] = "thread_name";
+        event["ph"] = "M";
+        event["pid"] = 1;
+        event["tid"] = thread.second;
+        event["args"] = args;
+        events.append(event);
+    }
+
+    for (Span const &span : _spans) {
+        QJsonArray inputBytes;
+        for (std::size_t const bytes : span.inputBytes) {
+            inputBytes.append(static_cast<double>(bytes));
+        }
+
+        QJsonObject args;
+        args["node"] = static_cast<qint64>(span.nodeId);
+        args["model"] = span.modelName;
+        args["inputBytes"] = inputBytes;
+        args["cached"] = span.cached;
+
+        // The timestamps are in microseconds.
+        QJsonObject event;
+        event["name"] = QString("%1 #%2").arg(span.modelName).arg(span.nodeId);
+        event["cat"] = span.kind == SpanKind::Evaluation ? "evaluation" : "computation";
+        event["ph"] = "X";
+        event["ts"] = span.start / 1000.0;
+        event["dur"] = span.duration / 1000.0;
+        event["pid"] = 1;
+        event["tid"] = span.thread;
+        event["args"] = args;
+        events.append(event);
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+    return trace;
+}
+
+bool ComputationTrace::writeChromeTrace(QString const &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QJsonDocument const document(toChromeTrace());
+    return file.write(document.toJson(QJsonDocument::Compact)) >= 0;
+}
+
+} // namespace QtNodes
@@ -3,6 +3,7 @@
 
 #include <QJsonArray>
 
+#include <deque>
 #include <stdexcept>
 
 namespace QtNodes {
@@ -12,6 +13,10 @@ namespace QtNodes {
 DataFlowGraphModel::DataFlowGraphModel(std::shared_ptr<NodeDelegateModelRegistry> registry)
     : _registry(std::move(registry))
     , _nextNodeId{0}
+    , _evaluating{false}
+    , _asyncExecution{false}
+    , _computationCache(std::make_shared<ComputationCache>())
+    , _computationTrace(std::make_shared<ComputationTrace>())
 {}
 // Returns all existing NodeIds by iterating through _models, which maps node IDs to their models.
 
@@ -28,12 +33,11 @@ std::unordered_set<ConnectionId> DataFlowGraphModel::allConnectionIds(NodeId con
 {
     std::unordered_set<ConnectionId> result;
 
-    std::copy_if(_connectivity.begin(),
-                 _connectivity.end(),
-                 std::inserter(result, std::end(result)),
-                 [&nodeId](ConnectionId const &cid) {
-                     return cid.inNodeId == nodeId || cid.outNodeId == nodeId;
-                 });
+    for (PortType const portType : {PortType::In, PortType::Out}) {
+        for (auto const &cid : nodeConnections(nodeId, portType)) {
+            result.insert(cid);
+        }
+    }
 
     return result;
 }
@@ -42,19 +46,64 @@ std::unordered_set<ConnectionId> DataFlowGraphModel::connections(NodeId nodeId,
                                                                  PortType portType,
                                                                  PortIndex portIndex) const
 {
-    std::unordered_set<ConnectionId> result;
+    auto it = _portConnections.find(PortKey(nodeId, portType, portIndex));
+    if (it == _portConnections.end())
+        return std::unordered_set<ConnectionId>();
 
-    std::copy_if(_connectivity.begin(),
-                 _connectivity.end(),
-                 std::inserter(result, std::end(result)),
-                 [&portType, &portIndex, &nodeId](ConnectionId const &cid) {
-                     return (getNodeId(portType, cid) == nodeId
-                             && getPortIndex(portType, cid) == portIndex);
-                 });
+    return it->second;
+}
+
+std::vector<ConnectionId> DataFlowGraphModel::nodeConnections(NodeId const nodeId,
+                                                              PortType const portType) const
+{
+    std::vector<ConnectionId> result;
+
+    auto modelIt = _models.find(nodeId);
+    if (modelIt == _models.end())
+        return result;
+
+    unsigned int const portCount = modelIt->second->nPorts(portType);
+    for (PortIndex portIndex = 0; portIndex < portCount; ++portIndex) {
+        auto it = _portConnections.find(PortKey(nodeId, portType, portIndex));
+        if (it != _portConnections.end())
+            result.insert(result.end(), it->second.begin(), it->second.end());
+    }
 
     return result;
 }
 
+void DataFlowGraphModel::insertConnection(ConnectionId const connectionId)
+{
+    if (!_connectivity.insert(connectionId).second)
+        return;
+
+    _portConnections[PortKey(connectionId.outNodeId, PortType::Out, connectionId.outPortIndex)]
+        .insert(connectionId);
+    _portConnections[PortKey(connectionId.inNodeId, PortType::In, connectionId.inPortIndex)]
+        .insert(connectionId);
+}
+
+bool DataFlowGraphModel::eraseConnection(ConnectionId const connectionId)
+{
+    if (_connectivity.erase(connectionId) == 0)
+        return false;
+
+    // Ports without connections leave the index.
+    for (PortKey const &key :
+         {PortKey(connectionId.outNodeId, PortType::Out, connectionId.outPortIndex),
+          PortKey(connectionId.inNodeId, PortType::In, connectionId.inPortIndex)}) {
+        auto it = _portConnections.find(key);
+        if (it == _portConnections.end())
+            continue;
+
+        it->second.erase(connectionId);
+        if (it->second.empty())
+            _portConnections.erase(it);
+    }
+
+    return true;
+}
+
 bool DataFlowGraphModel::connectionExists(ConnectionId const connectionId) const
 {
     return (_connectivity.find(connectionId) != _connectivity.end());
@@ -67,35 +116,7 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
     if (model) {
         NodeId newId = newNodeId();
 
-        connect(model.get(),
-                &NodeDelegateModel::dataUpdated,
-                [newId, this](PortIndex const portIndex) {
-                    onOutPortDataUpdated(newId, portIndex);
-                });
-
-        connect(model.get(),
-                &NodeDelegateModel::portsAboutToBeDeleted,
-                this,
-                [newId, this](PortType const portType, PortIndex const first, PortIndex const last) {
-                    portsAboutToBeDeleted(newId, portType, first, last);
-                });
-
-        connect(model.get(),
-                &NodeDelegateModel::portsDeleted,
-                this,
-                &DataFlowGraphModel::portsDeleted);
-
-        connect(model.get(),
-                &NodeDelegateModel::portsAboutToBeInserted,
-                this,
-                [newId, this](PortType const portType, PortIndex const first, PortIndex const last) {
-                    portsAboutToBeInserted(newId, portType, first, last);
-                });
-
-        connect(model.get(),
-                &NodeDelegateModel::portsInserted,
-                this,
-                &DataFlowGraphModel::portsInserted);
+        connectDelegateModel(newId, model.get());
 
         _models[newId] = std::move(model);
 
@@ -107,6 +128,60 @@ NodeId DataFlowGraphModel::addNode(QString const nodeType)
     return InvalidNodeId;
 }
 
+void DataFlowGraphModel::connectDelegateModel(NodeId const nodeId, NodeDelegateModel *model)
+{
+    model->setAsyncExecution(_asyncExecution);
+    model->setComputationCache(_computationCache);
+    model->setComputationTrace(_computationTrace, nodeId);
+
+    connect(model, &NodeDelegateModel::dataUpdated, this, [nodeId, this](PortIndex const portIndex) {
+        onOutPortDataUpdated(nodeId, portIndex);
+    });
+
+    connect(model,
+            &NodeDelegateModel::portsAboutToBeDeleted,
+            this,
+            [nodeId, this](PortType const portType, PortIndex const first, PortIndex const last) {
+                portsAboutToBeDeleted(nodeId, portType, first, last);
+            });
+
+    connect(model, &NodeDelegateModel::portsDeleted, this, &DataFlowGraphModel::portsDeleted);
+
+    connect(model,
+            &NodeDelegateModel::portsAboutToBeInserted,
+            this,
+            [nodeId, this](PortType const portType, PortIndex const first, PortIndex const last) {
+                portsAboutToBeInserted(nodeId, portType, first, last);
+            });
+
+    connect(model, &NodeDelegateModel::portsInserted, this, &DataFlowGraphModel::portsInserted);
+
+    connect(model, &NodeDelegateModel::computingStarted, this, [nodeId, this]() {
+        _computingNodes.insert(nodeId);
+
+        Q_EMIT nodeComputingStarted(nodeId);
+    });
+
+    connect(model, &NodeDelegateModel::computationScheduled, this, [nodeId, this]() {
+        cancelDownstreamComputations(nodeId);
+    });
+
+    connect(model, &NodeDelegateModel::inRequestsChanged, this, [nodeId, this]() {
+        // The producers of the inputs merge the new requests.
+        std::vector<NodeId> const producers = predecessors(nodeId);
+        propagateRequests(std::unordered_set<NodeId>(producers.begin(), producers.end()));
+    });
+
+    connect(model, &NodeDelegateModel::computingFinished, this, [nodeId, this]() {
+        _computingNodes.erase(nodeId);
+
+        Q_EMIT nodeComputingFinished(nodeId);
+
+        // Resumes the nodes that waited for the result.
+        evaluate();
+    });
+}
+
 bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) const
 {
     auto getDataType = [&](PortType const portType) {
@@ -134,7 +209,7 @@ bool DataFlowGraphModel::connectionPossible(ConnectionId const connectionId) con
 
 void DataFlowGraphModel::addConnection(ConnectionId const connectionId)
 {
-    _connectivity.insert(connectionId);
+    insertConnection(connectionId);
 
     sendConnectionCreation(connectionId);
 
@@ -148,6 +223,8 @@ void DataFlowGraphModel::addConnection(ConnectionId const connectionId)
                 connectionId.inPortIndex,
                 portDataToPropagate,
                 PortRole::Data);
+
+    propagateRequests({connectionId.outNodeId});
 }
 
 void DataFlowGraphModel::sendConnectionCreation(ConnectionId const connectionId)
@@ -240,6 +317,18 @@ QVariant DataFlowGraphModel::nodeData(NodeId nodeId, NodeRole role) const
         auto w = model->embeddedWidget();
         result = QVariant::fromValue(w);
     } break;
+
+    case NodeRole::ComputeCost: {
+        NodeDelegateModel::ComputeStatistics const &statistics = model->computeStatistics();
+        if (statistics.computations == 0)
+            break;
+
+        QVariantMap cost;
+        cost["last"] = statistics.lastNanoseconds / 1e6;
+        cost["average"] = statistics.averageNanoseconds / 1e6;
+        cost["outputBytes"] = static_cast<qulonglong>(statistics.outputBytes);
+        result = cost;
+    } break;
     }
 
     return result;
@@ -299,6 +388,9 @@ bool DataFlowGraphModel::setNodeData(NodeId nodeId, NodeRole role, QVariant valu
 
     case NodeRole::Widget:
         break;
+
+    case NodeRole::ComputeCost:
+        break;
     }
 
     return result;
@@ -360,10 +452,18 @@ bool DataFlowGraphModel::setPortData(
     switch (role) {
     case PortRole::Data:
         if (portType == PortType::In) {
-            model->setInData(value.value<std::shared_ptr<NodeData>>(), portIndex);
+            auto const data = value.value<std::shared_ptr<NodeData>>();
+
+            model->setInputIdentity(portIndex, data);
+            model->setInData(data, portIndex);
 
             // Triggers repainting on the scene.
             Q_EMIT inPortDataWasSet(nodeId, portType, portIndex);
+
+            // During an evaluation pass the node recomputes once all its
+            // updated inputs are delivered, see `evaluateNode`.
+            if (!_evaluating)
+                model->inputsUpdated();
         }
         break;
 
@@ -376,21 +476,17 @@ bool DataFlowGraphModel::setPortData(
 
 bool DataFlowGraphModel::deleteConnection(ConnectionId const connectionId)
 {
-    bool disconnected = false;
-
-    auto it = _connectivity.find(connectionId);
-
-    if (it != _connectivity.end()) {
-        disconnected = true;
-
-        _connectivity.erase(it);
-    }
+    bool const disconnected = eraseConnection(connectionId);
 
     if (disconnected) {
+        _dirtyConnections.erase(connectionId);
+
         sendConnectionDeletion(connectionId);
 
         propagateEmptyDataTo(getNodeId(PortType::In, connectionId),
                              getPortIndex(PortType::In, connectionId));
+
+        propagateRequests({connectionId.outNodeId});
     }
 
     return disconnected;
@@ -404,8 +500,17 @@ bool DataFlowGraphModel::deleteNode(NodeId const nodeId)
         deleteConnection(cId);
     }
 
+    auto it = _models.find(nodeId);
+    if (it != _models.end()) {
+        unsigned int const portCount = it->second->nPorts(PortType::Out);
+        for (PortIndex portIndex = 0; portIndex < portCount; ++portIndex) {
+            _outRequests.erase(std::make_pair(nodeId, portIndex));
+        }
+    }
+
     _nodeGeometryData.erase(nodeId);
     _models.erase(nodeId);
+    _computingNodes.erase(nodeId);
 
     Q_EMIT nodeDeleted(nodeId);
 
@@ -471,11 +576,7 @@ void DataFlowGraphModel::loadNode(QJsonObject const &nodeJson)
     std::unique_ptr<NodeDelegateModel> model = _registry->create(delegateModelName);
 
     if (model) {
-        connect(model.get(),
-                &NodeDelegateModel::dataUpdated,
-                [restoredNodeId, this](PortIndex const portIndex) {
-                    onOutPortDataUpdated(restoredNodeId, portIndex);
-                });
+        connectDelegateModel(restoredNodeId, model.get());
 
         _models[restoredNodeId] = std::move(model);
 
@@ -508,22 +609,378 @@ void DataFlowGraphModel::load(QJsonObject const &jsonDocument)
 
         ConnectionId connId = fromJson(connJson);
 
-        // Restore the connection
-        addConnection(connId);
+        // Restore the connection. The data is not pushed right away: the
+        // whole graph is evaluated once below, in topological order.
+        insertConnection(connId);
+
+        sendConnectionCreation(connId);
+
+        _dirtyConnections.insert(connId);
+    }
+
+    // Settles the requests of the restored sinks and evaluates the whole
+    // graph once.
+    propagateRequests(allNodeIds());
+}
+
+void DataFlowGraphModel::setAsyncExecution(bool async)
+{
+    _asyncExecution = async;
+
+    for (auto &p : _models) {
+        p.second->setAsyncExecution(async);
     }
 }
 
 void DataFlowGraphModel::onOutPortDataUpdated(NodeId const nodeId, PortIndex const portIndex)
 {
-    std::unordered_set<ConnectionId> const &connected = connections(nodeId,
-                                                                    PortType::Out,
-                                                                    portIndex);
+    for (auto const &cid : connections(nodeId, PortType::Out, portIndex)) {
+        _dirtyConnections.insert(cid);
+    }
+
+    evaluate();
+}
+
+void DataFlowGraphModel::evaluate()
+{
+    // Updates produced by the nodes visited in a running pass are consumed
+    // by that pass.
+    if (_evaluating)
+        return;
+
+    _evaluating = true;
+
+    // Every node is visited at most once, that keeps cycles from looping.
+    std::unordered_set<NodeId> visited;
+
+    for (;;) {
+        std::unordered_set<NodeId> targets;
+        for (auto const &cid : _dirtyConnections) {
+            if (visited.find(cid.inNodeId) == visited.end())
+                targets.insert(cid.inNodeId);
+        }
+
+        if (targets.empty())
+            break;
+
+        // Nodes downstream of a running computation wait for its result.
+        std::unordered_set<NodeId> blocked = downstreamNodes(_computingNodes);
+
+        bool progress = false;
+
+        for (NodeId const nodeId : topologicalOrder(targets)) {
+            if (blocked.find(nodeId) != blocked.end() || visited.find(nodeId) != visited.end())
+                continue;
+
+            if (!evaluateNode(nodeId))
+                continue;
+
+            visited.insert(nodeId);
+            progress = true;
+
+            // The node went on computing on a worker thread.
+            if (_computingNodes.find(nodeId) != _computingNodes.end()) {
+                for (NodeId const next : downstreamNodes({nodeId})) {
+                    blocked.insert(next);
+                }
+            }
+        }
+
+        if (!progress)
+            break;
+    }
+
+    _evaluating = false;
+}
+
+bool DataFlowGraphModel::evaluateNode(NodeId const nodeId)
+{
+    auto it = _models.find(nodeId);
+    if (it == _models.end())
+        return false;
+
+    std::vector<ConnectionId> inputs;
+    for (auto const &cid : nodeConnections(nodeId, PortType::In)) {
+        if (_dirtyConnections.find(cid) != _dirtyConnections.end())
+            inputs.push_back(cid);
+    }
+
+    if (inputs.empty())
+        return false;
+
+    bool const tracing = _computationTrace->recording();
+    std::int64_t const start = tracing ? _computationTrace->now() : 0;
+
+    for (auto const &cid : inputs) {
+        _dirtyConnections.erase(cid);
+
+        QVariant const portDataToPropagate = portData(cid.outNodeId,
+                                                      PortType::Out,
+                                                      cid.outPortIndex,
+                                                      PortRole::Data);
+
+        setPortData(nodeId, PortType::In, cid.inPortIndex, portDataToPropagate, PortRole::Data);
+    }
+
+    // `setPortData` could have removed the node.
+    it = _models.find(nodeId);
+
+    if (it == _models.end())
+        return true;
+
+    it->second->inputsUpdated();
 
-    QVariant const portDataToPropagate = portData(nodeId, PortType::Out, portIndex, PortRole::Data);
+    it = _models.find(nodeId);
 
-    for (auto const &cn : connected) {
-        setPortData(cn.inNodeId, PortType::In, cn.inPortIndex, portDataToPropagate, PortRole::Data);
+    // Covers the synchronous work of the node and the start of its computations.
+    if (tracing && it != _models.end()) {
+        ComputationTrace::Span span = it->second->traceSpan(ComputationTrace::SpanKind::Evaluation);
+        span.start = start;
+        span.duration = _computationTrace->now() - start;
+        _computationTrace->record(std::move(span));
     }
+
+    return true;
+}
+
+void DataFlowGraphModel::cancelDownstreamComputations(NodeId const nodeId)
+{
+    // The nodes get new inputs once the computation of `nodeId` finishes.
+    // Idle nodes have nothing to cancel, the graph is not walked for them.
+    for (NodeId const computingNode : _computingNodes) {
+        if (computingNode == nodeId || !isUpstreamOf(nodeId, computingNode))
+            continue;
+
+        auto it = _models.find(computingNode);
+        if (it != _models.end())
+            it->second->cancelComputations();
+    }
+}
+
+void DataFlowGraphModel::propagateRequests(std::unordered_set<NodeId> const &nodes)
+{
+    std::unordered_set<NodeId> staleNodes;
+
+    // The walk goes upstream only past nodes whose output requests changed,
+    // an edit costs the part of the graph whose requests it affects. A node
+    // is merged again if another consumer changes later on.
+    std::deque<NodeId> queue(nodes.begin(), nodes.end());
+    std::unordered_set<NodeId> queued(nodes.begin(), nodes.end());
+
+    while (!queue.empty()) {
+        NodeId const nodeId = queue.front();
+        queue.pop_front();
+        queued.erase(nodeId);
+
+        auto it = _models.find(nodeId);
+        if (it == _models.end())
+            continue;
+
+        bool changed = false;
+
+        unsigned int const portCount = it->second->nPorts(PortType::Out);
+        for (PortIndex portIndex = 0; portIndex < portCount; ++portIndex) {
+            if (updateOutRequest(nodeId, portIndex, staleNodes))
+                changed = true;
+        }
+
+        // The input requests of the node follow its output requests.
+        if (!changed)
+            continue;
+
+        for (NodeId const n : predecessors(nodeId)) {
+            if (queued.insert(n).second)
+                queue.push_back(n);
+        }
+    }
+
+    for (NodeId const nodeId : staleNodes) {
+        std::vector<ConnectionId> const inputs = nodeConnections(nodeId, PortType::In);
+
+        for (auto const &cid : inputs) {
+            _dirtyConnections.insert(cid);
+        }
+
+        if (inputs.empty())
+            _models[nodeId]->inputsUpdated();
+    }
+
+    evaluate();
+}
+
+bool DataFlowGraphModel::updateOutRequest(NodeId const nodeId,
+                                          PortIndex const portIndex,
+                                          std::unordered_set<NodeId> &staleNodes)
+{
+    std::shared_ptr<NodeDataRequest const> request;
+
+    bool first = true;
+
+    for (auto const &cid : connections(nodeId, PortType::Out, portIndex)) {
+        auto it = _models.find(cid.inNodeId);
+        if (it == _models.end())
+            continue;
+
+        std::shared_ptr<NodeDataRequest const> const consumerRequest = it->second->inRequest(
+            cid.inPortIndex);
+
+        // A consumer needing all the data makes the whole port unrestricted.
+        if (!consumerRequest) {
+            request.reset();
+            break;
+        }
+
+        request = first ? consumerRequest : request->united(*consumerRequest);
+        first = false;
+
+        if (!request)
+            break;
+    }
+
+    auto const key = std::make_pair(nodeId, portIndex);
+
+    auto it = _outRequests.find(key);
+    std::shared_ptr<NodeDataRequest const> const previous = it != _outRequests.end() ? it->second
+                                                                                     : nullptr;
+
+    bool const changed = (previous && request) ? !previous->equals(*request) : previous != request;
+    if (!changed)
+        return false;
+
+    if (request)
+        _outRequests[key] = request;
+    else
+        _outRequests.erase(key);
+
+    if (_models[nodeId]->setOutRequest(request, portIndex))
+        staleNodes.insert(nodeId);
+
+    return true;
+}
+
+std::vector<NodeId> DataFlowGraphModel::successors(NodeId const nodeId) const
+{
+    std::vector<NodeId> result;
+    for (auto const &cid : nodeConnections(nodeId, PortType::Out)) {
+        result.push_back(cid.inNodeId);
+    }
+
+    return result;
+}
+
+std::vector<NodeId> DataFlowGraphModel::predecessors(NodeId const nodeId) const
+{
+    std::vector<NodeId> result;
+    for (auto const &cid : nodeConnections(nodeId, PortType::In)) {
+        result.push_back(cid.outNodeId);
+    }
+
+    return result;
+}
+
+std::unordered_set<NodeId> DataFlowGraphModel::downstreamNodes(
+    std::unordered_set<NodeId> const &roots) const
+{
+    std::unordered_set<NodeId> result;
+
+    if (roots.empty())
+        return result;
+
+    std::deque<NodeId> queue(roots.begin(), roots.end());
+
+    while (!queue.empty()) {
+        NodeId const nodeId = queue.front();
+        queue.pop_front();
+
+        for (NodeId const n : successors(nodeId)) {
+            if (result.insert(n).second)
+                queue.push_back(n);
+        }
+    }
+
+    return result;
+}
+
+bool DataFlowGraphModel::isUpstreamOf(NodeId const nodeId, NodeId const target) const
+{
+    std::unordered_set<NodeId> visited;
+    std::deque<NodeId> queue{target};
+
+    while (!queue.empty()) {
+        NodeId const current = queue.front();
+        queue.pop_front();
+
+        for (NodeId const n : predecessors(current)) {
+            if (n == nodeId)
+                return true;
+
+            if (visited.insert(n).second)
+                queue.push_back(n);
+        }
+    }
+
+    return false;
+}
+
+std::vector<NodeId> DataFlowGraphModel::topologicalOrder(
+    std::unordered_set<NodeId> const &sources) const
+{
+    // Collect the affected subgraph.
+    std::unordered_set<NodeId> affected = downstreamNodes(sources);
+    affected.insert(sources.begin(), sources.end());
+
+    std::unordered_map<NodeId, std::vector<NodeId>> next;
+    for (NodeId const nodeId : affected) {
+        next[nodeId] = successors(nodeId);
+    }
+
+    // Kahn's algorithm restricted to the affected nodes.
+    std::unordered_map<NodeId, std::size_t> inDegree;
+    for (NodeId const nodeId : affected) {
+        inDegree[nodeId];
+
+        auto it = next.find(nodeId);
+        if (it == next.end())
+            continue;
+
+        for (NodeId const n : it->second) {
+            ++inDegree[n];
+        }
+    }
+
+    std::vector<NodeId> order;
+    order.reserve(affected.size());
+
+    std::deque<NodeId> queue;
+    for (auto const &p : inDegree) {
+        if (p.second == 0)
+            queue.push_back(p.first);
+    }
+
+    while (!queue.empty()) {
+        NodeId const nodeId = queue.front();
+        queue.pop_front();
+
+        order.push_back(nodeId);
+
+        auto it = next.find(nodeId);
+        if (it == next.end())
+            continue;
+
+        for (NodeId const n : it->second) {
+            if (--inDegree[n] == 0)
+                queue.push_back(n);
+        }
+    }
+
+    if (order.size() < affected.size()) {
+        for (auto const &p : inDegree) {
+            if (p.second > 0)
+                order.push_back(p.first);
+        }
+    }
+
+    return order;
 }
 
 void DataFlowGraphModel::propagateEmptyDataTo(NodeId const nodeId, PortIndex const portIndex)
@@ -36,6 +36,24 @@ DataFlowGraphicsScene::DataFlowGraphicsScene(DataFlowGraphModel &graphModel, QOb
     connect(&_graphModel,
             &DataFlowGraphModel::inPortDataWasSet,
             [this](NodeId const nodeId, PortType const, PortIndex const) { onNodeUpdated(nodeId); });
+
+    // Drives the busy indicator painted over the node.
+    auto setComputing = [this](NodeId const nodeId, bool computing) {
+        if (auto ngo = nodeGraphicsObject(nodeId)) {
+            ngo->nodeState().setComputing(computing);
+            ngo->update();
+        }
+    };
+
+    connect(&_graphModel,
+            &DataFlowGraphModel::nodeComputingStarted,
+            this,
+            [setComputing](NodeId const nodeId) { setComputing(nodeId, true); });
+
+    connect(&_graphModel,
+            &DataFlowGraphModel::nodeComputingFinished,
+            this,
+            [setComputing](NodeId const nodeId) { setComputing(nodeId, false); });
 }
 
 // TODO constructor for an empyt scene?
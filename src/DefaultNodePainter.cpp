@@ -1,8 +1,10 @@
 #include "DefaultNodePainter.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QtCore/QMargins>
+#include <QtGui/QFontMetrics>
 
 #include "AbstractGraphModel.hpp"
 #include "AbstractNodeGeometry.hpp"
@@ -43,6 +45,8 @@ void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
     // Draw the node's background rectangle.
     drawNodeRect(painter, ngo);
 
+    drawComputeCost(painter, ngo);
+
     // Retrieve the image data from the model using NodeRole::InternalData.
     QVariant internalData = graphModel.nodeData(nodeId, NodeRole::InternalData);
     if (internalData.canConvert<QPixmap>()) {
@@ -71,6 +75,7 @@ void DefaultNodePainter::paint(QPainter *painter, NodeGraphicsObject &ngo) const
     drawNodeCaption(painter, ngo);
     drawEntryLabels(painter, ngo);
     drawResizeRect(painter, ngo);
+    drawComputingIndicator(painter, ngo);
 }
 
 void DefaultNodePainter::drawNodeRect(QPainter *painter, NodeGraphicsObject &ngo) const
@@ -309,4 +314,82 @@ void DefaultNodePainter::drawResizeRect(QPainter *painter, NodeGraphicsObject &n
     }
 }
 
+void DefaultNodePainter::drawComputingIndicator(QPainter *painter, NodeGraphicsObject &ngo) const
+{
+    if (!ngo.nodeState().computing())
+        return;
+
+    AbstractGraphModel &model = ngo.graphModel();
+    NodeId const nodeId = ngo.nodeId();
+    AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
+
+    QJsonDocument json = QJsonDocument::fromVariant(model.nodeData(nodeId, NodeRole::Style));
+    NodeStyle nodeStyle(json.object());
+
+    QSize const size = geometry.size(nodeId);
+
+    double const diameter = 2.0 * nodeStyle.ConnectionPointDiameter;
+    QRectF const rect(size.width() - diameter - 4.0, 4.0, diameter, diameter);
+
+    // A three-quarter ring, the usual "busy" glyph.
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(QPen(nodeStyle.WarningColor, 2.0));
+    painter->drawArc(rect, 90 * 16, 270 * 16);
+}
+
+void DefaultNodePainter::drawComputeCost(QPainter *painter, NodeGraphicsObject &ngo) const
+{
+    if (!_computeCostVisible)
+        return;
+
+    AbstractGraphModel &model = ngo.graphModel();
+    NodeId const nodeId = ngo.nodeId();
+    AbstractNodeGeometry &geometry = ngo.nodeScene()->nodeGeometry();
+
+    QVariantMap const cost = model.nodeData(nodeId, NodeRole::ComputeCost).toMap();
+    if (cost.isEmpty())
+        return;
+
+    double const last = cost["last"].toDouble();
+    double const average = cost["average"].toDouble();
+    double const bytes = cost["outputBytes"].toDouble();
+
+    // Three decades of milliseconds from cheap to expensive, hue 120 to 0.
+    double const expense = std::min(1.0, std::max(0.0, std::log10(std::max(average, 1e-3)) / 3.0));
+
+    QColor tint = QColor::fromHsvF((1.0 - expense) / 3.0, 0.85, 0.95);
+
+    QSize const size = geometry.size(nodeId);
+    QRectF const boundary(0, 0, size.width(), size.height());
+
+    painter->save();
+
+    tint.setAlphaF(0.35);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(tint);
+    painter->drawRoundedRect(boundary, 3.0, 3.0);
+
+    QString const outputSize = bytes >= 1024.0 * 1024.0
+                              ? QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                              : QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+
+    QString const label = QString("%1 ms, avg %2 ms, %3")
+                              .arg(last, 0, 'f', 1)
+                              .arg(average, 0, 'f', 1)
+                              .arg(outputSize);
+
+    // Along the bottom edge inside the node, the bounding rectangle does not grow with the label.
+    QFontMetrics const metrics = painter->fontMetrics();
+    double const padding = 4.0;
+
+    tint.setAlphaF(1.0);
+    painter->setPen(tint);
+    painter->drawText(QPointF(padding, size.height() - metrics.descent() - padding),
+                      metrics.elidedText(label,
+                                         Qt::ElideRight,
+                                         std::max(0, size.width() - 2 * static_cast<int>(padding))));
+
+    painter->restore();
+}
+
 } // namespace QtNodes
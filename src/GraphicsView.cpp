@@ -2,6 +2,7 @@
 
 #include "BasicGraphicsScene.hpp"
 #include "ConnectionGraphicsObject.hpp"
+#include "DefaultNodePainter.hpp"
 #include "NodeGraphicsObject.hpp"
 #include "StyleCollection.hpp"
 #include "UndoCommands.hpp"
@@ -33,6 +34,7 @@ GraphicsView::GraphicsView(QWidget *parent)
     , _duplicateSelectionAction(Q_NULLPTR)
     , _copySelectionAction(Q_NULLPTR)
     , _pasteAction(Q_NULLPTR)
+    , _computeCostAction(Q_NULLPTR)
 {
     setDragMode(QGraphicsView::ScrollHandDrag);
     setRenderHint(QPainter::Antialiasing);
@@ -73,6 +75,11 @@ QAction *GraphicsView::deleteSelectionAction() const
     return _deleteSelectionAction;
 }
 
+QAction *GraphicsView::computeCostAction() const
+{
+    return _computeCostAction;
+}
+
 void GraphicsView::setScene(BasicGraphicsScene *scene)
 {
     QGraphicsView::setScene(scene);
@@ -141,6 +148,21 @@ void GraphicsView::setScene(BasicGraphicsScene *scene)
         addAction(_pasteAction);
     }
 
+    {
+        delete _computeCostAction;
+        _computeCostAction = new QAction(QStringLiteral("Show Compute Cost"), this);
+        _computeCostAction->setCheckable(true);
+        _computeCostAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_H));
+
+        // Reflects the painter of the new scene.
+        if (auto painter = dynamic_cast<DefaultNodePainter *>(&scene->nodePainter()))
+            _computeCostAction->setChecked(painter->computeCostVisible());
+
+        connect(_computeCostAction, &QAction::toggled, this, &GraphicsView::setComputeCostVisible);
+
+        addAction(_computeCostAction);
+    }
+
     auto undoAction = scene->undoStack().createUndoAction(this, tr("&Undo"));
     undoAction->setShortcuts(QKeySequence::Undo);
     addAction(undoAction);
@@ -392,6 +414,28 @@ void GraphicsView::showEvent(QShowEvent *event)
     centerScene();
 }
 
+void GraphicsView::setComputeCostVisible(bool visible)
+{
+    BasicGraphicsScene *scene = nodeScene();
+    if (!scene)
+        return;
+
+    auto painter = dynamic_cast<DefaultNodePainter *>(&scene->nodePainter());
+    if (!painter)
+        return;
+
+    painter->setComputeCostVisible(visible);
+
+    if (_computeCostAction)
+        _computeCostAction->setChecked(visible);
+
+    // The nodes cache their pixels.
+    for (QGraphicsItem *item : scene->items()) {
+        if (auto ngo = qgraphicsitem_cast<NodeGraphicsObject *>(item))
+            ngo->update();
+    }
+}
+
 BasicGraphicsScene *GraphicsView::nodeScene()
 {
     return dynamic_cast<BasicGraphicsScene *>(scene());
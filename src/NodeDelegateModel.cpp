@@ -1,15 +1,100 @@
 #include "NodeDelegateModel.hpp"
 
 #include "StyleCollection.hpp"
+#include "TaskScheduler.hpp"
+
+#include <QtCore/QDebug>
+#include <QtCore/QMetaObject>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <utility>
 
 namespace QtNodes {
 
+/**
+ * Shared between a model and its running computations. Worker threads post
+ * the results through the guard which stops forwarding them once the model
+ * is destroyed.
+ *
+ * Every computation is tagged with the generation it was started in. A
+ * computation becomes stale once a newer one is started or the model
+ * cancels its work.
+ */
+class ComputationGuard
+{
+public:
+    explicit ComputationGuard(NodeDelegateModel *model)
+        : _model(model)
+        , _generation(0)
+    {}
+
+    /// Makes all the started computations stale.
+    std::uint64_t advance() { return ++_generation; }
+
+    bool isCurrent(std::uint64_t generation) const { return _generation == generation; }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _model = nullptr;
+    }
+
+    /// Queues `function` to the thread of the model if the model is alive.
+    void post(std::function<void()> function)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Queued calls of a deleted receiver are discarded by Qt.
+        if (_model)
+            QMetaObject::invokeMethod(_model, std::move(function), Qt::QueuedConnection);
+    }
+
+private:
+    std::mutex _mutex;
+
+    NodeDelegateModel *_model;
+
+    std::atomic<std::uint64_t> _generation;
+};
+
+namespace {
+
+/// The computation running on the current thread.
+thread_local ComputationGuard const *currentGuard = nullptr;
+thread_local std::uint64_t currentGeneration = 0;
+
+std::function<void()> runTask(std::function<std::function<void()>()> const &task)
+{
+    try {
+        return task();
+    } catch (std::exception const &e) {
+        qWarning() << "Node computation failed:" << e.what();
+    }
+
+    return {};
+}
+
+} // namespace
+
 NodeDelegateModel::NodeDelegateModel()
     : _nodeStyle(StyleCollection::nodeStyle())
+    , _asyncExecution(false)
+    , _runningComputations(0)
+    , _computationGuard(std::make_shared<ComputationGuard>(this))
+    , _traceNodeId(InvalidNodeId)
 {
     // Derived classes can initialize specific style here
 }
 
+NodeDelegateModel::~NodeDelegateModel()
+{
+    _computationGuard->reset();
+}
+
 QJsonObject NodeDelegateModel::save() const
 {
     QJsonObject modelJson;
@@ -51,4 +136,220 @@ void NodeDelegateModel::setNodeStyle(NodeStyle const &style)
     _nodeStyle = style;
 }
 
+void NodeDelegateModel::setAsyncExecution(bool async)
+{
+    _asyncExecution = async;
+}
+
+void NodeDelegateModel::setComputationCache(std::shared_ptr<ComputationCache> cache)
+{
+    _computationCache = std::move(cache);
+}
+
+void NodeDelegateModel::setComputationTrace(std::shared_ptr<ComputationTrace> trace,
+                                            NodeId const nodeId)
+{
+    _computationTrace = std::move(trace);
+    _traceNodeId = nodeId;
+}
+
+ComputationTrace::Span NodeDelegateModel::traceSpan(ComputationTrace::SpanKind kind) const
+{
+    ComputationTrace::Span span;
+    span.nodeId = _traceNodeId;
+    span.modelName = name();
+    span.kind = kind;
+    span.cached = false;
+    span.inputBytes = _inputBytes;
+    span.inputBytes.resize(nPorts(PortType::In), 0);
+    span.start = 0;
+    span.duration = 0;
+    span.thread = 0;
+    return span;
+}
+
+void NodeDelegateModel::setInputIdentity(PortIndex const portIndex,
+                                         std::shared_ptr<NodeData> const &data)
+{
+    if (_inputIdentities.size() <= portIndex) {
+        _inputIdentities.resize(portIndex + 1, 0);
+        _inputBytes.resize(portIndex + 1, 0);
+    }
+
+    // Missing data is known content, unlike data without identity.
+    _inputIdentities[portIndex] = data ? data->identity() : ~std::size_t(0);
+    _inputBytes[portIndex] = data ? data->byteSize() : 0;
+}
+
+bool NodeDelegateModel::computationKey(ComputationCache::Key &key) const
+{
+    if (!_computationCache || !cacheable())
+        return false;
+
+    key.inputs = _inputIdentities;
+    key.inputs.resize(nPorts(PortType::In), ~std::size_t(0));
+
+    for (std::size_t const identity : key.inputs) {
+        if (identity == 0)
+            return false;
+    }
+
+    key.modelName = name();
+    key.parameters = computationParameters();
+
+    return true;
+}
+
+void NodeDelegateModel::runComputation(ComputeTask task)
+{
+    std::uint64_t const generation = _computationGuard->advance();
+
+    ComputationCache::Key key;
+
+    std::shared_ptr<ComputationTrace> const trace
+        = _computationTrace && _computationTrace->recording() ? _computationTrace : nullptr;
+
+    if (computationKey(key)) {
+        ComputationCache::Outputs outputs;
+
+        std::int64_t const start = trace ? trace->now() : 0;
+
+        if (_computationCache->find(key, outputs) && restoreOutData(outputs)) {
+            if (trace) {
+                ComputationTrace::Span span = traceSpan(ComputationTrace::SpanKind::Computation);
+                span.cached = true;
+                span.start = start;
+                span.duration = trace->now() - start;
+                trace->record(std::move(span));
+            }
+
+            Q_EMIT computationScheduled();
+
+            for (PortIndex i = 0; i < nPorts(PortType::Out); ++i) {
+                Q_EMIT dataUpdated(i);
+            }
+
+            return;
+        }
+
+        // Stores the outputs once the result was applied.
+        task = [this, task, key]() -> std::function<void()> {
+            std::function<void()> apply = task();
+
+            if (!apply)
+                return apply;
+
+            return [this, apply, key]() {
+                apply();
+
+                ComputationCache::Outputs results;
+                for (PortIndex i = 0; i < nPorts(PortType::Out); ++i) {
+                    results.push_back(outData(i));
+                }
+
+                _computationCache->insert(key, std::move(results));
+            };
+        };
+    }
+
+    ComputationTrace::Span const span = trace ? traceSpan(ComputationTrace::SpanKind::Computation)
+                                              : ComputationTrace::Span();
+
+    // Times the task on the thread running it, the statistics follow once
+    // the result was applied.
+    task = [this, task, trace, span]() -> std::function<void()> {
+        auto const start = std::chrono::steady_clock::now();
+
+        std::function<void()> apply = task();
+
+        std::int64_t const nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now() - start)
+                                             .count();
+
+        if (trace) {
+            ComputationTrace::Span timed = span;
+            timed.start = trace->now() - nanoseconds;
+            timed.duration = nanoseconds;
+            trace->record(std::move(timed));
+        }
+
+        if (!apply)
+            return apply;
+
+        return [this, apply, nanoseconds]() {
+            apply();
+            updateComputeStatistics(nanoseconds);
+        };
+    };
+
+    if (_runningComputations++ == 0)
+        Q_EMIT computingStarted();
+
+    Q_EMIT computationScheduled();
+
+    if (!_asyncExecution) {
+        finishComputation(generation, runTask(task));
+        return;
+    }
+
+    std::shared_ptr<ComputationGuard> guard = _computationGuard;
+
+    // `this` is only dereferenced by the posted function, on the model's thread.
+    TaskScheduler::globalInstance().submit([this, guard, task, generation]() {
+        std::function<void()> apply;
+
+        // A queued task superseded before it started is skipped.
+        if (guard->isCurrent(generation)) {
+            currentGuard = guard.get();
+            currentGeneration = generation;
+
+            apply = runTask(task);
+
+            currentGuard = nullptr;
+        }
+
+        guard->post([this, generation, apply]() { finishComputation(generation, apply); });
+    });
+}
+
+void NodeDelegateModel::cancelComputations()
+{
+    if (_runningComputations > 0)
+        _computationGuard->advance();
+}
+
+bool NodeDelegateModel::computationCancelled()
+{
+    return currentGuard && !currentGuard->isCurrent(currentGeneration);
+}
+
+void NodeDelegateModel::finishComputation(std::uint64_t generation,
+                                          std::function<void()> const &apply)
+{
+    // Results of superseded computations are dropped.
+    if (apply && _computationGuard->isCurrent(generation))
+        apply();
+
+    if (--_runningComputations == 0)
+        Q_EMIT computingFinished();
+}
+
+void NodeDelegateModel::updateComputeStatistics(std::int64_t nanoseconds)
+{
+    ComputeStatistics &statistics = _computeStatistics;
+
+    statistics.lastNanoseconds = nanoseconds;
+    statistics.averageNanoseconds = statistics.computations == 0
+                                        ? nanoseconds
+                                        : statistics.averageNanoseconds
+                                              + 0.25 * (nanoseconds - statistics.averageNanoseconds);
+    ++statistics.computations;
+
+    statistics.outputBytes = 0;
+    for (PortIndex i = 0; i < nPorts(PortType::Out); ++i) {
+        if (auto const data = outData(i))
+            statistics.outputBytes += data->byteSize();
+    }
+}
+
 } // namespace QtNodes
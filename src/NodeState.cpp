@@ -9,6 +9,7 @@ NodeState::NodeState(NodeGraphicsObject &ngo)
     : _ngo(ngo)
     , _hovered(false)
     , _resizing(false)
+    , _computing(false)
     , _connectionForReaction{nullptr}
 {
     Q_UNUSED(_ngo);
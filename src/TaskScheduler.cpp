@@ -0,0 +1,260 @@
+#include "TaskScheduler.hpp"
+
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace QtNodes {
+
+namespace {
+
+/// Identifies the worker running on the current thread.
+thread_local TaskScheduler const *currentScheduler = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+unsigned int resolvedWorkerCount(unsigned int workerCount)
+{
+    return workerCount > 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+TaskScheduler::TaskScheduler(unsigned int workerCount)
+    : _workerCount(resolvedWorkerCount(workerCount))
+    , _started(false)
+    , _nextWorker(0)
+    , _queuedTasks(0)
+    , _unfinishedTasks(0)
+    , _stopping(false)
+{}
+
+TaskScheduler::~TaskScheduler()
+{
+    stop();
+}
+
+TaskScheduler &TaskScheduler::globalInstance()
+{
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+unsigned int TaskScheduler::workerCount() const
+{
+    return _workerCount;
+}
+
+void TaskScheduler::setWorkerCount(unsigned int workerCount)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_started)
+        throw std::logic_error("TaskScheduler::setWorkerCount called after the workers started");
+
+    _workerCount = resolvedWorkerCount(workerCount);
+}
+
+void TaskScheduler::submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_started)
+            start();
+
+        // Counted before a worker can see the task, `takeTask` and `run`
+        // never drive the counters below the queued and running tasks.
+        ++_queuedTasks;
+        ++_unfinishedTasks;
+
+        std::size_t index = 0;
+
+        if (currentScheduler == this)
+            index = currentWorker;
+        else
+            index = _nextWorker++ % _workers.size();
+
+        Worker &worker = *_workers[index];
+        std::lock_guard<std::mutex> workerLock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+
+    _wakeUp.notify_one();
+}
+
+void TaskScheduler::parallelFor(std::size_t count, std::function<void(std::size_t)> const &body)
+{
+    if (count == 0)
+        return;
+
+    struct Loop
+    {
+        std::function<void(std::size_t)> body;
+        std::size_t count;
+        std::atomic<std::size_t> next{0};
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::size_t done = 0;
+
+        /// The first exception thrown by `body`, the remaining indices are skipped.
+        std::exception_ptr error;
+        std::atomic<bool> failed{false};
+
+        /// Takes indices until none is left.
+        void run()
+        {
+            std::size_t processed = 0;
+            std::exception_ptr thrown;
+
+            for (std::size_t i = next++; i < count; i = next++) {
+                // A failed index still counts as done, the caller is waiting for all of them.
+                if (!failed) {
+                    try {
+                        body(i);
+                    } catch (...) {
+                        if (!thrown)
+                            thrown = std::current_exception();
+                        failed = true;
+                    }
+                }
+                ++processed;
+            }
+
+            if (processed == 0)
+                return;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (thrown && !error)
+                error = thrown;
+            done += processed;
+            if (done == count)
+                finished.notify_all();
+        }
+    };
+
+    auto loop = std::make_shared<Loop>();
+    loop->body = body;
+    loop->count = count;
+
+    // Helpers starting after the caller took the last index exit at once.
+    std::size_t const helpers = std::min<std::size_t>(count, workerCount()) - 1;
+    for (std::size_t i = 0; i < helpers; ++i) {
+        submit([loop]() { loop->run(); });
+    }
+
+    loop->run();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&loop]() { return loop->done == loop->count; });
+
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
+
+void TaskScheduler::waitForIdle()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]() { return _unfinishedTasks == 0; });
+}
+
+void TaskScheduler::start()
+{
+    _started = true;
+
+    for (unsigned int i = 0; i < _workerCount; ++i) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Threads start once all the queues exist, they may steal from any of them.
+    for (std::size_t i = 0; i < _workers.size(); ++i) {
+        _workers[i]->thread = std::thread([this, i]() { run(i); });
+    }
+}
+
+void TaskScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _wakeUp.notify_all();
+
+    for (auto &worker : _workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+void TaskScheduler::run(std::size_t workerIndex)
+{
+    currentScheduler = this;
+    currentWorker = workerIndex;
+
+    for (;;) {
+        Task task;
+
+        if (takeTask(workerIndex, task)) {
+            try {
+                task();
+            } catch (std::exception const &e) {
+                qWarning() << "Scheduled task failed:" << e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_unfinishedTasks == 0)
+                _idle.notify_all();
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wakeUp.wait(lock, [this]() { return _stopping || _queuedTasks > 0; });
+
+        // The queues are drained before the workers leave.
+        if (_stopping && _queuedTasks == 0)
+            break;
+    }
+
+    currentScheduler = nullptr;
+}
+
+bool TaskScheduler::takeTask(std::size_t workerIndex, Task &task)
+{
+    bool found = false;
+
+    {
+        // The most recently pushed task of our own.
+        Worker &worker = *_workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // The oldest task of another worker.
+    for (std::size_t i = 1; !found && i < _workers.size(); ++i) {
+        Worker &victim = *_workers[(workerIndex + i) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (found) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_queuedTasks;
+    }
+
+    return found;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <QtNodes/NodeData>
+#include <QtNodes/NodeDelegateModel>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/// An integer flowing through the test graphs, identified by its value.
+class NumberData : public QtNodes::NodeData
+{
+public:
+    explicit NumberData(int value)
+        : _value(value)
+    {}
+
+    QtNodes::NodeDataType type() const override { return QtNodes::NodeDataType{"number", "N"}; }
+
+    std::size_t identity() const override { return (static_cast<std::size_t>(_value) << 1) | 1; }
+
+    int value() const { return _value; }
+
+private:
+    int _value;
+};
+
+/// Asks for the numbers up to `limit`, the union takes the larger limit.
+class NumberRequest : public QtNodes::NodeDataRequest
+{
+public:
+    explicit NumberRequest(int limit)
+        : limit(limit)
+    {}
+
+    std::shared_ptr<QtNodes::NodeDataRequest const> united(
+        QtNodes::NodeDataRequest const &other) const override
+    {
+        auto const *request = dynamic_cast<NumberRequest const *>(&other);
+        if (!request)
+            return nullptr;
+
+        return std::make_shared<NumberRequest>(std::max(limit, request->limit));
+    }
+
+    bool equals(QtNodes::NodeDataRequest const &other) const override
+    {
+        auto const *request = dynamic_cast<NumberRequest const *>(&other);
+        return request && request->limit == limit;
+    }
+
+    int const limit;
+};
+
+/// A node without inputs publishing `setValue`.
+class NumberSourceModel : public QtNodes::NodeDelegateModel
+{
+public:
+    QString caption() const override { return "Source"; }
+
+    QString name() const override { return "Source"; }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return portType == QtNodes::PortType::Out ? 1 : 0;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType, QtNodes::PortIndex) const override
+    {
+        return QtNodes::NodeDataType{"number", "N"};
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex) override { return _data; }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData>, QtNodes::PortIndex) override {}
+
+    QWidget *embeddedWidget() override { return nullptr; }
+
+    void setValue(int value)
+    {
+        _data = std::make_shared<NumberData>(value);
+        Q_EMIT dataUpdated(0);
+    }
+
+private:
+    std::shared_ptr<NumberData> _data;
+};
+
+/// Adds its two inputs and `offset`, missing inputs count as 0, and logs its evaluations.
+class NumberSumModel : public QtNodes::NodeDelegateModel
+{
+public:
+    QString caption() const override { return "Sum"; }
+
+    QString name() const override { return "Sum"; }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return portType == QtNodes::PortType::In ? 2 : 1;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType, QtNodes::PortIndex) const override
+    {
+        return QtNodes::NodeDataType{"number", "N"};
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex) override { return _result; }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData> data, QtNodes::PortIndex portIndex) override
+    {
+        _inputs[portIndex] = std::dynamic_pointer_cast<NumberData>(data);
+    }
+
+    QWidget *embeddedWidget() override { return nullptr; }
+
+    bool cacheable() const override { return memoized; }
+
+    QJsonObject computationParameters() const override
+    {
+        QJsonObject parameters;
+        parameters["offset"] = offset;
+        return parameters;
+    }
+
+    /// Passes the request of the output on, unless the node asks for `ownRequest`.
+    std::shared_ptr<QtNodes::NodeDataRequest const> inRequest(QtNodes::PortIndex) const override
+    {
+        ++inRequestCalls;
+        return ownRequest ? ownRequest : outRequest;
+    }
+
+    bool setOutRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request,
+                       QtNodes::PortIndex) override
+    {
+        outRequest = request;
+        return false;
+    }
+
+    /// Makes the node a sink asking for `request`.
+    void setOwnRequest(std::shared_ptr<QtNodes::NodeDataRequest const> request)
+    {
+        ownRequest = std::move(request);
+        Q_EMIT inRequestsChanged();
+    }
+
+    bool restoreOutData(std::vector<std::shared_ptr<QtNodes::NodeData>> const &outputs) override
+    {
+        _result = std::dynamic_pointer_cast<NumberData>(outputs.front());
+        return static_cast<bool>(_result);
+    }
+
+    void inputsUpdated() override
+    {
+        ++evaluations;
+
+        if (log)
+            log->push_back(label);
+
+        int sum = offset;
+        for (auto const &input : _inputs) {
+            if (input)
+                sum += input->value();
+        }
+
+        std::function<void()> hook = std::move(nextTaskHook);
+        nextTaskHook = nullptr;
+
+        runComputation([this, sum, hook]() -> std::function<void()> {
+            if (hook)
+                hook();
+
+            if (computationCancelled())
+                ++cancelledTasks;
+
+            ++finishedTasks;
+
+            return [this, sum]() {
+                ++applied;
+                _result = std::make_shared<NumberData>(sum);
+                Q_EMIT dataUpdated(0);
+            };
+        });
+    }
+
+    int result() const { return _result ? _result->value() : 0; }
+
+    void setOffset(int value)
+    {
+        offset = value;
+        inputsUpdated();
+    }
+
+public:
+    int evaluations = 0;
+
+    /// Receives `label` on every evaluation.
+    std::vector<int> *log = nullptr;
+
+    int label = 0;
+
+    /// Runs inside the next computation task, on a worker thread in the asynchronous mode.
+    std::function<void()> nextTaskHook;
+
+    /// Tasks that saw their result superseded.
+    std::atomic<int> cancelledTasks{0};
+
+    /// Tasks that returned, their results may still wait for the event loop.
+    std::atomic<int> finishedTasks{0};
+
+    /// Results stored by the model, the ones restored from the cache do not count.
+    int applied = 0;
+
+    int offset = 0;
+
+    bool memoized = false;
+
+    std::shared_ptr<QtNodes::NodeDataRequest const> ownRequest;
+
+    std::shared_ptr<QtNodes::NodeDataRequest const> outRequest;
+
+    /// Counts how often the graph merged the requests of the node.
+    mutable int inRequestCalls = 0;
+
+private:
+    std::shared_ptr<NumberData> _inputs[2];
+
+    std::shared_ptr<NumberData> _result;
+};
+
+/// Takes any number of inputs, the ports are inserted and removed at runtime.
+class NumberListModel : public QtNodes::NodeDelegateModel
+{
+public:
+    QString caption() const override { return "List"; }
+
+    QString name() const override { return "List"; }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return portType == QtNodes::PortType::In ? _inPorts : 1;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType, QtNodes::PortIndex) const override
+    {
+        return QtNodes::NodeDataType{"number", "N"};
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex) override { return nullptr; }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData>, QtNodes::PortIndex) override {}
+
+    QWidget *embeddedWidget() override { return nullptr; }
+
+    void insertInPort(QtNodes::PortIndex portIndex)
+    {
+        Q_EMIT portsAboutToBeInserted(QtNodes::PortType::In, portIndex, portIndex);
+        ++_inPorts;
+        Q_EMIT portsInserted();
+    }
+
+    void removeInPort(QtNodes::PortIndex portIndex)
+    {
+        Q_EMIT portsAboutToBeDeleted(QtNodes::PortType::In, portIndex, portIndex);
+        --_inPorts;
+        Q_EMIT portsDeleted();
+    }
+
+private:
+    unsigned int _inPorts = 3;
+};
@@ -0,0 +1,148 @@
+#include <QtNodes/ComputationCache>
+
+#include <catch2/catch.hpp>
+
+#include <cstddef>
+#include <memory>
+
+using QtNodes::ComputationCache;
+using QtNodes::NodeData;
+using QtNodes::NodeDataType;
+
+namespace {
+
+/// Data of a given size, identified by its tag.
+class SizedData : public NodeData
+{
+public:
+    SizedData(std::size_t tag, std::size_t bytes)
+        : _tag(tag)
+        , _bytes(bytes)
+    {}
+
+    NodeDataType type() const override { return NodeDataType{"sized", "S"}; }
+
+    std::size_t identity() const override { return _tag; }
+
+    std::size_t byteSize() const override { return _bytes; }
+
+private:
+    std::size_t _tag;
+    std::size_t _bytes;
+};
+
+ComputationCache::Key key(int parameter, std::size_t input = 1)
+{
+    ComputationCache::Key key;
+    key.modelName = "Model";
+    key.parameters["parameter"] = parameter;
+    key.inputs = {input};
+    return key;
+}
+
+ComputationCache::Outputs outputs(std::size_t tag, std::size_t bytes = 1000)
+{
+    return {std::make_shared<SizedData>(tag, bytes)};
+}
+
+std::size_t tag(ComputationCache::Outputs const &outputs)
+{
+    return outputs.front()->identity();
+}
+
+} // namespace
+
+TEST_CASE("ComputationCache hits and misses", "[cache]")
+{
+    ComputationCache cache;
+    ComputationCache::Outputs found;
+
+    CHECK_FALSE(cache.find(key(1), found));
+
+    cache.insert(key(1), outputs(11));
+
+    REQUIRE(cache.find(key(1), found));
+    CHECK(tag(found) == 11);
+
+    CHECK(cache.hits() == 1);
+    CHECK(cache.misses() == 1);
+
+    SECTION("the parameters, the inputs and the model tell the entries apart")
+    {
+        CHECK_FALSE(cache.find(key(2), found));
+        CHECK_FALSE(cache.find(key(1, 2), found));
+
+        ComputationCache::Key other = key(1);
+        other.modelName = "Other";
+        CHECK_FALSE(cache.find(other, found));
+
+        // Parameters are compared in full, not by their hash.
+        ComputationCache::Key extended = key(1);
+        extended.parameters["extra"] = true;
+        CHECK_FALSE(cache.find(extended, found));
+    }
+
+    SECTION("inserting a key again replaces its outputs")
+    {
+        cache.insert(key(1), outputs(12));
+
+        REQUIRE(cache.find(key(1), found));
+        CHECK(tag(found) == 12);
+        CHECK(cache.entryCount() == 1);
+    }
+
+    SECTION("clear")
+    {
+        cache.clear();
+
+        CHECK_FALSE(cache.find(key(1), found));
+        CHECK(cache.entryCount() == 0);
+        CHECK(cache.usedBytes() == 0);
+    }
+}
+
+TEST_CASE("ComputationCache evicts the least recently used entries", "[cache]")
+{
+    // Two entries of 1000 bytes fit, a third one does not.
+    ComputationCache cache(2500);
+    ComputationCache::Outputs found;
+
+    cache.insert(key(1), outputs(11));
+    cache.insert(key(2), outputs(12));
+
+    SECTION("the oldest entry goes")
+    {
+        cache.insert(key(3), outputs(13));
+
+        CHECK_FALSE(cache.find(key(1), found));
+        CHECK(cache.find(key(2), found));
+        CHECK(cache.find(key(3), found));
+    }
+
+    SECTION("a hit makes the entry recent")
+    {
+        REQUIRE(cache.find(key(1), found));
+
+        cache.insert(key(3), outputs(13));
+
+        CHECK(cache.find(key(1), found));
+        CHECK_FALSE(cache.find(key(2), found));
+    }
+
+    SECTION("lowering the budget")
+    {
+        cache.setByteBudget(1500);
+
+        CHECK(cache.entryCount() == 1);
+        CHECK(cache.find(key(2), found));
+        CHECK(cache.usedBytes() <= 1500);
+    }
+
+    SECTION("outputs over the budget are not stored")
+    {
+        cache.insert(key(3), outputs(13, 4000));
+
+        CHECK_FALSE(cache.find(key(3), found));
+        CHECK(cache.entryCount() == 2);
+    }
+}
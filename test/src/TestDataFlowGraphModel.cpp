@@ -0,0 +1,522 @@
+#include <QtNodes/ConnectionIdUtils>
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+
+#include <catch2/catch.hpp>
+
+#include "ApplicationSetup.hpp"
+#include "NumberModels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::NodeRole;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+namespace {
+
+std::shared_ptr<NodeDelegateModelRegistry> numberRegistry()
+{
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<NumberSourceModel>();
+    registry->registerModel<NumberSumModel>();
+    registry->registerModel<NumberListModel>();
+    return registry;
+}
+
+/// Adds a Sum node logging its id to `log`.
+NodeId addSum(DataFlowGraphModel &model, std::vector<int> &log)
+{
+    NodeId const nodeId = model.addNode("Sum");
+
+    auto sum = model.delegateModel<NumberSumModel>(nodeId);
+    sum->log = &log;
+    sum->label = static_cast<int>(nodeId);
+
+    return nodeId;
+}
+
+/// @returns the position of `nodeId` in `log`.
+std::ptrdiff_t position(std::vector<int> const &log, NodeId nodeId)
+{
+    return std::find(log.begin(), log.end(), static_cast<int>(nodeId)) - log.begin();
+}
+
+/// The connections `save` writes, read straight from the connection set.
+std::unordered_set<ConnectionId> savedConnections(DataFlowGraphModel const &model)
+{
+    QJsonArray const connections = model.save()["connections"].toArray();
+
+    std::unordered_set<ConnectionId> result;
+    for (QJsonValue const &connection : connections) {
+        result.insert(QtNodes::fromJson(connection.toObject()));
+    }
+    return result;
+}
+
+/// Checks that the port index holds exactly the saved connections, each under both its ports.
+void checkPortIndex(DataFlowGraphModel const &model)
+{
+    std::unordered_set<ConnectionId> const saved = savedConnections(model);
+    std::unordered_set<ConnectionId> indexed;
+
+    for (NodeId const nodeId : model.allNodeIds()) {
+        std::unordered_set<ConnectionId> ofNode;
+
+        for (PortType const portType : {PortType::In, PortType::Out}) {
+            auto const countRole = portType == PortType::In ? NodeRole::InPortCount
+                                                            : NodeRole::OutPortCount;
+            unsigned int const portCount = model.nodeData(nodeId, countRole).toUInt();
+
+            for (PortIndex portIndex = 0; portIndex < portCount; ++portIndex) {
+                for (ConnectionId const &cid : model.connections(nodeId, portType, portIndex)) {
+                    CHECK(QtNodes::getNodeId(portType, cid) == nodeId);
+                    CHECK(QtNodes::getPortIndex(portType, cid) == portIndex);
+
+                    indexed.insert(cid);
+                    ofNode.insert(cid);
+                }
+            }
+
+            // Nothing is left under the ports past the end.
+            CHECK(model.connections(nodeId, portType, portCount).empty());
+        }
+
+        CHECK(model.allConnectionIds(nodeId) == ofNode);
+    }
+
+    CHECK(indexed == saved);
+}
+
+/// Delivers the posted results until no node computes, fails after 10 s.
+void waitForComputations(DataFlowGraphModel &model)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto computing = [&model]() {
+        for (NodeId const nodeId : model.allNodeIds()) {
+            if (model.delegateModel<QtNodes::NodeDelegateModel>(nodeId)->computing())
+                return true;
+        }
+        return false;
+    };
+
+    while (computing() && timer.elapsed() < 10000) {
+        QCoreApplication::processEvents();
+    }
+
+    REQUIRE_FALSE(computing());
+}
+
+} // namespace
+
+TEST_CASE("DataFlowGraphModel evaluates in topological order", "[evaluation]")
+{
+    auto setup = applicationSetup();
+
+    DataFlowGraphModel model(numberRegistry());
+
+    std::vector<int> log;
+
+    SECTION("diamond")
+    {
+        // source -> left, right -> join
+        NodeId const source = model.addNode("Source");
+        NodeId const left = addSum(model, log);
+        NodeId const right = addSum(model, log);
+        NodeId const join = addSum(model, log);
+
+        model.addConnection(ConnectionId{source, 0, left, 0});
+        model.addConnection(ConnectionId{source, 0, right, 0});
+        model.addConnection(ConnectionId{left, 0, join, 0});
+        model.addConnection(ConnectionId{right, 0, join, 1});
+
+        log.clear();
+        model.delegateModel<NumberSourceModel>(source)->setValue(3);
+
+        CHECK(model.delegateModel<NumberSumModel>(join)->result() == 6);
+
+        // The join sees both branches updated at once.
+        REQUIRE(log.size() == 3);
+        CHECK(position(log, join) == 2);
+    }
+
+    SECTION("chain")
+    {
+        NodeId const source = model.addNode("Source");
+
+        std::vector<NodeId> chain;
+        NodeId previous = source;
+        for (int i = 0; i < 6; ++i) {
+            NodeId const nodeId = addSum(model, log);
+            model.addConnection(ConnectionId{previous, 0, nodeId, 0});
+            chain.push_back(nodeId);
+            previous = nodeId;
+        }
+
+        log.clear();
+        model.delegateModel<NumberSourceModel>(source)->setValue(5);
+
+        REQUIRE(log.size() == chain.size());
+        for (std::size_t i = 0; i < chain.size(); ++i) {
+            CHECK(log[i] == static_cast<int>(chain[i]));
+        }
+
+        CHECK(model.delegateModel<NumberSumModel>(chain.back())->result() == 5);
+    }
+
+    SECTION("nodes reached through several paths")
+    {
+        // source -> a -> b -> c, source -> c
+        NodeId const source = model.addNode("Source");
+        NodeId const a = addSum(model, log);
+        NodeId const b = addSum(model, log);
+        NodeId const c = addSum(model, log);
+
+        model.addConnection(ConnectionId{source, 0, a, 0});
+        model.addConnection(ConnectionId{a, 0, b, 0});
+        model.addConnection(ConnectionId{b, 0, c, 0});
+        model.addConnection(ConnectionId{source, 0, c, 1});
+
+        log.clear();
+        model.delegateModel<NumberSourceModel>(source)->setValue(2);
+
+        REQUIRE(log.size() == 3);
+        CHECK(position(log, a) < position(log, b));
+        CHECK(position(log, b) < position(log, c));
+        CHECK(model.delegateModel<NumberSumModel>(c)->result() == 4);
+    }
+
+    SECTION("load")
+    {
+        NodeId const source = model.addNode("Source");
+        NodeId const left = addSum(model, log);
+        NodeId const right = addSum(model, log);
+        NodeId const join = addSum(model, log);
+
+        model.addConnection(ConnectionId{source, 0, left, 0});
+        model.addConnection(ConnectionId{source, 0, right, 0});
+        model.addConnection(ConnectionId{left, 0, join, 0});
+        model.addConnection(ConnectionId{right, 0, join, 1});
+
+        DataFlowGraphModel loaded(numberRegistry());
+        loaded.load(model.save());
+
+        // The restored graph is evaluated once, every node exactly once.
+        REQUIRE(loaded.allNodeIds().size() == 4);
+        for (NodeId const nodeId : loaded.allNodeIds()) {
+            if (auto sum = loaded.delegateModel<NumberSumModel>(nodeId))
+                CHECK(sum->evaluations == 1);
+        }
+    }
+}
+
+TEST_CASE("DataFlowGraphModel drops cancelled results", "[evaluation]")
+{
+    auto setup = applicationSetup();
+
+    DataFlowGraphModel model(numberRegistry());
+    model.setAsyncExecution(true);
+
+    std::vector<int> log;
+
+    NodeId const source = model.addNode("Source");
+    NodeId const first = addSum(model, log);
+    NodeId const second = addSum(model, log);
+
+    model.addConnection(ConnectionId{source, 0, first, 0});
+    model.addConnection(ConnectionId{first, 0, second, 0});
+    waitForComputations(model);
+
+    auto firstSum = model.delegateModel<NumberSumModel>(first);
+    auto secondSum = model.delegateModel<NumberSumModel>(second);
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+
+    SECTION("superseded computation of the node")
+    {
+        firstSum->nextTaskHook = [opened]() { opened.wait(); };
+        int const applied = firstSum->applied;
+
+        model.delegateModel<NumberSourceModel>(source)->setValue(1);
+        REQUIRE(firstSum->computing());
+
+        model.delegateModel<NumberSourceModel>(source)->setValue(2);
+
+        gate.set_value();
+        waitForComputations(model);
+
+        CHECK(firstSum->cancelledTasks == 1);
+        CHECK(firstSum->applied == applied + 1);
+        CHECK(secondSum->result() == 2);
+    }
+
+    SECTION("computation downstream of a rescheduled node")
+    {
+        // The second node computes from the output the first one replaces.
+        secondSum->nextTaskHook = [opened]() { opened.wait(); };
+        int const applied = secondSum->applied;
+        int const finished = secondSum->finishedTasks;
+
+        model.delegateModel<NumberSourceModel>(source)->setValue(1);
+
+        QElapsedTimer timer;
+        timer.start();
+        while (!secondSum->computing() && timer.elapsed() < 10000) {
+            QCoreApplication::processEvents();
+        }
+        REQUIRE(secondSum->computing());
+
+        // No event is processed until the gated task returned, only the
+        // cancellation can make it stale.
+        model.delegateModel<NumberSourceModel>(source)->setValue(2);
+        gate.set_value();
+
+        while (secondSum->finishedTasks == finished && timer.elapsed() < 10000) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(secondSum->cancelledTasks == 1);
+
+        waitForComputations(model);
+
+        CHECK(secondSum->applied == applied + 1);
+        CHECK(secondSum->result() == 2);
+    }
+}
+
+TEST_CASE("DataFlowGraphModel memoizes cacheable nodes", "[evaluation][cache]")
+{
+    auto setup = applicationSetup();
+
+    DataFlowGraphModel model(numberRegistry());
+
+    std::vector<int> log;
+
+    NodeId const source = model.addNode("Source");
+    NodeId const sum = addSum(model, log);
+
+    auto sumModel = model.delegateModel<NumberSumModel>(sum);
+    sumModel->memoized = true;
+
+    model.addConnection(ConnectionId{source, 0, sum, 0});
+
+    auto sourceModel = model.delegateModel<NumberSourceModel>(source);
+
+    sourceModel->setValue(1);
+    sourceModel->setValue(2);
+    int const applied = sumModel->applied;
+
+    SECTION("known inputs are restored")
+    {
+        sourceModel->setValue(1);
+
+        CHECK(sumModel->result() == 1);
+        CHECK(sumModel->applied == applied);
+    }
+
+    SECTION("changed parameters miss")
+    {
+        sumModel->setOffset(10);
+
+        CHECK(sumModel->result() == 12);
+        CHECK(sumModel->applied == applied + 1);
+
+        sumModel->setOffset(0);
+
+        CHECK(sumModel->result() == 2);
+        CHECK(sumModel->applied == applied + 1);
+    }
+
+    SECTION("cleared cache")
+    {
+        model.computationCache().clear();
+        sourceModel->setValue(1);
+
+        CHECK(sumModel->result() == 1);
+        CHECK(sumModel->applied == applied + 1);
+    }
+}
+
+TEST_CASE("DataFlowGraphModel propagates requests upstream", "[requests]")
+{
+    auto setup = applicationSetup();
+
+    DataFlowGraphModel model(numberRegistry());
+
+    std::vector<int> log;
+
+    // source -> chain[0] -> ... -> chain[19]
+    NodeId const source = model.addNode("Source");
+
+    std::vector<NodeId> chain;
+    NodeId previous = source;
+    for (int i = 0; i < 20; ++i) {
+        NodeId const nodeId = addSum(model, log);
+        model.addConnection(ConnectionId{previous, 0, nodeId, 0});
+        chain.push_back(nodeId);
+        previous = nodeId;
+    }
+
+    auto sum = [&model](NodeId nodeId) { return model.delegateModel<NumberSumModel>(nodeId); };
+
+    auto limit = [&sum](NodeId nodeId) {
+        auto request = std::dynamic_pointer_cast<NumberRequest const>(sum(nodeId)->outRequest);
+        return request ? request->limit : -1;
+    };
+
+    sum(chain.back())->setOwnRequest(std::make_shared<NumberRequest>(5));
+
+    for (std::size_t i = 0; i + 1 < chain.size(); ++i) {
+        CHECK(limit(chain[i]) == 5);
+    }
+
+    SECTION("a second consumer widens the request")
+    {
+        NodeId const consumer = addSum(model, log);
+        sum(consumer)->setOwnRequest(std::make_shared<NumberRequest>(9));
+
+        model.addConnection(ConnectionId{chain[9], 0, consumer, 0});
+
+        for (std::size_t i = 0; i < 10; ++i) {
+            CHECK(limit(chain[i]) == 9);
+        }
+        CHECK(limit(chain[10]) == 5);
+
+        model.deleteConnection(ConnectionId{chain[9], 0, consumer, 0});
+
+        for (std::size_t i = 0; i < 10; ++i) {
+            CHECK(limit(chain[i]) == 5);
+        }
+    }
+
+    SECTION("an edit leaving the requests alone stops at once")
+    {
+        for (NodeId const nodeId : chain) {
+            sum(nodeId)->inRequestCalls = 0;
+        }
+
+        // The new consumer passes on the request it does not have yet.
+        NodeId const consumer = addSum(model, log);
+        model.addConnection(ConnectionId{chain.back(), 0, consumer, 0});
+
+        CHECK(sum(consumer)->inRequestCalls == 1);
+        for (NodeId const nodeId : chain) {
+            CHECK(sum(nodeId)->inRequestCalls == 0);
+        }
+    }
+}
+
+TEST_CASE("DataFlowGraphModel keeps the port index consistent", "[connections]")
+{
+    auto setup = applicationSetup();
+
+    DataFlowGraphModel model(numberRegistry());
+
+    std::vector<int> log;
+
+    // sources[i] -> list port i, list -> sum
+    std::vector<NodeId> sources;
+    NodeId const list = model.addNode("List");
+    NodeId const sum = addSum(model, log);
+
+    for (PortIndex i = 0; i < 3; ++i) {
+        sources.push_back(model.addNode("Source"));
+        model.addConnection(ConnectionId{sources[i], 0, list, i});
+    }
+    model.addConnection(ConnectionId{list, 0, sum, 0});
+
+    auto listModel = model.delegateModel<NumberListModel>(list);
+
+    using Connections = std::unordered_set<ConnectionId>;
+
+    checkPortIndex(model);
+
+    SECTION("removed ports shift the later ones down")
+    {
+        listModel->removeInPort(0);
+
+        checkPortIndex(model);
+
+        CHECK(model.connections(list, PortType::In, 0)
+              == Connections{ConnectionId{sources[1], 0, list, 0}});
+        CHECK(model.connections(list, PortType::In, 1)
+              == Connections{ConnectionId{sources[2], 0, list, 1}});
+        CHECK(model.connections(sources[0], PortType::Out, 0).empty());
+        CHECK(model.connections(sources[2], PortType::Out, 0)
+              == Connections{ConnectionId{sources[2], 0, list, 1}});
+    }
+
+    SECTION("inserted ports shift the later ones up")
+    {
+        listModel->insertInPort(1);
+
+        checkPortIndex(model);
+
+        CHECK(model.connections(list, PortType::In, 0)
+              == Connections{ConnectionId{sources[0], 0, list, 0}});
+        CHECK(model.connections(list, PortType::In, 1).empty());
+        CHECK(model.connections(list, PortType::In, 3)
+              == Connections{ConnectionId{sources[2], 0, list, 3}});
+    }
+
+    SECTION("deleteNode")
+    {
+        model.deleteNode(list);
+
+        checkPortIndex(model);
+
+        for (NodeId const source : sources) {
+            CHECK(model.connections(source, PortType::Out, 0).empty());
+        }
+        CHECK(model.connections(sum, PortType::In, 0).empty());
+
+        // No entry of the deleted node stays behind.
+        for (PortIndex i = 0; i < 3; ++i) {
+            CHECK(model.connections(list, PortType::In, i).empty());
+        }
+        CHECK(model.connections(list, PortType::Out, 0).empty());
+    }
+
+    SECTION("deleteNode of a source")
+    {
+        model.deleteNode(sources[1]);
+
+        checkPortIndex(model);
+
+        CHECK(model.connections(list, PortType::In, 1).empty());
+        CHECK(model.connections(list, PortType::In, 2)
+              == Connections{ConnectionId{sources[2], 0, list, 2}});
+    }
+
+    SECTION("load")
+    {
+        DataFlowGraphModel loaded(numberRegistry());
+        loaded.load(model.save());
+
+        checkPortIndex(loaded);
+
+        CHECK(savedConnections(loaded) == savedConnections(model));
+        for (PortIndex i = 0; i < 3; ++i) {
+            CHECK(loaded.connections(list, PortType::In, i)
+                  == Connections{ConnectionId{sources[i], 0, list, i}});
+        }
+        CHECK(loaded.connections(list, PortType::Out, 0)
+              == Connections{ConnectionId{list, 0, sum, 0}});
+    }
+}
@@ -0,0 +1,191 @@
+#include "ApplicationSetup.hpp"
+#include "StubNodeDelegateModel.hpp"
+
+#include <QtNodes/ConnectionIdUtils>
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <utility>
+
+using QtNodes::ConnectionId;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::PortType;
+
+namespace {
+
+class MockDataModel : public StubNodeDelegateModel
+{
+public:
+    unsigned int nPorts(PortType) const override { return 1; }
+
+    void inputConnectionCreated(ConnectionId const &) override { inputCreatedCalledCount++; }
+
+    void inputConnectionDeleted(ConnectionId const &) override { inputDeletedCalledCount++; }
+
+    void outputConnectionCreated(ConnectionId const &) override { outputCreatedCalledCount++; }
+
+    void outputConnectionDeleted(ConnectionId const &) override { outputDeletedCalledCount++; }
+
+    int inputCreatedCalledCount = 0;
+    int inputDeletedCalledCount = 0;
+    int outputCreatedCalledCount = 0;
+    int outputDeletedCalledCount = 0;
+
+    void resetCallCounts()
+    {
+        inputCreatedCalledCount = 0;
+        inputDeletedCalledCount = 0;
+        outputCreatedCalledCount = 0;
+        outputDeletedCalledCount = 0;
+    }
+};
+
+} // namespace
+
+TEST_CASE("DataFlowGraphicsScene triggers connections created or deleted", "[gui]")
+{
+    auto setup = applicationSetup();
+
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<MockDataModel>();
+
+    DataFlowGraphModel model(registry);
+    DataFlowGraphicsScene scene(model);
+
+    NodeId const fromNode = model.addNode("name");
+    NodeId const toNode = model.addNode("name");
+    NodeId const unrelatedNode = model.addNode("name");
+
+    auto &from = *model.delegateModel<MockDataModel>(fromNode);
+    auto &to = *model.delegateModel<MockDataModel>(toNode);
+    auto &unrelated = *model.delegateModel<MockDataModel>(unrelatedNode);
+
+    ConnectionId const connectionId{fromNode, 0, toNode, 0};
+
+    SECTION("creating half a connection (not finishing the connection)")
+    {
+        scene.makeDraftConnection(
+            QtNodes::makeIncompleteConnectionId(fromNode, PortType::Out, 0));
+
+        CHECK(from.inputCreatedCalledCount == 0);
+        CHECK(from.outputCreatedCalledCount == 0);
+
+        CHECK(to.inputCreatedCalledCount == 0);
+        CHECK(to.outputCreatedCalledCount == 0);
+
+        CHECK(unrelated.inputCreatedCalledCount == 0);
+        CHECK(unrelated.outputCreatedCalledCount == 0);
+
+        scene.resetDraftConnection();
+    }
+
+    SECTION("creating a connection")
+    {
+        model.addConnection(connectionId);
+
+        CHECK(from.inputCreatedCalledCount == 0);
+        CHECK(from.outputCreatedCalledCount == 1);
+
+        CHECK(to.inputCreatedCalledCount == 1);
+        CHECK(to.outputCreatedCalledCount == 0);
+
+        CHECK(unrelated.inputCreatedCalledCount == 0);
+        CHECK(unrelated.outputCreatedCalledCount == 0);
+
+        CHECK(scene.connectionGraphicsObject(connectionId) != nullptr);
+    }
+
+    SECTION("deleting a connection")
+    {
+        model.addConnection(connectionId);
+
+        from.resetCallCounts();
+        to.resetCallCounts();
+
+        SECTION("model.deleteConnection")
+        {
+            model.deleteConnection(connectionId);
+
+            CHECK(from.inputDeletedCalledCount == 0);
+            CHECK(from.outputDeletedCalledCount == 1);
+
+            CHECK(to.inputDeletedCalledCount == 1);
+            CHECK(to.outputDeletedCalledCount == 0);
+        }
+        SECTION("model.deleteNode")
+        {
+            // Only the remaining side can be asked afterwards.
+            model.deleteNode(toNode);
+
+            CHECK(from.inputDeletedCalledCount == 0);
+            CHECK(from.outputDeletedCalledCount == 1);
+        }
+
+        CHECK(unrelated.inputDeletedCalledCount == 0);
+        CHECK(unrelated.outputDeletedCalledCount == 0);
+
+        CHECK(scene.connectionGraphicsObject(connectionId) == nullptr);
+    }
+}
+
+TEST_CASE("DataFlowGraphModel's registry outlives nodes and connections", "[asan][gui]")
+{
+    class MockDataModel : public StubNodeDelegateModel
+    {
+    public:
+        MockDataModel(int *const &incrementOnDestruction)
+            : incrementOnDestruction(incrementOnDestruction)
+        {}
+
+        ~MockDataModel() { (*incrementOnDestruction)++; }
+
+        // The reference ensures that we point into the memory that would be free'd
+        // if the NodeDelegateModelRegistry doesn't outlive this node
+        int *const &incrementOnDestruction;
+    };
+
+    struct MockDataModelCreator
+    {
+        MockDataModelCreator(int *shouldBeAliveWhenAssignedTo)
+            : shouldBeAliveWhenAssignedTo(shouldBeAliveWhenAssignedTo)
+        {}
+
+        std::unique_ptr<MockDataModel> operator()() const
+        {
+            return std::make_unique<MockDataModel>(shouldBeAliveWhenAssignedTo);
+        }
+
+        int *shouldBeAliveWhenAssignedTo;
+    };
+
+    int modelsDestroyed = 0;
+
+    // Introduce a new scope, so that modelsDestroyed will be alive even after the
+    // graph model is destroyed.
+    {
+        auto setup = applicationSetup();
+
+        auto registry = std::make_shared<NodeDelegateModelRegistry>();
+        registry->registerModel<MockDataModel>(MockDataModelCreator(&modelsDestroyed));
+
+        modelsDestroyed = 0;
+
+        DataFlowGraphModel model(std::move(registry));
+        DataFlowGraphicsScene scene(model);
+
+        model.addNode("name");
+
+        // On destruction, if this node outlives its MockDataModelCreator,
+        // (if it outlives the NodeDelegateModelRegistry), then we trigger undefined
+        // behavior through use-after-free. ASAN will catch that.
+    }
+
+    CHECK(modelsDestroyed == 1);
+}
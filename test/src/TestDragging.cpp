@@ -1,48 +1,50 @@
 #include "ApplicationSetup.hpp"
 #include "Stringify.hpp"
-#include "StubNodeDataModel.hpp"
+#include "StubNodeDelegateModel.hpp"
 
-#include <QtNodes/Connection>
-#include <QtNodes/FlowScene>
-#include <QtNodes/FlowView>
-#include <QtNodes/Node>
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/GraphicsView>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include "NodeGraphicsObject.hpp"
 
 #include <catch2/catch.hpp>
 
 #include <QtTest>
 #include <QtWidgets/QApplication>
 
-using QtNodes::Connection;
-using QtNodes::DataModelRegistry;
-using QtNodes::FlowScene;
-using QtNodes::FlowView;
-using QtNodes::Node;
-using QtNodes::NodeData;
-using QtNodes::NodeDataModel;
-using QtNodes::NodeDataType;
-using QtNodes::PortIndex;
-using QtNodes::PortType;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::GraphicsView;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
 
 TEST_CASE("Dragging node changes position", "[gui]")
 {
     auto app = applicationSetup();
 
-    FlowScene scene;
-    FlowView view(&scene);
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<StubNodeDelegateModel>();
+
+    DataFlowGraphModel model(registry);
+    DataFlowGraphicsScene scene(model);
+    GraphicsView view(&scene);
 
     view.show();
     REQUIRE(QTest::qWaitForWindowExposed(&view));
 
     SECTION("just one node")
     {
-        auto &node = scene.createNode(std::make_unique<StubNodeDataModel>());
+        NodeId const nodeId = model.addNode("name");
 
-        auto &ngo = node.nodeGraphicsObject();
+        QGraphicsItem *ngo = scene.nodeGraphicsObject(nodeId);
+        REQUIRE(ngo != nullptr);
 
-        QPointF scPosBefore = ngo.pos();
+        QPointF scPosBefore = ngo->pos();
 
-        QPointF scClickPos = ngo.boundingRect().center();
-        scClickPos = QPointF(ngo.sceneTransform().map(scClickPos).toPoint());
+        QPointF scClickPos = QRectF(QPointF(0, 0), scene.nodeGeometry().size(nodeId)).center();
+        scClickPos = QPointF(ngo->sceneTransform().map(scClickPos).toPoint());
 
         QPoint vwClickPos = view.mapFromScene(scClickPos);
         QPoint vwDestPos = vwClickPos + QPoint(10, 20);
@@ -59,7 +61,7 @@ TEST_CASE("Dragging node changes position", "[gui]")
         QTest::mouseMove(view.windowHandle(), vwDestPos);
         QTest::mouseRelease(view.windowHandle(), Qt::LeftButton, Qt::NoModifier, vwDestPos);
 
-        QPointF scDelta = ngo.pos() - scPosBefore;
+        QPointF scDelta = ngo->pos() - scPosBefore;
         QPoint roundDelta = scDelta.toPoint();
         QPoint roundExpectedDelta = scExpectedDelta.toPoint();
 
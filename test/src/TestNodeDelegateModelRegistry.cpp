@@ -1,33 +1,29 @@
-#include <QtNodes/DataModelRegistry>
+#include <QtNodes/NodeDelegateModelRegistry>
 
 #include <catch2/catch.hpp>
 
-#include "StubNodeDataModel.hpp"
+#include "StubNodeDelegateModel.hpp"
 
-using QtNodes::DataModelRegistry;
-using QtNodes::NodeData;
-using QtNodes::NodeDataModel;
-using QtNodes::NodeDataType;
-using QtNodes::PortIndex;
-using QtNodes::PortType;
+using QtNodes::NodeDelegateModelRegistry;
 
 namespace {
-class StubModelStaticName : public StubNodeDataModel
+class StubModelStaticName : public StubNodeDelegateModel
 {
 public:
     static QString Name() { return "Name"; }
 };
 } // namespace
 
-TEST_CASE("DataModelRegistry::registerModel", "[interface]")
+TEST_CASE("NodeDelegateModelRegistry::registerModel", "[interface]")
 {
-    DataModelRegistry registry;
+    NodeDelegateModelRegistry registry;
 
     SECTION("stub model")
     {
-        registry.registerModel<StubNodeDataModel>();
+        registry.registerModel<StubNodeDelegateModel>();
         auto model = registry.create("name");
 
+        REQUIRE(model != nullptr);
         CHECK(model->name() == "name");
     }
     SECTION("stub model with static name")
@@ -35,23 +31,26 @@ TEST_CASE("DataModelRegistry::registerModel", "[interface]")
         registry.registerModel<StubModelStaticName>();
         auto model = registry.create("Name");
 
+        REQUIRE(model != nullptr);
         CHECK(model->name() == "name");
     }
     SECTION("From model creator function")
     {
         SECTION("non-static name()")
         {
-            registry.registerModel([] { return std::make_unique<StubNodeDataModel>(); });
+            registry.registerModel<StubNodeDelegateModel>(
+                [] { return std::make_unique<StubNodeDelegateModel>(); });
 
             auto model = registry.create("name");
 
             REQUIRE(model != nullptr);
             CHECK(model->name() == "name");
-            CHECK(dynamic_cast<StubNodeDataModel *>(model.get()));
+            CHECK(dynamic_cast<StubNodeDelegateModel *>(model.get()));
         }
         SECTION("static Name()")
         {
-            registry.registerModel([] { return std::make_unique<StubModelStaticName>(); });
+            registry.registerModel<StubModelStaticName>(
+                [] { return std::make_unique<StubModelStaticName>(); });
 
             auto model = registry.create("Name");
 
@@ -60,4 +59,8 @@ TEST_CASE("DataModelRegistry::registerModel", "[interface]")
             CHECK(dynamic_cast<StubModelStaticName *>(model.get()));
         }
     }
+    SECTION("unknown name")
+    {
+        CHECK(registry.create("unknown") == nullptr);
+    }
 }
@@ -1,44 +1,55 @@
 #include "ApplicationSetup.hpp"
-#include "StubNodeDataModel.hpp"
+#include "StubNodeDelegateModel.hpp"
 
-#include <QtNodes/FlowScene>
-#include <QtNodes/FlowView>
-#include <QtNodes/Node>
-#include <QtNodes/NodeDataModel>
+#include <QtNodes/DataFlowGraphModel>
+#include <QtNodes/DataFlowGraphicsScene>
+#include <QtNodes/GraphicsView>
+#include <QtNodes/NodeDelegateModelRegistry>
+
+#include "NodeGraphicsObject.hpp"
 
 #include <catch2/catch.hpp>
 
 #include <QtTest>
 
-using QtNodes::FlowScene;
-using QtNodes::FlowView;
-using QtNodes::Node;
-using QtNodes::NodeDataModel;
-using QtNodes::NodeGraphicsObject;
+using QtNodes::ConnectionPolicy;
+using QtNodes::DataFlowGraphicsScene;
+using QtNodes::DataFlowGraphModel;
+using QtNodes::GraphicsView;
+using QtNodes::NodeDelegateModelRegistry;
+using QtNodes::NodeId;
+using QtNodes::PortIndex;
 using QtNodes::PortType;
 
-TEST_CASE("NodeDataModel::portOutConnectionPolicy(...) isn't called for input "
-          "connections (issue #127)",
-          "[gui]")
+namespace {
+
+class MockModel : public StubNodeDelegateModel
 {
-    class MockModel : public StubNodeDataModel
-    {
-    public:
-        unsigned int nPorts(PortType) const override { return 1; }
+public:
+    unsigned int nPorts(PortType) const override { return 1; }
 
-        NodeDataModel::ConnectionPolicy portOutConnectionPolicy(int index) const override
-        {
+    ConnectionPolicy portConnectionPolicy(PortType portType, PortIndex) const override
+    {
+        if (portType == PortType::Out)
             portOutConnectionPolicyCalledCount++;
-            return NodeDataModel::ConnectionPolicy::One;
-        }
+        return ConnectionPolicy::One;
+    }
+
+    mutable int portOutConnectionPolicyCalledCount = 0;
+};
 
-        mutable int portOutConnectionPolicyCalledCount = 0;
-    };
+} // namespace
 
+TEST_CASE("The out connection policy isn't asked for input connections (issue #127)", "[gui]")
+{
     auto setup = applicationSetup();
 
-    FlowScene scene;
-    FlowView view(&scene);
+    auto registry = std::make_shared<NodeDelegateModelRegistry>();
+    registry->registerModel<MockModel>();
+
+    DataFlowGraphModel model(registry);
+    DataFlowGraphicsScene scene(model);
+    GraphicsView view(&scene);
 
     // Ensure we have enough size to contain the node
     view.resize(640, 480);
@@ -46,20 +57,28 @@ TEST_CASE("NodeDataModel::portOutConnectionPolicy(...) isn't called for input "
     view.show();
     REQUIRE(QTest::qWaitForWindowExposed(&view));
 
-    auto &node = scene.createNode(std::make_unique<MockModel>());
-    auto &model = dynamic_cast<MockModel &>(*node.nodeDataModel());
-    auto &ngo = node.nodeGraphicsObject();
-    auto &ngeom = node.nodeGeometry();
+    NodeId const nodeId = model.addNode("name");
+    auto &mock = *model.delegateModel<MockModel>(nodeId);
+
+    QGraphicsItem *ngo = scene.nodeGraphicsObject(nodeId);
+    REQUIRE(ngo != nullptr);
 
     // Move the node to somewhere in the middle of the screen
-    ngo.setPos(QPointF(50, 50));
+    ngo->setPos(QPointF(50, 50));
 
     // Compute the on-screen position of the input port
-    QPointF scInPortPos = ngeom.portScenePosition(0, PortType::In, ngo.sceneTransform());
+    QPointF scInPortPos = scene.nodeGeometry().portScenePosition(nodeId,
+                                                                 PortType::In,
+                                                                 0,
+                                                                 ngo->sceneTransform());
     QPoint vwInPortPos = view.mapFromScene(scInPortPos);
 
+    // Painting may ask for the policy of the output, only the click counts.
+    QApplication::processEvents();
+    mock.portOutConnectionPolicyCalledCount = 0;
+
     // Create a partial connection by clicking on the input port of the node
     QTest::mousePress(view.windowHandle(), Qt::LeftButton, Qt::NoModifier, vwInPortPos);
 
-    CHECK(model.portOutConnectionPolicyCalledCount == 0);
+    CHECK(mock.portOutConnectionPolicyCalledCount == 0);
 }
@@ -0,0 +1,116 @@
+#include <QtNodes/TaskScheduler>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using QtNodes::TaskScheduler;
+
+TEST_CASE("TaskScheduler::waitForIdle", "[scheduler]")
+{
+    TaskScheduler scheduler(4);
+
+    SECTION("concurrent submitters")
+    {
+        // Every round must see all the tasks of the round finished.
+        for (int round = 0; round < 50; ++round) {
+            std::atomic<int> finished{0};
+
+            std::vector<std::thread> submitters;
+            for (int s = 0; s < 4; ++s) {
+                submitters.emplace_back([&scheduler, &finished]() {
+                    for (int i = 0; i < 100; ++i) {
+                        scheduler.submit([&finished]() { ++finished; });
+                    }
+                });
+            }
+
+            for (auto &submitter : submitters) {
+                submitter.join();
+            }
+
+            scheduler.waitForIdle();
+
+            REQUIRE(finished == 400);
+        }
+    }
+
+    SECTION("tasks submitting tasks")
+    {
+        for (int round = 0; round < 50; ++round) {
+            std::atomic<int> finished{0};
+
+            for (int i = 0; i < 20; ++i) {
+                scheduler.submit([&scheduler, &finished]() {
+                    for (int j = 0; j < 10; ++j) {
+                        scheduler.submit([&finished]() { ++finished; });
+                    }
+
+                    ++finished;
+                });
+            }
+
+            scheduler.waitForIdle();
+
+            REQUIRE(finished == 220);
+        }
+    }
+
+    SECTION("waiting on a scheduler without tasks")
+    {
+        scheduler.waitForIdle();
+        CHECK(scheduler.workerCount() == 4);
+    }
+}
+
+TEST_CASE("TaskScheduler::setWorkerCount", "[scheduler]")
+{
+    TaskScheduler scheduler(2);
+
+    scheduler.setWorkerCount(3);
+    CHECK(scheduler.workerCount() == 3);
+
+    scheduler.submit([]() {});
+    scheduler.waitForIdle();
+
+    // The running pool is never resized.
+    CHECK_THROWS_AS(scheduler.setWorkerCount(1), std::logic_error);
+    CHECK(scheduler.workerCount() == 3);
+}
+
+TEST_CASE("TaskScheduler::parallelFor", "[scheduler]")
+{
+    TaskScheduler scheduler(4);
+
+    SECTION("every index once")
+    {
+        std::vector<std::atomic<int>> calls(1000);
+        for (auto &c : calls) {
+            c = 0;
+        }
+
+        scheduler.parallelFor(calls.size(), [&calls](std::size_t i) { ++calls[i]; });
+
+        for (auto const &c : calls) {
+            REQUIRE(c == 1);
+        }
+    }
+
+    SECTION("an exception reaches the caller")
+    {
+        auto body = [](std::size_t i) {
+            if (i == 10)
+                throw std::runtime_error("index 10");
+        };
+
+        CHECK_THROWS_AS(scheduler.parallelFor(1000, body), std::runtime_error);
+
+        // The pool is still usable.
+        std::atomic<int> after{0};
+        scheduler.parallelFor(100, [&after](std::size_t) { ++after; });
+        CHECK(after == 100);
+    }
+}